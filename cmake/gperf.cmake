@@ -29,3 +29,18 @@ add_custom_command(
 
 # Add the generated file as a source dependency
 add_custom_target(generate_language_hash DEPENDS ${GPERF_OUTPUT})
+
+# Perfect hash for the element names of the MediaWiki export schema
+set(GPERF_DUMP_ELEMENTS_INPUT ${CMAKE_CURRENT_SOURCE_DIR}/src/dump_elements.gperf)
+set(GPERF_DUMP_ELEMENTS_OUTPUT
+    ${CMAKE_CURRENT_BINARY_DIR}/configured/citescoop/dump_elements.h)
+
+add_custom_command(
+    OUTPUT ${GPERF_DUMP_ELEMENTS_OUTPUT}
+    COMMAND ${GPERF_EXECUTABLE} ${GPERF_DUMP_ELEMENTS_INPUT} > ${GPERF_DUMP_ELEMENTS_OUTPUT}
+    DEPENDS ${GPERF_DUMP_ELEMENTS_INPUT}
+    COMMENT "Generating perfect hash for MediaWiki dump element names"
+    VERBATIM
+)
+
+add_custom_target(generate_dump_element_hash DEPENDS ${GPERF_DUMP_ELEMENTS_OUTPUT})
@@ -4,13 +4,21 @@
 #ifndef INCLUDE_CITESCOOP_EXTRACT_H_
 #define INCLUDE_CITESCOOP_EXTRACT_H_
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <istream>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -21,6 +29,418 @@
 
 namespace wikiopencite::citescoop {
 
+/// @brief XML readers that dumps can be parsed with.
+enum class DumpReader {
+  /// libxml++'s SAX parser, a general purpose XML parser.
+  kLibxml,
+
+  /// A tokenizer specialised for MediaWiki dumps, which avoids copying
+  /// revision text before it is parsed.
+  kTokenizer,
+};
+
+/// @brief Encodings that revisions can be written to output streams in.
+enum class RevisionEncoding {
+  /// One PBF formatted proto::Revision message per revision, read with
+  /// MessageReader.
+  kMessages,
+
+  /// Blocks of delta encoded revisions with a dictionary of their
+  /// contributors, read with CompactRevisionReader.
+  kCompact,
+};
+
+/// @brief Progress of a streaming extraction, from which it can be
+/// resumed.
+///
+/// A checkpoint is taken just after a page and its revisions have been
+/// written, so everything written before it is complete.
+struct CITESCOOP_EXPORT ExtractorCheckpoint {
+  /// Offset in the decompressed dump XML just past the end of the last
+  /// page written.
+  uint64_t input_offset = 0;
+
+  /// Number of pages written.
+  uint64_t pages_written = 0;
+
+  /// Number of revisions written.
+  uint64_t revisions_written = 0;
+
+  /// Number of bytes written to the pages output.
+  uint64_t pages_output_size = 0;
+
+  /// Number of bytes written to the revisions output.
+  uint64_t revisions_output_size = 0;
+};
+
+/// @brief Filter selecting the pages of a dump to extract.
+///
+/// Pages are checked as soon as their header has been read, so the
+/// revisions of pages that are filtered out are skipped over without
+/// their text being parsed.
+struct CITESCOOP_EXPORT PageFilter {
+  /// @brief Namespaces of the pages to extract, such as 0 for articles.
+  /// If empty, pages in every namespace are extracted.
+  std::vector<int> namespaces = {};
+
+  /// @brief Should redirect pages be skipped?
+  bool skip_redirects = false;
+
+  /// @brief IDs of the pages to extract.
+  ///
+  /// If either this or @ref titles is set, only the pages listed in one
+  /// of them are extracted. The sets are shared rather than copied
+  /// between the parsers of a parallel extraction.
+  std::shared_ptr<const std::unordered_set<uint64_t>> page_ids = nullptr;
+
+  /// @brief Titles of the pages to extract. See @ref page_ids.
+  std::shared_ptr<const std::unordered_set<std::string>> titles = nullptr;
+};
+
+/// @brief Periods of time that revisions can be sampled by.
+enum class RevisionBucket {
+  /// Revisions are not sampled.
+  kNone,
+
+  /// A UTC calendar day.
+  kDay,
+
+  /// A UTC calendar month.
+  kMonth,
+
+  /// A UTC calendar year.
+  kYear,
+};
+
+/// @brief Filter selecting the revisions of each page to extract.
+///
+/// Citations are tracked across the selected revisions only, so a
+/// citation's revision_added and revision_removed are the first and
+/// last selected revisions it was seen in and missing from.
+struct CITESCOOP_EXPORT RevisionFilter {
+  /// @brief Earliest timestamp of the revisions to extract, inclusive.
+  /// If not set, there is no lower bound.
+  std::optional<std::chrono::sys_seconds> from = std::nullopt;
+
+  /// @brief Latest timestamp of the revisions to extract, inclusive.
+  /// If not set, there is no upper bound.
+  std::optional<std::chrono::sys_seconds> to = std::nullopt;
+
+  /// @brief Extract only the last revision of each page in each of
+  /// these periods, such as to take monthly snapshots.
+  ///
+  /// A revision's timestamp appears before its text, so revisions
+  /// outside of the time window are skipped without their text being
+  /// read. Sampled revisions can only be skipped once a later revision
+  /// shows they were not the last of their period, so their text is
+  /// held, but only the last of each period is parsed. Periods are
+  /// judged in the order the revisions appear in the dump.
+  RevisionBucket bucket = RevisionBucket::kNone;
+};
+
+/// @brief Options to configure extractors with.
+struct CITESCOOP_EXPORT ExtractorOptions {
+  /// @brief Number of worker threads to use for parallel extraction.
+  ///
+  /// If set to 0, one worker per hardware thread will be used. Parallel
+  /// extraction shares the citation parser between workers, so any
+  /// filter it was constructed with must be safe to call concurrently.
+  unsigned int threads = 0;
+
+  /// @brief Should parallel extraction preserve the dump's page order?
+  ///
+  /// If set, pages and revisions are returned in exactly the same order
+  /// as sequential extraction would return them. If not set, pages are
+  /// returned as soon as they have been processed.
+  bool preserve_order = true;
+
+  /// @brief Number of threads to use for decompression.
+  ///
+  /// If greater than 1, single stream bzip2 dumps (such as the
+  /// @c pages-meta-history dumps) are split into their compressed
+  /// blocks, which are decompressed in parallel. Likewise the frames of
+  /// seekable zstd dumps are decompressed in parallel. If set to 0, one
+  /// thread per hardware thread will be used. If set to 1, the dump is
+  /// decompressed sequentially.
+  unsigned int decompression_threads = 1;
+
+  /// @brief Should pages be parsed in parallel?
+  ///
+  /// If set, a reader thread cuts the dump into whole pages, which are
+  /// then parsed on @ref threads workers. Each page is held in memory
+  /// in full while it is parsed, so this is best suited to dumps that
+  /// only hold current revisions.
+  bool pipeline = false;
+
+  /// @brief XML reader to parse the dump with.
+  DumpReader reader = DumpReader::kLibxml;
+
+  /// @brief Number of threads to parse the revisions of large pages on.
+  ///
+  /// Revisions are otherwise parsed one at a time, so a page with tens
+  /// of thousands of revisions keeps a single thread busy for as long
+  /// as it takes. If not 1, once a page's revision text passes
+  /// @ref parallel_revision_text_size, each of its later revisions is
+  /// parsed on a pool of this many threads as soon as its text is
+  /// complete. Citations are still tracked in the order the revisions
+  /// appear. The pool is shared by every parser of a parallel
+  /// extraction, and a parser waiting on it runs queued revisions
+  /// itself. If set to 0, one thread per hardware thread will be used.
+  unsigned int revision_threads = 1;
+
+  /// @brief Revision text in bytes that a page must have before its
+  /// revisions are parsed on the @ref revision_threads pool, so that
+  /// small pages never pay for handing out their revisions.
+  std::size_t parallel_revision_text_size = 1 << 20;
+
+  /// @brief Memory budget in bytes for the revisions of a single page.
+  ///
+  /// Revisions of a page that are out of chronological order are held
+  /// until the page ends, so that they can be sorted. Once the held
+  /// revisions exceed the budget, measured by their serialized size,
+  /// they are sorted and written to a temporary file, then merged back
+  /// when the page ends. If set to 0, they are always held in memory.
+  std::size_t page_memory_budget = 0;
+
+  /// @brief Number of pages to write between checkpoints.
+  ///
+  /// When extracting to output streams, a checkpoint is taken every
+  /// this many pages: the outputs are flushed and @ref on_checkpoint is
+  /// called. With @ref pipeline set, pages are parsed in batches, so
+  /// the checkpoint is taken once the batch holding the page has been
+  /// written, which requires @ref preserve_order. If set to 0, no
+  /// checkpoints are taken.
+  uint64_t checkpoint_interval = 0;
+
+  /// @brief Called with each checkpoint taken. Should the extraction
+  /// fail, it can be resumed from the latest one.
+  std::function<void(const ExtractorCheckpoint&)> on_checkpoint = nullptr;
+
+  /// @brief Filter selecting the pages to extract. By default every page
+  /// is extracted.
+  PageFilter page_filter = {};
+
+  /// @brief Filter selecting the revisions to extract. By default every
+  /// revision is extracted.
+  RevisionFilter revision_filter = {};
+
+  /// @brief Encoding of the revisions written to output streams.
+  ///
+  /// Compact revisions are buffered into blocks, which are written when
+  /// full, at each checkpoint and at the end of the extraction. The
+  /// encoding has no effect on the pages output.
+  RevisionEncoding revision_encoding = RevisionEncoding::kMessages;
+};
+
+/// @brief Output streams for one shard of a sharded extraction.
+struct CITESCOOP_EXPORT ShardOutput {
+  /// Output stream for the shard's pages.
+  std::ostream* pages_output;
+
+  /// Output stream for the revisions referenced by the shard's pages.
+  std::ostream* revisions_output;
+};
+
+/// @brief Outputs of an earlier extraction made with
+/// Extractor::ExtractReusing(), whose results are to be reused.
+struct CITESCOOP_EXPORT PreviousExtraction {
+  /// Pages output of the previous extraction.
+  std::istream* pages = nullptr;
+
+  /// Revisions output of the previous extraction.
+  std::istream* revisions = nullptr;
+
+  /// Page versions output of the previous extraction.
+  std::istream* page_versions = nullptr;
+};
+
+/// @brief Get the shard a page is written to by a sharded extraction.
+///
+/// Pages are spread over the shards by the splitmix64 finalizer of
+/// their ID, modulo the number of shards, so that consumers can work
+/// out which shard holds a page.
+///
+/// @param page_id ID of the page.
+/// @param shard_count Number of shards.
+/// @return Index of the page's shard.
+CITESCOOP_EXPORT std::size_t PageShard(uint64_t page_id,
+                                       std::size_t shard_count);
+
+/// @brief A page along with the revisions its citations reference.
+struct CITESCOOP_EXPORT ExtractedPage {
+  /// Page and its citations
+  wikiopencite::proto::Page page;
+
+  /// Revisions referenced by the page's citations, by revision ID
+  std::map<uint64_t, wikiopencite::proto::Revision> revisions;
+};
+
+/// @brief Receiver of pages as they are extracted.
+///
+/// Lets an application process pages in-process without the whole dump
+/// being held in memory or serialized and parsed again.
+class CITESCOOP_EXPORT PageSink {
+ public:
+  /// @brief Virtual destructor for inheritance
+  virtual ~PageSink();
+
+  /// @brief Consume a page as soon as it and its revisions are
+  /// complete.
+  ///
+  /// Pages are consumed one at a time, on the thread that called
+  /// Extractor::Extract(), in the same order the other outputs would
+  /// hold them. The page and revisions are owned by the extractor and
+  /// are only valid until this returns, so anything kept must be
+  /// copied. See Consume(ExtractedPage&&) for pages that can be moved.
+  ///
+  /// @param page Page and its citations.
+  /// @param revisions Revisions referenced by the page's citations, by
+  /// revision ID.
+  virtual void Consume(
+      const wikiopencite::proto::Page& page,
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>&
+          revisions) = 0;
+
+  /// @brief Consume a page that the sink may take ownership of.
+  ///
+  /// Called instead of the other overload when the extractor already
+  /// holds the page in a message of its own, i.e. when
+  /// ExtractorOptions::pipeline is set, so that a sink keeping pages
+  /// can move them rather than copy them. The default forwards to the
+  /// other overload.
+  ///
+  /// @param page Page and the revisions its citations reference.
+  virtual void Consume(ExtractedPage&& page);
+};
+
+/// @brief Pages and revisions extracted into memory, held compactly.
+///
+/// An alternative to the vector and map returned by
+/// Extractor::Extract(std::istream&) for when memory is the limit:
+///
+///     auto dump = ExtractedDump();
+///     extractor.Extract(input, dump);
+///
+/// Every page and revision is copied once, as it is consumed, onto an
+/// arena owned by the dump, so there are no per-message allocations.
+/// Revisions are indexed by ID in an open addressing table rather than
+/// a tree of nodes. If several pages reference the same revision, the
+/// first copy is kept.
+class CITESCOOP_EXPORT ExtractedDump : public PageSink {
+ public:
+  ExtractedDump();
+  ~ExtractedDump() override;
+
+  ExtractedDump(ExtractedDump&& other) noexcept;
+  ExtractedDump& operator=(ExtractedDump&& other) noexcept;
+
+  ExtractedDump(const ExtractedDump&) = delete;
+  ExtractedDump& operator=(const ExtractedDump&) = delete;
+
+  using PageSink::Consume;
+
+  void Consume(
+      const wikiopencite::proto::Page& page,
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>&
+          revisions) override;
+
+  /// @brief Get the pages.
+  /// @return Pages in the order they were consumed.
+  std::span<const wikiopencite::proto::Page* const> pages() const;
+
+  /// @brief Get the revisions.
+  /// @return Revisions in the order they were first consumed.
+  std::span<const wikiopencite::proto::Revision* const> revisions() const;
+
+  /// @brief Find a revision by its ID.
+  /// @param revision_id ID of the revision.
+  /// @return The revision, or null if no page referenced it.
+  const wikiopencite::proto::Revision* FindRevision(
+      uint64_t revision_id) const;
+
+  /// @brief Get the approximate memory used by the dump.
+  /// @return Bytes allocated for the pages, revisions and index.
+  std::size_t SpaceUsed() const;
+
+ private:
+  class ExtractedDumpImpl;
+  std::unique_ptr<ExtractedDumpImpl> impl_;
+};
+
+/// @brief Pages of a dump, extracted lazily as they are iterated over.
+///
+/// Each increment reads only as far into the dump as the next page, so
+/// the first pages are available straight away and iteration can be
+/// stopped early without the rest of the dump being read. Pages are
+/// parsed on the iterating thread, one at a time.
+///
+/// A range can only be iterated over once, and its iterators are
+/// invalidated if it is moved. The stream it was created from must
+/// outlive it.
+class CITESCOOP_EXPORT PageRange {
+ public:
+  class PageRangeImpl;
+
+  /// @brief Input iterator over the pages of a range.
+  class CITESCOOP_EXPORT Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = ExtractedPage;
+    using pointer = ExtractedPage*;
+    using reference = ExtractedPage&;
+
+    Iterator() = default;
+
+    /// @brief Construct an iterator at the current page of a range.
+    /// @param range Range to iterate over.
+    explicit Iterator(PageRange* range) : range_(range) {}
+
+    /// @brief Get the current page. It may be moved from, as it is
+    /// replaced by the next page.
+    /// @return The current page.
+    ExtractedPage& operator*() const;
+
+    /// @brief Access the current page.
+    /// @return The current page.
+    ExtractedPage* operator->() const;
+
+    /// @brief Extract the next page.
+    /// @return This iterator.
+    Iterator& operator++();
+
+    /// @brief Extract the next page.
+    void operator++(int);
+
+    /// @brief Check if every page has been extracted.
+    /// @return True once there are no more pages.
+    bool operator==(std::default_sentinel_t /*end*/) const;
+
+   private:
+    PageRange* range_ = nullptr;
+  };
+
+  /// @brief Construct a new page range. Ranges are created by
+  /// Extractor::Pages().
+  /// @param impl Range implementation.
+  explicit PageRange(std::unique_ptr<PageRangeImpl> impl);
+
+  PageRange(PageRange&& other) noexcept;
+  PageRange& operator=(PageRange&& other) noexcept;
+  ~PageRange();
+
+  /// @brief Start iterating, extracting the first page.
+  /// @return Iterator at the first page.
+  Iterator begin();
+
+  /// @brief Get the end of the range.
+  /// @return Sentinel marking the end of the range.
+  std::default_sentinel_t end() const { return {}; }
+
+ private:
+  std::unique_ptr<PageRangeImpl> impl_;
+};
+
 /// @brief An abstract Wikimedia XML dumps parser to parse citations.
 ///
 /// Extractors are designed to take in the Wikimedia XML dumps in a
@@ -32,6 +452,10 @@ class CITESCOOP_EXPORT Extractor {
   virtual ~Extractor();
 
   /// @brief Extract citations from a given input stream.
+  ///
+  /// See ExtractedDump for a more compact way of holding the results in
+  /// memory.
+  ///
   /// @param stream Input stream to extract citations from.
   /// @return A vector of citations by page and a map of revisions
   /// referenced by citations.
@@ -48,6 +472,130 @@ class CITESCOOP_EXPORT Extractor {
   virtual std::pair<uint64_t, uint64_t> Extract(
       std::istream& input, std::ostream* pages_output,
       std::ostream* revisions_output) = 0;
+
+  /// @brief Resume extracting citations from a checkpoint.
+  ///
+  /// The input is skipped up to the checkpoint, so it must be the same
+  /// dump the checkpoint was taken from, read from the start. The
+  /// outputs must have been truncated to the sizes in the checkpoint
+  /// (for example with std::filesystem::resize_file) and be positioned
+  /// at their ends, as everything written after the checkpoint is
+  /// written again.
+  ///
+  /// @param input XML stream to extract from.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
+  /// @return Number of pages followed by number of revisions written,
+  /// including those written before the checkpoint.
+  virtual std::pair<uint64_t, uint64_t> Extract(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output,
+      const ExtractorCheckpoint& checkpoint) = 0;
+
+  /// @brief Extract citations from a given input stream, splitting the
+  /// output into shards by page.
+  ///
+  /// Each page is written along with its revisions to the shard given
+  /// by PageShard(). Each shard is written in the same format as the
+  /// unsharded output. When pages are parsed in parallel (see
+  /// ExtractorOptions::pipeline), each shard is written on its own
+  /// thread.
+  ///
+  /// @param input XML stream to extract from.
+  /// @param shards Output streams of each shard.
+  /// @return Number of pages followed by number of revisions written to
+  /// each shard.
+  virtual std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards) = 0;
+
+  /// @brief Extract citations from a given input stream, handing each
+  /// page to a sink as soon as it is complete.
+  ///
+  /// Pages are neither collected nor serialized, so memory use is
+  /// bounded by the largest page rather than the whole dump.
+  ///
+  /// @param input XML stream to extract from.
+  /// @param sink Sink to consume each page.
+  /// @return Number of pages followed by number of revisions consumed.
+  virtual std::pair<uint64_t, uint64_t> Extract(std::istream& input,
+                                                PageSink& sink) = 0;
+
+  /// @brief Lazily extract citations from a given input stream.
+  ///
+  /// Nothing is read from the input until the range is iterated over.
+  /// Pages are always parsed sequentially, whatever the extractor's
+  /// options, though the page filter is applied.
+  ///
+  /// @param input XML stream to extract from, which must outlive the
+  /// range.
+  /// @return Range of the extracted pages.
+  virtual PageRange Pages(std::istream& input) = 0;
+
+  /// @brief Apply an incremental dump to a previous streaming
+  /// extraction.
+  ///
+  /// Incremental dumps, such as Wikimedia's daily adds-changes dumps,
+  /// only hold the revisions added since an earlier dump. Each changed
+  /// page is extracted carrying on from the citations the previous
+  /// extraction found for it, so citations it already held keep the
+  /// revision they were added or removed in. The result replaces the
+  /// page with the same ID along with its revisions, and new pages are
+  /// written at the end. Every other page and revision is copied
+  /// through without being extracted again. Changed pages are always
+  /// parsed one at a time, whatever the extractor's options.
+  ///
+  /// Will throw a std::runtime_error if the previous extraction is
+  /// truncated, or std::invalid_argument if the extractor's revision
+  /// encoding is not RevisionEncoding::kMessages.
+  ///
+  /// @param input XML stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return Number of pages followed by number of revisions written.
+  virtual std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output) = 0;
+
+  /// @brief Extract citations, reusing the results of an earlier
+  /// extraction for pages that haven't changed since.
+  ///
+  /// Most pages of a dump are unchanged since the previous month's
+  /// release. Each page is cut out of the dump and its highest revision
+  /// ID is found without parsing its XML. If the previous extraction
+  /// holds the page at the same revision, its page and revisions are
+  /// copied through byte for byte. Only the other pages are parsed, on
+  /// @ref ExtractorOptions::threads workers if
+  /// ExtractorOptions::pipeline is set. The outputs are the same as
+  /// those of a streaming extraction, in the dump's page order.
+  ///
+  /// Along with the pages and revisions, the page versions output
+  /// records the revision each page was extracted at and where it was
+  /// written, ready for the next extraction to reuse. For the first
+  /// extraction, leave the previous extraction empty so that every page
+  /// is extracted. The previous extraction must have been made with the
+  /// same parser and options.
+  ///
+  /// Will throw a std::runtime_error if the previous extraction is
+  /// truncated, or std::invalid_argument if the previous extraction is
+  /// missing one of its streams or the extractor's revision encoding is
+  /// not RevisionEncoding::kMessages.
+  ///
+  /// @param input XML stream to extract from.
+  /// @param previous Outputs of the previous extraction, whose pages
+  /// and revisions streams must be seekable.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return Number of pages followed by number of revisions written.
+  virtual std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output) = 0;
 };
 
 /// @brief Extractor for text based input streams.
@@ -57,6 +605,12 @@ class CITESCOOP_EXPORT TextExtractor : public Extractor {
   /// @param parser Citations parser to use.
   explicit TextExtractor(const std::shared_ptr<Parser>& parser);
 
+  /// @brief Construct a new TextExtractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options to configure extractor with.
+  TextExtractor(const std::shared_ptr<Parser>& parser,
+                ExtractorOptions options);
+
   ~TextExtractor() override;
 
   /// @brief Extract citations from text based streams.
@@ -76,11 +630,106 @@ class CITESCOOP_EXPORT TextExtractor : public Extractor {
       std::istream& input, std::ostream* pages_output,
       std::ostream* revisions_output) override;
 
+  /// @brief Resume extracting citations from a text based input stream at a
+  /// checkpoint. See Extractor::Extract().
+  /// @param input XML stream to extract from.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> Extract(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output,
+      const ExtractorCheckpoint& checkpoint) override;
+
+  /// @brief Extract citations from a text based input stream into shards.
+  /// See Extractor::Extract().
+  /// @param input XML stream to extract from.
+  /// @param shards Output streams of each shard.
+  /// @return Number of pages followed by number of revisions written to
+  /// each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards) override;
+
+  /// @brief Extract citations from a text based input stream into a page sink.
+  /// See Extractor::Extract().
+  /// @param input XML stream to extract from.
+  /// @param sink Sink to consume each page.
+  /// @return Number of pages followed by number of revisions consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input,
+                                        PageSink& sink) override;
+
+  /// @brief Lazily extract citations from a text based input stream.
+  /// See Extractor::Pages().
+  /// @param input XML stream to extract from.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input) override;
+
+  /// @brief Apply an incremental dump from a text based input stream
+  /// to a previous streaming extraction. See
+  /// Extractor::ExtractIncremental().
+  /// @param input XML stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output) override;
+
+  /// @brief Extract citations from a text based input stream,
+  /// reusing the results of an earlier extraction for unchanged pages.
+  /// See Extractor::ExtractReusing().
+  /// @param input Text based XML stream to extract from.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output) override;
+
  private:
   class TextExtractorImpl;
   std::unique_ptr<TextExtractorImpl> impl_;
 };
 
+/// @brief Index of a bzip2 multistream dump, held in memory so that
+/// single pages can be looked up repeatedly.
+///
+/// Looking up a page by ID or title is a hash table lookup, giving the
+/// offset and length of the bzip2 stream holding it.
+class CITESCOOP_EXPORT MultistreamDumpIndex {
+ public:
+  /// @brief Read a multistream index.
+  ///
+  /// Will throw a DumpParseException if any line of the index is
+  /// malformed.
+  ///
+  /// @param index Stream of the multistream index, either bzip2
+  /// compressed or plain text.
+  explicit MultistreamDumpIndex(std::istream& index);
+
+  MultistreamDumpIndex(MultistreamDumpIndex&& other) noexcept;
+  MultistreamDumpIndex& operator=(MultistreamDumpIndex&& other) noexcept;
+  ~MultistreamDumpIndex();
+
+  /// @brief Get the number of pages in the index.
+  /// @return Number of pages.
+  std::size_t size() const;
+
+ private:
+  friend class Bz2Extractor;
+
+  class MultistreamDumpIndexImpl;
+  std::unique_ptr<MultistreamDumpIndexImpl> impl_;
+};
+
 /// @brief A bzip2 extractor designed to work with the bz2 Wikipedia dumps.
 class CITESCOOP_EXPORT Bz2Extractor : public Extractor {
  public:
@@ -88,6 +737,11 @@ class CITESCOOP_EXPORT Bz2Extractor : public Extractor {
   /// @param parser Citations parser to use.
   explicit Bz2Extractor(const std::shared_ptr<Parser>& parser);
 
+  /// @brief Construct a new bzip extractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options to configure extractor with.
+  Bz2Extractor(const std::shared_ptr<Parser>& parser, ExtractorOptions options);
+
   ~Bz2Extractor() override;
 
   /// @brief Extract citations from a bzip2 compressed data dump.
@@ -107,11 +761,292 @@ class CITESCOOP_EXPORT Bz2Extractor : public Extractor {
       std::istream& input, std::ostream* pages_output,
       std::ostream* revisions_output) override;
 
+  /// @brief Resume extracting citations from a bzip2 compressed data dump at a
+  /// checkpoint. See Extractor::Extract().
+  /// @param input Stream of a bzip2 compressed XML data dump.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> Extract(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output,
+      const ExtractorCheckpoint& checkpoint) override;
+
+  /// @brief Extract citations from a bzip2 compressed data dump into shards.
+  /// See Extractor::Extract().
+  /// @param input Stream of a bzip2 compressed XML data dump.
+  /// @param shards Output streams of each shard.
+  /// @return Number of pages followed by number of revisions written to
+  /// each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards) override;
+
+  /// @brief Extract citations from a bzip2 compressed data dump into a page
+  /// sink.
+  /// See Extractor::Extract().
+  /// @param input Stream of a bzip2 compressed XML data dump.
+  /// @param sink Sink to consume each page.
+  /// @return Number of pages followed by number of revisions consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input,
+                                        PageSink& sink) override;
+
+  /// @brief Lazily extract citations from a bzip2 compressed data dump.
+  /// See Extractor::Pages().
+  /// @param input Stream of a bzip2 compressed XML data dump.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input) override;
+
+  /// @brief Apply a bzip2 compressed incremental dump
+  /// to a previous streaming extraction. See
+  /// Extractor::ExtractIncremental().
+  /// @param input Stream of a bzip2 compressed incremental XML dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output) override;
+
+  /// @brief Extract citations from a bzip2 compressed data dump,
+  /// reusing the results of an earlier extraction for unchanged pages.
+  /// See Extractor::ExtractReusing().
+  /// @param input Stream of bzip2 compressed XML.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output) override;
+
+  /// @brief Extract citations from a bzip2 multistream data dump in
+  /// parallel.
+  ///
+  /// Multistream dumps (@c pages-articles-multistream.xml.bz2) are made
+  /// up of independent bzip2 streams of around 100 pages each. The
+  /// companion index lists the byte offset of each stream, allowing
+  /// the streams to be decompressed and parsed on separate threads.
+  ///
+  /// @param stream Stream of a bzip2 multistream XML data dump.
+  /// @param index Stream of the multistream index, either bzip2
+  /// compressed or plain text.
+  /// @return A vector of citations by page and a map of revisions
+  /// referenced by citations.
+  std::pair<std::unique_ptr<std::vector<wikiopencite::proto::Page>>,
+            std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>>
+  ExtractMultistream(std::istream& stream, std::istream& index);
+
+  /// @brief Extract citations from a bzip2 multistream data dump in
+  /// parallel.
+  /// @param input Stream of a bzip2 multistream XML data dump.
+  /// @param index Stream of the multistream index, either bzip2
+  /// compressed or plain text.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractMultistream(
+      std::istream& input, std::istream& index, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Extract a single page from a bzip2 multistream data dump.
+  ///
+  /// Only the bzip2 stream holding the page is read and decompressed,
+  /// and only the page itself has its revisions parsed, on the calling
+  /// thread whatever ExtractorOptions::revision_threads says. The page
+  /// filter is still applied, other than the page IDs and titles to
+  /// extract.
+  ///
+  /// @param input Seekable stream of a bzip2 multistream XML data dump.
+  /// @param index Index of the dump.
+  /// @param page_id ID of the page to extract.
+  /// @return The page and the revisions its citations reference, or
+  /// nothing if the page is not in the dump.
+  std::optional<ExtractedPage> ExtractPage(std::istream& input,
+                                           const MultistreamDumpIndex& index,
+                                           uint64_t page_id);
+
+  /// @brief Extract a single page from a bzip2 multistream data dump by
+  /// its title. See ExtractPage().
+  /// @param input Seekable stream of a bzip2 multistream XML data dump.
+  /// @param index Index of the dump.
+  /// @param title Title of the page to extract.
+  /// @return The page and the revisions its citations reference, or
+  /// nothing if the page is not in the dump.
+  std::optional<ExtractedPage> ExtractPage(std::istream& input,
+                                           const MultistreamDumpIndex& index,
+                                           const std::string& title);
+
  private:
   class Bz2ExtractorImpl;
   std::unique_ptr<Bz2ExtractorImpl> impl_;
 };
 
+/// @brief A zstd extractor for dumps recompressed with Zstandard.
+///
+/// Dumps compressed in the seekable zstd format, made up of
+/// independently compressed frames followed by a seek table, can have
+/// their frames decompressed in parallel (see
+/// ExtractorOptions::decompression_threads). Any other zstd stream is
+/// decompressed sequentially.
+class CITESCOOP_EXPORT ZstdExtractor : public Extractor {
+ public:
+  /// @brief Construct a new zstd extractor.
+  /// @param parser Citations parser to use.
+  explicit ZstdExtractor(const std::shared_ptr<Parser>& parser);
+
+  /// @brief Construct a new zstd extractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options to configure extractor with.
+  ZstdExtractor(const std::shared_ptr<Parser>& parser,
+                ExtractorOptions options);
+
+  ~ZstdExtractor() override;
+
+  /// @brief Extract citations from a zstd compressed data dump.
+  /// @param stream Stream of a zstd compressed XML data dump.
+  /// @return A vector of citations by page and a map of revisions
+  /// referenced by citations.
+  std::pair<std::unique_ptr<std::vector<wikiopencite::proto::Page>>,
+            std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>>
+  Extract(std::istream& stream) override;
+
+  /// @brief Extract citations from a zstd compressed data dump.
+  /// @param input Stream of a zstd compressed XML data dump.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> Extract(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output) override;
+
+  /// @brief Resume extracting citations from a zstd compressed data dump at a
+  /// checkpoint. See Extractor::Extract().
+  /// @param input Stream of a zstd compressed XML data dump.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> Extract(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output,
+      const ExtractorCheckpoint& checkpoint) override;
+
+  /// @brief Extract citations from a zstd compressed data dump into shards.
+  /// See Extractor::Extract().
+  /// @param input Stream of a zstd compressed XML data dump.
+  /// @param shards Output streams of each shard.
+  /// @return Number of pages followed by number of revisions written to
+  /// each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards) override;
+
+  /// @brief Extract citations from a zstd compressed data dump into a page
+  /// sink.
+  /// See Extractor::Extract().
+  /// @param input Stream of a zstd compressed XML data dump.
+  /// @param sink Sink to consume each page.
+  /// @return Number of pages followed by number of revisions consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input,
+                                        PageSink& sink) override;
+
+  /// @brief Lazily extract citations from a zstd compressed data dump.
+  /// See Extractor::Pages().
+  /// @param input Stream of a zstd compressed XML data dump.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input) override;
+
+  /// @brief Apply a zstd compressed incremental dump
+  /// to a previous streaming extraction. See
+  /// Extractor::ExtractIncremental().
+  /// @param input Stream of a zstd compressed incremental XML dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output) override;
+
+  /// @brief Extract citations from a zstd compressed data dump,
+  /// reusing the results of an earlier extraction for unchanged pages.
+  /// See Extractor::ExtractReusing().
+  /// @param input Stream of zstd compressed XML.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output) override;
+
+ private:
+  class ZstdExtractorImpl;
+  std::unique_ptr<ZstdExtractorImpl> impl_;
+};
+
+/// @brief A part of a dump to be extracted by a BatchExtractor.
+struct CITESCOOP_EXPORT DumpPart {
+  /// Path of the dump part. Its extension picks the extractor: @c .bz2
+  /// for bzip2, @c .zst for zstd, otherwise plain XML.
+  std::filesystem::path input;
+
+  /// Path to write the part's pages to.
+  std::filesystem::path pages_output;
+
+  /// Path to write the part's revisions to.
+  std::filesystem::path revisions_output;
+};
+
+/// @brief Extractor for dumps split into many parts, such as the
+/// @c pages-meta-history dumps.
+///
+/// Parts are extracted concurrently, each to its own output files, on
+/// a shared pool of workers. As parts can differ in size by more than
+/// an order of magnitude, they are started largest first, so that a
+/// large part is not left running on its own at the end.
+class CITESCOOP_EXPORT BatchExtractor {
+ public:
+  /// @brief Construct a new batch extractor.
+  /// @param parser Citations parser to use, shared between every part.
+  /// Any filter it was constructed with must be safe to call
+  /// concurrently.
+  /// @param options Extractor options to extract each part with.
+  /// @param concurrency Number of parts to extract at once. If 0, one
+  /// part per hardware thread is extracted at once. Any threads a part
+  /// uses itself (see ExtractorOptions::threads) are on top of this.
+  BatchExtractor(const std::shared_ptr<Parser>& parser,
+                 ExtractorOptions options, unsigned int concurrency = 0);
+
+  ~BatchExtractor();
+
+  /// @brief Extract each part of a dump to its output files.
+  ///
+  /// Will throw the first error of any part once every part that has
+  /// been started has finished. Parts that had not been started are
+  /// skipped.
+  ///
+  /// @param parts Parts to extract.
+  /// @return Total number of pages followed by total number of
+  /// revisions written.
+  std::pair<uint64_t, uint64_t> Extract(const std::vector<DumpPart>& parts);
+
+ private:
+  class BatchExtractorImpl;
+  std::unique_ptr<BatchExtractorImpl> impl_;
+};
+
 /// @brief Exception thrown when dump parsing fails.
 ///
 /// This exception is thrown when the parser cannot successfully parse
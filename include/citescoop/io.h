@@ -7,10 +7,14 @@
 // NOLINTNEXTLINE(misc-include-cleaner)
 #include <arpa/inet.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <ios>
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <streambuf>
 #include <type_traits>
 
 #include "google/protobuf/io/coded_stream.h"
@@ -18,6 +22,7 @@
 #include "google/protobuf/message.h"
 
 #include "citescoop/citescoop_export.h"
+#include "citescoop/proto/revision.pb.h"
 
 namespace wikiopencite::citescoop {
 
@@ -88,6 +93,256 @@ class CITESCOOP_EXPORT MessageWriter {
  private:
   std::ostream* output_stream_;
 };
+
+/// @brief Writer for PBF formatted streams, writing on a background
+/// thread.
+///
+/// Messages are serialized into large buffers, which are written to the
+/// output stream on a background thread while the next buffer is
+/// filled. Once every buffer is waiting to be written, writing a
+/// message blocks until one has been. The output is the same as
+/// MessageWriter's.
+///
+/// The output stream must not be used by anything else until the
+/// writer has been closed.
+class CITESCOOP_EXPORT AsyncMessageWriter {
+ public:
+  /// @brief Default size in bytes of each buffer.
+  static constexpr std::size_t kDefaultBufferSize = 1 << 22;
+
+  /// @brief Construct a new writer.
+  /// @param output Output stream to write messages to.
+  /// @param buffer_size Size in bytes of each buffer. A message larger
+  /// than this is given a buffer of its own.
+  /// @param buffer_count Number of buffers, at least 2.
+  explicit AsyncMessageWriter(std::ostream* output,
+                              std::size_t buffer_size = kDefaultBufferSize,
+                              std::size_t buffer_count = 2);
+
+  /// @brief Close the writer, ignoring any error. Call Close() first
+  /// to find out whether everything was written.
+  ~AsyncMessageWriter();
+
+  AsyncMessageWriter(const AsyncMessageWriter&) = delete;
+  AsyncMessageWriter& operator=(const AsyncMessageWriter&) = delete;
+
+  /// @brief Write a message to the output stream.
+  ///
+  /// Will throw std::runtime_error if an earlier write failed or the
+  /// writer has been closed.
+  ///
+  /// @param message Message to write.
+  /// @return Size of message written. Note: this does not include the
+  /// size of the uint32_t size written immediately before the
+  /// serialized message.
+  uint32_t WriteMessage(const google::protobuf::Message& message);
+
+  /// @brief Write every message written so far to the output stream
+  /// and flush it, waiting until done.
+  ///
+  /// Will throw std::runtime_error if the messages could not be
+  /// written.
+  void Flush();
+
+  /// @brief Flush the writer and stop its background thread. Does
+  /// nothing if the writer is already closed.
+  ///
+  /// Will throw std::runtime_error if the messages could not be
+  /// written.
+  void Close();
+
+ private:
+  class AsyncMessageWriterImpl;
+  std::unique_ptr<AsyncMessageWriterImpl> impl_;
+};
+
+/// @brief Writer for compact revision streams.
+///
+/// Revisions are written in blocks, each made up of:
+/// uint32_t Size of the rest of the block in network byte order
+/// Contributor dictionary: a varint count, then each username as a
+/// varint length followed by its bytes
+/// Revisions: a varint count, then for each revision
+///   - its revision ID, as a zigzag varint delta from the previous
+///     revision's ID
+///   - its revision ID less its parent ID, as a zigzag varint
+///   - its username, as a varint index into the contributor dictionary
+///   - its timestamp's nanoseconds plus one as a varint, or 0 if it
+///     has no timestamp
+///   - if it has a timestamp, its seconds as a zigzag varint delta from
+///     the previous timestamp's
+///
+/// Deltas start from 0 in each block, so every block can be read on
+/// its own. Revisions are buffered until a block is full, so the
+/// writer must be flushed before the stream is used elsewhere.
+class CITESCOOP_EXPORT CompactRevisionWriter {
+ public:
+  /// @brief Default number of revisions in each block.
+  static constexpr std::size_t kDefaultBlockSize = 4096;
+
+  /// @brief Construct a new writer.
+  /// @param output Output stream to write revisions to.
+  /// @param block_size Number of revisions to write in each block.
+  explicit CompactRevisionWriter(std::ostream* output,
+                                 std::size_t block_size = kDefaultBlockSize);
+
+  /// @brief Flush the writer, ignoring any error. Call Flush() first to
+  /// find out whether everything was written.
+  ~CompactRevisionWriter();
+
+  CompactRevisionWriter(const CompactRevisionWriter&) = delete;
+  CompactRevisionWriter& operator=(const CompactRevisionWriter&) = delete;
+
+  /// @brief Add a revision to the current block, writing the block if
+  /// it is full.
+  ///
+  /// Will throw std::runtime_error if the block could not be written.
+  ///
+  /// @param revision Revision to write.
+  /// @return Number of bytes written to the output stream, which is 0
+  /// unless a block was written.
+  uint64_t WriteRevision(const wikiopencite::proto::Revision& revision);
+
+  /// @brief Write the current block, if it holds any revisions.
+  ///
+  /// Will throw std::runtime_error if the block could not be written.
+  ///
+  /// @return Number of bytes written to the output stream.
+  uint64_t Flush();
+
+ private:
+  class CompactRevisionWriterImpl;
+  std::unique_ptr<CompactRevisionWriterImpl> impl_;
+};
+
+/// @brief Read revisions from a compact revision stream. See
+/// CompactRevisionWriter for the format.
+class CITESCOOP_EXPORT CompactRevisionReader {
+ public:
+  /// @brief Construct a new reader.
+  /// @param input Input stream to read revisions from.
+  explicit CompactRevisionReader(std::istream* input);
+
+  ~CompactRevisionReader();
+
+  CompactRevisionReader(const CompactRevisionReader&) = delete;
+  CompactRevisionReader& operator=(const CompactRevisionReader&) = delete;
+
+  /// @brief Read the next revision.
+  ///
+  /// Will throw std::runtime_error if the stream is truncated or a
+  /// block is malformed.
+  ///
+  /// @return The revision, or null at the end of the stream.
+  std::unique_ptr<wikiopencite::proto::Revision> ReadRevision();
+
+ private:
+  class CompactRevisionReaderImpl;
+  std::unique_ptr<CompactRevisionReaderImpl> impl_;
+};
+
+/// @brief Options for AsyncFileSource and AsyncFileSink.
+struct CITESCOOP_EXPORT AsyncFileOptions {
+  /// @brief Size in bytes of each read or write.
+  std::size_t block_size = 1 << 20;
+
+  /// @brief Number of reads or writes to keep in flight at once.
+  unsigned int queue_depth = 4;
+
+  /// @brief Make reads and writes with io_uring where the kernel
+  /// supports it. If false, or if io_uring is unavailable, they are
+  /// made on background threads instead.
+  bool use_io_uring = true;
+};
+
+/// @brief Stream buffer reading a file with several large reads in
+/// flight ahead of the reader.
+///
+/// Use it as the buffer of a std::istream, such as to feed an
+/// extractor or a MessageReader:
+///
+///     auto source = AsyncFileSource(path);
+///     auto input = std::istream(&source);
+///     extractor.Extract(input, &pages_output, &revisions_output);
+///
+/// The kernel is told that the file is read sequentially, so that it
+/// reads further ahead itself. Seeking is supported, but discards the
+/// reads in flight. A failed read sets the stream's badbit.
+class CITESCOOP_EXPORT AsyncFileSource : public std::streambuf {
+ public:
+  /// @brief Open a file for reading.
+  ///
+  /// Will throw std::system_error if the file could not be opened.
+  ///
+  /// @param path Path of the file to read.
+  /// @param options Read options.
+  explicit AsyncFileSource(const std::filesystem::path& path,
+                           const AsyncFileOptions& options = {});
+
+  ~AsyncFileSource() override;
+
+  AsyncFileSource(const AsyncFileSource&) = delete;
+  AsyncFileSource& operator=(const AsyncFileSource&) = delete;
+
+  /// @brief Check if the file is read with io_uring.
+  /// @return True for io_uring, false for background threads.
+  bool uses_io_uring() const;
+
+ protected:
+  int_type underflow() override;
+  pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+ private:
+  class AsyncFileSourceImpl;
+  std::unique_ptr<AsyncFileSourceImpl> impl_;
+};
+
+/// @brief Stream buffer writing a file with several large writes in
+/// flight behind the writer.
+///
+/// Use it as the buffer of a std::ostream, such as to collect the
+/// output of an extractor or a MessageWriter. Each block is queued to
+/// be written once it is full, and writing only blocks once every
+/// block is waiting to be written. Flushing the stream waits for every
+/// write to complete. A failed write sets the stream's badbit.
+class CITESCOOP_EXPORT AsyncFileSink : public std::streambuf {
+ public:
+  /// @brief Create or truncate a file for writing.
+  ///
+  /// Will throw std::system_error if the file could not be opened.
+  ///
+  /// @param path Path of the file to write.
+  /// @param options Write options.
+  explicit AsyncFileSink(const std::filesystem::path& path,
+                         const AsyncFileOptions& options = {});
+
+  /// @brief Close the file, ignoring any error. Call Close() first to
+  /// find out whether everything was written.
+  ~AsyncFileSink() override;
+
+  AsyncFileSink(const AsyncFileSink&) = delete;
+  AsyncFileSink& operator=(const AsyncFileSink&) = delete;
+
+  /// @brief Write everything buffered, wait for every write and close
+  /// the file. Does nothing if the file is already closed.
+  ///
+  /// Will throw std::system_error if the file could not be written.
+  void Close();
+
+  /// @brief Check if the file is written with io_uring.
+  /// @return True for io_uring, false for background threads.
+  bool uses_io_uring() const;
+
+ protected:
+  int_type overflow(int_type c) override;
+  int sync() override;
+
+ private:
+  class AsyncFileSinkImpl;
+  std::unique_ptr<AsyncFileSinkImpl> impl_;
+};
 }  // namespace wikiopencite::citescoop
 
 #endif  // INCLUDE_CITESCOOP_IO_H_
@@ -8,6 +8,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include "citescoop/citescoop_export.h"
 #include "citescoop/proto/revision_citations.pb.h"
@@ -97,12 +98,35 @@ class CITESCOOP_EXPORT Parser {
   /// If a filter has been set for this parser, the return values will
   /// only contain any citations that match the provided filter.
   ///
-  /// @param text WikiText to extract citations from.
+  /// Citations are keyed by a fingerprint of their normalized title and
+  /// identifiers, written as 16 hexadecimal digits. Citations with the
+  /// same fingerprint are only included once.
+  ///
+  /// @param text WikiText to extract citations from. It is only read
+  /// for the duration of the call.
   /// @return Citation protobuf representations.
   ///
   /// @sa Parser(std::function<bool(const std::string&)> filter)
+  wikiopencite::proto::RevisionCitations Parse(std::string_view text);
+
+  /// @brief Parse a given input string to extract citations.
+  ///
+  /// Kept so that code built against earlier releases still links.
+  /// Equivalent to Parse(std::string_view).
+  ///
+  /// @param text WikiText to extract citations from.
+  /// @return Citation protobuf representations.
   wikiopencite::proto::RevisionCitations Parse(const std::string& text);
 
+  /// @brief Parse a given input string to extract citations.
+  ///
+  /// Equivalent to Parse(std::string_view). Resolves the ambiguity
+  /// between the other overloads for string literals.
+  ///
+  /// @param text Null terminated WikiText to extract citations from.
+  /// @return Citation protobuf representations.
+  wikiopencite::proto::RevisionCitations Parse(const char* text);
+
   /// @brief Get configured parser options.
   /// @return Configured parser options.
   ParserOptions options();
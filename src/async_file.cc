@@ -0,0 +1,418 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// NOLINTBEGIN(misc-include-cleaner)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// NOLINTEND(misc-include-cleaner)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "citescoop/io.h"
+
+#include "io_queue.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+/// @brief A buffer and the request filling or draining it.
+struct Block {
+  std::vector<char> data;
+  IoRequest request;
+};
+
+/// @brief Open a file, throwing if it could not be opened.
+int OpenFile(const std::filesystem::path& path, int flags) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  auto descriptor = open(path.c_str(), flags | O_CLOEXEC, 0666);
+  if (descriptor < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Could not open " + path.string());
+  }
+  return descriptor;
+}
+
+/// @brief Throw if a request failed.
+void CheckRequest(const IoRequest& request, const char* action) {
+  if (request.result < 0) {
+    throw std::system_error(static_cast<int>(-request.result),
+                            std::generic_category(), action);
+  }
+}
+}  // namespace
+
+class AsyncFileSource::AsyncFileSourceImpl {
+ public:
+  AsyncFileSourceImpl(const std::filesystem::path& path,
+                      const AsyncFileOptions& options)
+      : descriptor_(OpenFile(path, O_RDONLY)),
+        block_size_(std::max<std::size_t>(options.block_size, 1)),
+        blocks_(std::max(options.queue_depth, 1U)) {
+    struct stat status{};
+    if (fstat(descriptor_, &status) != 0) {
+      auto error = errno;
+      close(descriptor_);
+      throw std::system_error(error, std::generic_category(),
+                              "Could not read " + path.string());
+    }
+    file_size_ = static_cast<uint64_t>(status.st_size);
+
+    // Double the kernel's readahead window.
+    posix_fadvise(descriptor_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    queue_ = IoQueue::Create(descriptor_,
+                             static_cast<unsigned int>(blocks_.size()),
+                             options.use_io_uring);
+    for (auto& block : blocks_) {
+      block.data.resize(block_size_);
+      free_.push_back(&block);
+    }
+  }
+
+  ~AsyncFileSourceImpl() {
+    // The kernel may still be reading into the buffers.
+    Drain();
+    queue_.reset();
+    close(descriptor_);
+  }
+
+  AsyncFileSourceImpl(const AsyncFileSourceImpl&) = delete;
+  AsyncFileSourceImpl& operator=(const AsyncFileSourceImpl&) = delete;
+
+  /// @brief Read the next block, queueing reads to refill the buffers.
+  /// @return The block, which is valid until the next call, or empty at
+  /// the end of the file.
+  std::span<char> Next() {
+    if (current_ != nullptr) {
+      block_offset_ += static_cast<uint64_t>(current_->request.result);
+      free_.push_back(current_);
+      current_ = nullptr;
+    }
+    Fill();
+    if (in_flight_.empty()) {
+      return {};
+    }
+
+    auto* block = in_flight_.front();
+    in_flight_.pop_front();
+    try {
+      queue_->Wait(&block->request);
+      CheckRequest(block->request, "Could not read file");
+    } catch (...) {
+      free_.push_back(block);
+      throw;
+    }
+    if (block->request.result == 0) {
+      // The file was truncated while being read.
+      free_.push_back(block);
+      Drain();
+      return {};
+    }
+    current_ = block;
+    Fill();
+    return {block->data.data(),
+            static_cast<std::size_t>(block->request.result)};
+  }
+
+  /// @brief Discard the reads in flight and continue from an offset.
+  void Seek(uint64_t offset) {
+    Drain();
+    block_offset_ = next_offset_ = offset;
+    posix_fadvise(descriptor_, static_cast<off_t>(offset),
+                  static_cast<off_t>(block_size_ * blocks_.size()),
+                  POSIX_FADV_WILLNEED);
+  }
+
+  /// @brief Offset in the file of the current block.
+  uint64_t block_offset() const { return block_offset_; }
+
+  uint64_t file_size() const { return file_size_; }
+
+  bool uses_io_uring() const { return queue_->uses_io_uring(); }
+
+ private:
+  int descriptor_;
+  std::size_t block_size_;
+  uint64_t file_size_ = 0;
+  std::vector<Block> blocks_;
+  std::unique_ptr<IoQueue> queue_;
+
+  std::vector<Block*> free_;
+  std::deque<Block*> in_flight_;
+  Block* current_ = nullptr;
+  uint64_t block_offset_ = 0;
+  uint64_t next_offset_ = 0;
+
+  /// @brief Queue reads into every free buffer.
+  void Fill() {
+    while (!free_.empty() && next_offset_ < file_size_) {
+      auto* block = free_.back();
+      free_.pop_back();
+      block->request.write = false;
+      block->request.data = block->data.data();
+      block->request.length = static_cast<std::size_t>(
+          std::min<uint64_t>(block_size_, file_size_ - next_offset_));
+      block->request.offset = next_offset_;
+      queue_->Submit(&block->request);
+      in_flight_.push_back(block);
+      next_offset_ += block->request.length;
+    }
+  }
+
+  /// @brief Wait for every read in flight and free every buffer.
+  void Drain() {
+    for (auto* block : in_flight_) {
+      try {
+        queue_->Wait(&block->request);
+      } catch (...) {
+        // Only whether the buffer is free matters here.
+      }
+      free_.push_back(block);
+    }
+    in_flight_.clear();
+    if (current_ != nullptr) {
+      free_.push_back(current_);
+      current_ = nullptr;
+    }
+  }
+};
+
+AsyncFileSource::AsyncFileSource(const std::filesystem::path& path,
+                                 const AsyncFileOptions& options)
+    : impl_(std::make_unique<AsyncFileSourceImpl>(path, options)) {}
+
+AsyncFileSource::~AsyncFileSource() = default;
+
+bool AsyncFileSource::uses_io_uring() const { return impl_->uses_io_uring(); }
+
+AsyncFileSource::int_type AsyncFileSource::underflow() {
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  auto block = impl_->Next();
+  if (block.empty()) {
+    setg(nullptr, nullptr, nullptr);
+    return traits_type::eof();
+  }
+  setg(block.data(), block.data(), block.data() + block.size());
+  return traits_type::to_int_type(*gptr());
+}
+
+AsyncFileSource::pos_type AsyncFileSource::seekoff(
+    off_type offset, std::ios_base::seekdir direction,
+    std::ios_base::openmode which) {
+  if ((which & std::ios_base::in) == 0) {
+    return {off_type(-1)};
+  }
+
+  auto current =
+      static_cast<off_type>(impl_->block_offset()) + (gptr() - eback());
+  auto target = offset;
+  if (direction == std::ios_base::cur) {
+    target += current;
+  } else if (direction == std::ios_base::end) {
+    target += static_cast<off_type>(impl_->file_size());
+  }
+  if (target < 0) {
+    return {off_type(-1)};
+  }
+
+  // Stay in the current block if possible, so that telling the
+  // position doesn't discard the reads in flight.
+  auto block_start = static_cast<off_type>(impl_->block_offset());
+  if (target >= block_start && target <= block_start + (egptr() - eback())) {
+    setg(eback(), eback() + (target - block_start), egptr());
+    return {target};
+  }
+
+  setg(nullptr, nullptr, nullptr);
+  impl_->Seek(static_cast<uint64_t>(target));
+  return {target};
+}
+
+AsyncFileSource::pos_type AsyncFileSource::seekpos(
+    pos_type position, std::ios_base::openmode which) {
+  return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+class AsyncFileSink::AsyncFileSinkImpl {
+ public:
+  AsyncFileSinkImpl(const std::filesystem::path& path,
+                    const AsyncFileOptions& options)
+      : descriptor_(OpenFile(path, O_WRONLY | O_CREAT | O_TRUNC)),
+        block_size_(std::max<std::size_t>(options.block_size, 1)),
+        blocks_(std::max(options.queue_depth, 1U)),
+        queue_(IoQueue::Create(descriptor_,
+                               static_cast<unsigned int>(blocks_.size()),
+                               options.use_io_uring)) {
+    for (auto& block : blocks_) {
+      block.data.resize(block_size_);
+      free_.push_back(&block);
+    }
+  }
+
+  ~AsyncFileSinkImpl() {
+    // The kernel may still be writing from the buffers.
+    for (auto* block : in_flight_) {
+      try {
+        queue_->Wait(&block->request);
+      } catch (...) {
+        // The file is being abandoned.
+      }
+    }
+    queue_.reset();
+    if (descriptor_ >= 0) {
+      close(descriptor_);
+    }
+  }
+
+  AsyncFileSinkImpl(const AsyncFileSinkImpl&) = delete;
+  AsyncFileSinkImpl& operator=(const AsyncFileSinkImpl&) = delete;
+
+  /// @brief Get a free buffer, waiting for the oldest write if there
+  /// are none.
+  std::span<char> Buffer() {
+    CheckOpen();
+    if (current_ == nullptr) {
+      if (free_.empty()) {
+        Retire();
+      }
+      current_ = free_.back();
+      free_.pop_back();
+    }
+    return {current_->data.data(), current_->data.size()};
+  }
+
+  /// @brief Queue the buffer last returned by Buffer() to be written.
+  /// @param length Number of bytes of it to write. If 0, the buffer is
+  /// kept for the next call to Buffer().
+  void Submit(std::size_t length) {
+    if (current_ == nullptr || length == 0) {
+      return;
+    }
+    auto* block = current_;
+    current_ = nullptr;
+    block->request.write = true;
+    block->request.data = block->data.data();
+    block->request.length = length;
+    block->request.offset = offset_;
+    queue_->Submit(&block->request);
+    in_flight_.push_back(block);
+    offset_ += length;
+  }
+
+  /// @brief Wait for every write in flight.
+  void Flush() {
+    while (!in_flight_.empty()) {
+      Retire();
+    }
+  }
+
+  void Close() {
+    if (descriptor_ < 0) {
+      return;
+    }
+    Flush();
+    auto result = close(descriptor_);
+    descriptor_ = -1;
+    if (result != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Could not close file");
+    }
+  }
+
+  bool is_open() const { return descriptor_ >= 0; }
+
+  bool uses_io_uring() const { return queue_->uses_io_uring(); }
+
+ private:
+  int descriptor_;
+  std::size_t block_size_;
+  std::vector<Block> blocks_;
+  std::unique_ptr<IoQueue> queue_;
+
+  std::vector<Block*> free_;
+  std::deque<Block*> in_flight_;
+  Block* current_ = nullptr;
+  uint64_t offset_ = 0;
+
+  void CheckOpen() const {
+    if (descriptor_ < 0) {
+      throw std::system_error(EBADF, std::generic_category(),
+                              "File has been closed");
+    }
+  }
+
+  /// @brief Wait for the oldest write in flight and free its buffer.
+  void Retire() {
+    auto* block = in_flight_.front();
+    in_flight_.pop_front();
+    free_.push_back(block);
+    queue_->Wait(&block->request);
+    CheckRequest(block->request, "Could not write file");
+    if (static_cast<std::size_t>(block->request.result) <
+        block->request.length) {
+      throw std::system_error(EIO, std::generic_category(),
+                              "Could not write file");
+    }
+  }
+};
+
+AsyncFileSink::AsyncFileSink(const std::filesystem::path& path,
+                             const AsyncFileOptions& options)
+    : impl_(std::make_unique<AsyncFileSinkImpl>(path, options)) {}
+
+AsyncFileSink::~AsyncFileSink() {
+  try {
+    Close();
+  } catch (...) {
+    // Close() reports errors to callers who need them.
+  }
+}
+
+void AsyncFileSink::Close() {
+  if (!impl_->is_open()) {
+    return;
+  }
+  impl_->Submit(static_cast<std::size_t>(pptr() - pbase()));
+  setp(nullptr, nullptr);
+  impl_->Close();
+}
+
+bool AsyncFileSink::uses_io_uring() const { return impl_->uses_io_uring(); }
+
+AsyncFileSink::int_type AsyncFileSink::overflow(int_type c) {
+  impl_->Submit(static_cast<std::size_t>(pptr() - pbase()));
+  auto buffer = impl_->Buffer();
+  setp(buffer.data(), buffer.data() + buffer.size());
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int AsyncFileSink::sync() {
+  try {
+    impl_->Submit(static_cast<std::size_t>(pptr() - pbase()));
+    setp(nullptr, nullptr);
+    impl_->Flush();
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "base_extractor.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "collecting_dump_parser.h"
+#include "dump_parser.h"
+#include "extraction_merger.h"
+#include "page_range_impl.h"
+#include "page_sink_dump_parser.h"
+#include "parsed_page_writer.h"
+#include "pipelined_dump_parser.h"
+#include "resumed_dump_buffer.h"
+#include "reusing_dump_parser.h"
+#include "sharded_dump_parser.h"
+#include "sharded_page_writer.h"
+#include "streaming_dump_parser.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+std::pair<std::unique_ptr<std::vector<proto::Page>>,
+          // NOLINTNEXTLINE(whitespace/indent_namespace)
+          std::unique_ptr<std::map<uint64_t, proto::Revision>>>
+BaseExtractor::ExtractXML(std::istream& stream) {
+  if (!options_.pipeline) {
+    auto xml_parser = DumpParser(citation_parser_, options_);
+    return xml_parser.ParseXML(stream);
+  }
+
+  auto pages = std::make_unique<std::vector<proto::Page>>();
+  auto revisions = std::make_unique<std::map<uint64_t, proto::Revision>>();
+
+  auto xml_parser = PipelinedDumpParser(citation_parser_, options_);
+  xml_parser.Parse(stream, [&pages, &revisions](ParsedPage&& parsed) {
+    pages->push_back(std::move(parsed.page));
+    revisions->merge(parsed.revisions);
+  });
+
+  return std::make_pair(std::move(pages), std::move(revisions));
+}
+
+std::pair<uint64_t, uint64_t> BaseExtractor::ExtractXML(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  if (!options_.pipeline) {
+    auto xml_parser = StreamingDumpParser(citation_parser_, options_);
+    return xml_parser.ParseXML(input, pages_output, revisions_output,
+                               checkpoint);
+  }
+
+  // Checkpoints are taken between batches, which only cover a run of
+  // the input when they are written in order.
+  if (options_.checkpoint_interval > 0 && !options_.preserve_order) {
+    throw std::invalid_argument(
+        "Pipelined checkpoints need the page order to be preserved");
+  }
+
+  // The page splitter only looks for whole pages, so can carry on from
+  // between any two of them.
+  SkipDumpInput(&input, checkpoint.input_offset);
+
+  auto writer = ParsedPageWriter(pages_output, revisions_output,
+                                 options_.revision_encoding);
+  uint64_t pages_at_checkpoint = 0;
+  auto take_checkpoint = [&](uint64_t batch_end) {
+    auto [pages_written, revisions_written] = writer.counts();
+    if (options_.checkpoint_interval == 0 ||
+        pages_written - pages_at_checkpoint < options_.checkpoint_interval) {
+      return;
+    }
+    pages_at_checkpoint = pages_written;
+
+    writer.Flush();
+    if (!pages_output->flush() || !revisions_output->flush()) {
+      throw std::runtime_error("Could not write to output stream");
+    }
+    if (!options_.on_checkpoint) {
+      return;
+    }
+
+    auto [page_bytes, revision_bytes] = writer.bytes_written();
+    auto next = ExtractorCheckpoint();
+    next.input_offset = checkpoint.input_offset + batch_end;
+    next.pages_written = checkpoint.pages_written + pages_written;
+    next.revisions_written = checkpoint.revisions_written + revisions_written;
+    next.pages_output_size = checkpoint.pages_output_size + page_bytes;
+    next.revisions_output_size =
+        checkpoint.revisions_output_size + revision_bytes;
+    options_.on_checkpoint(next);
+  };
+
+  auto xml_parser = PipelinedDumpParser(citation_parser_, options_);
+  xml_parser.Parse(
+      input, [&writer](ParsedPage&& parsed) { writer.Write(parsed); },
+      take_checkpoint);
+  writer.Flush();
+
+  auto [pages_written, revisions_written] = writer.counts();
+  return {checkpoint.pages_written + pages_written,
+          checkpoint.revisions_written + revisions_written};
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> BaseExtractor::ExtractXML(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  if (!options_.pipeline) {
+    auto xml_parser = ShardedDumpParser(citation_parser_, options_);
+    return xml_parser.ParseXML(input, shards);
+  }
+
+  auto writer = ShardedPageWriter(shards, true, options_.revision_encoding);
+  auto xml_parser = PipelinedDumpParser(citation_parser_, options_);
+  xml_parser.Parse(input, [&writer](ParsedPage&& parsed) {
+    writer.Write(std::move(parsed));
+  });
+
+  return writer.Finish();
+}
+
+std::pair<uint64_t, uint64_t> BaseExtractor::ExtractXML(std::istream& input,
+                                                        PageSink& sink) {
+  if (!options_.pipeline) {
+    auto xml_parser = PageSinkDumpParser(citation_parser_, options_);
+    return xml_parser.ParseXML(input, sink);
+  }
+
+  uint64_t pages_consumed = 0;
+  uint64_t revisions_consumed = 0;
+
+  auto xml_parser = PipelinedDumpParser(citation_parser_, options_);
+  xml_parser.Parse(input, [&](ParsedPage&& parsed) {
+    pages_consumed++;
+    revisions_consumed += parsed.revisions.size();
+    sink.Consume(std::move(parsed));
+  });
+
+  return {pages_consumed, revisions_consumed};
+}
+
+PageRange BaseExtractor::PagesXML(
+    std::istream* input, std::unique_ptr<std::streambuf> decompression) {
+  return PageRange(std::make_unique<PageRange::PageRangeImpl>(
+      input, std::move(decompression), citation_parser_, options_));
+}
+
+std::pair<uint64_t, uint64_t> BaseExtractor::ExtractIncrementalXML(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  // Unchanged revisions are copied through as they are, so both
+  // extractions must use the same encoding.
+  if (options_.revision_encoding != RevisionEncoding::kMessages) {
+    throw std::invalid_argument(
+        "Incremental extraction only supports revisions written as "
+        "messages");
+  }
+
+  auto xml_parser = CollectingDumpParser(citation_parser_, options_);
+  auto merger = ExtractionMerger(&previous_pages, &previous_revisions,
+                                 pages_output, revisions_output, &xml_parser);
+  return merger.Merge(input);
+}
+
+std::pair<uint64_t, uint64_t> BaseExtractor::ExtractReusingXML(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  // Reused revisions are copied through as they are, so both
+  // extractions must use the same encoding.
+  if (options_.revision_encoding != RevisionEncoding::kMessages) {
+    throw std::invalid_argument(
+        "Reusing extraction only supports revisions written as messages");
+  }
+  auto streams = (previous.pages != nullptr ? 1 : 0) +
+                 (previous.revisions != nullptr ? 1 : 0) +
+                 (previous.page_versions != nullptr ? 1 : 0);
+  if (streams != 0 && streams != 3) {
+    throw std::invalid_argument(
+        "Previous extraction needs its pages, revisions and page versions");
+  }
+
+  auto xml_parser = ReusingDumpParser(citation_parser_, options_);
+  return xml_parser.Parse(input, previous, pages_output, revisions_output,
+                          page_versions_output);
+}
+}  // namespace wikiopencite::citescoop
@@ -4,10 +4,19 @@
 #ifndef SRC_EXTRACT_BASE_EXTRACTOR_H_
 #define SRC_EXTRACT_BASE_EXTRACTOR_H_
 
+#include <cstdint>
+#include <istream>
+#include <map>
 #include <memory>
+#include <ostream>
+#include <streambuf>
 #include <utility>
+#include <vector>
 
+#include "citescoop/extract.h"
 #include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
 
 namespace wikiopencite::citescoop {
 
@@ -17,11 +26,113 @@ class BaseExtractor {
   /// @brief Construct a new base extractor.
   /// @param citation_parser Citation parser to use.
   explicit BaseExtractor(std::shared_ptr<Parser> citation_parser)
-      : citation_parser_(std::move(citation_parser)) {}
+      : BaseExtractor(std::move(citation_parser), ExtractorOptions()) {}
+
+  /// @brief Construct a new base extractor with extractor options.
+  /// @param citation_parser Citation parser to use.
+  /// @param options Extractor options.
+  BaseExtractor(std::shared_ptr<Parser> citation_parser,
+                ExtractorOptions options)
+      : citation_parser_(std::move(citation_parser)), options_(options) {}
 
  protected:
+  /// @brief Extract citations from a plain XML stream.
+  ///
+  /// Uses the pipelined parser if configured, otherwise the sequential
+  /// dump parser.
+  ///
+  /// @param stream Plain XML stream.
+  /// @return Pages and referenced revisions.
+  std::pair<std::unique_ptr<std::vector<wikiopencite::proto::Page>>,
+            std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>>
+  ExtractXML(std::istream& stream);
+
+  /// @brief Extract citations from a plain XML stream to output streams.
+  /// @param input Plain XML stream.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from. If its input offset is
+  /// 0, the stream is extracted from the start.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractXML(
+      std::istream& input, std::ostream* pages_output,
+      std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint);
+
+  /// @brief Extract citations from a plain XML stream to shards of
+  /// output streams.
+  ///
+  /// Uses the pipelined parser if configured, with a writer thread for
+  /// each shard, otherwise the sequential dump parser.
+  ///
+  /// @param input Plain XML stream.
+  /// @param shards Output streams of each shard.
+  /// @return The number of pages written, then the number of revisions
+  /// written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> ExtractXML(
+      std::istream& input, const std::vector<ShardOutput>& shards);
+
+  /// @brief Extract citations from a plain XML stream into a page sink.
+  ///
+  /// Uses the pipelined parser if configured, in which case pages are
+  /// handed to the sink on this thread as the workers finish them,
+  /// otherwise the sequential dump parser.
+  ///
+  /// @param input Plain XML stream.
+  /// @param sink Sink to consume each page.
+  /// @return The number of pages consumed, then the number of revisions
+  /// consumed.
+  std::pair<uint64_t, uint64_t> ExtractXML(std::istream& input,
+                                           PageSink& sink);
+
+  /// @brief Lazily extract citations from a plain XML stream.
+  /// @param input Plain XML stream. Ignored if decompression is set.
+  /// @param decompression Stream buffer decompressing the dump, which
+  /// is then owned by the range. May be null.
+  /// @return Range of the extracted pages.
+  PageRange PagesXML(std::istream* input,
+                     std::unique_ptr<std::streambuf> decompression);
+
+  /// @brief Apply an incremental plain XML dump to a previous
+  /// streaming extraction.
+  ///
+  /// The changed pages are cut out of the dump up front, then parsed
+  /// one at a time on this thread as the merge reaches them, each
+  /// carrying on from its previous extraction. The pipeline option is
+  /// not used.
+  ///
+  /// @param input Plain XML stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractIncrementalXML(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Extract citations from a plain XML stream, reusing the
+  /// results of an earlier extraction for unchanged pages.
+  /// @param input Plain XML stream to extract from.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractReusingXML(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output);
+
   /// Citation parser to use
   std::shared_ptr<Parser> citation_parser_;
+
+  /// Extractor options
+  ExtractorOptions options_;
 };
 }  // namespace wikiopencite::citescoop
 
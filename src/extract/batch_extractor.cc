@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "batch_extractor_impl.h"
+
+namespace wikiopencite::citescoop {
+
+BatchExtractor::BatchExtractor(
+    const std::shared_ptr<wikiopencite::citescoop::Parser>& parser,
+    ExtractorOptions options, unsigned int concurrency)
+    : impl_(std::make_unique<BatchExtractorImpl>(parser, std::move(options),
+                                                 concurrency)) {}
+
+BatchExtractor::~BatchExtractor() = default;
+
+std::pair<uint64_t, uint64_t> BatchExtractor::Extract(
+    const std::vector<DumpPart>& parts) {
+  return impl_->Extract(parts);
+}
+}  // namespace wikiopencite::citescoop
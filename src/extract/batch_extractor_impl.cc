@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "batch_extractor_impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <istream>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/io.h"
+#include "citescoop/parser.h"
+
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+BatchExtractor::BatchExtractorImpl::BatchExtractorImpl(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options, unsigned int concurrency)
+    : parser_(std::move(parser)),
+      options_(std::move(options)),
+      concurrency_(concurrency) {}
+
+std::pair<uint64_t, uint64_t> BatchExtractor::BatchExtractorImpl::Extract(
+    const std::vector<DumpPart>& parts) {
+  // The pool runs tasks in the order they are submitted, so submitting
+  // the largest parts first starts them first.
+  auto failed = std::atomic<bool>(false);
+  auto pool = WorkerPool(concurrency_);
+  auto pending = std::deque<std::future<std::pair<uint64_t, uint64_t>>>();
+  for (auto index : OrderBySize(parts)) {
+    const auto* part = &parts[index];
+    pending.push_back(pool.Submit(
+        [this, part, &failed]() -> std::pair<uint64_t, uint64_t> {
+          if (failed) {
+            return {0, 0};
+          }
+          try {
+            return ExtractPart(*part);
+          } catch (...) {
+            failed = true;
+            throw;
+          }
+        }));
+  }
+
+  uint64_t pages_written = 0;
+  uint64_t revisions_written = 0;
+  auto error = std::exception_ptr();
+  while (!pending.empty()) {
+    try {
+      auto [pages, revisions] = pending.front().get();
+      pages_written += pages;
+      revisions_written += revisions;
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    pending.pop_front();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return {pages_written, revisions_written};
+}
+
+std::unique_ptr<Extractor> BatchExtractor::BatchExtractorImpl::MakeExtractor(
+    const DumpPart& part) const {
+  auto extension = part.input.extension();
+  if (extension == ".bz2") {
+    return std::make_unique<Bz2Extractor>(parser_, options_);
+  }
+  if (extension == ".zst") {
+    return std::make_unique<ZstdExtractor>(parser_, options_);
+  }
+  return std::make_unique<TextExtractor>(parser_, options_);
+}
+
+std::pair<uint64_t, uint64_t> BatchExtractor::BatchExtractorImpl::ExtractPart(
+    const DumpPart& part) const {
+  // Parts are read and written with several blocks in flight, so that
+  // a worker isn't left waiting on storage between blocks.
+  auto source = AsyncFileSource(part.input);
+  auto input = std::istream(&source);
+  auto pages_sink = AsyncFileSink(part.pages_output);
+  auto revisions_sink = AsyncFileSink(part.revisions_output);
+  auto pages_output = std::ostream(&pages_sink);
+  auto revisions_output = std::ostream(&revisions_sink);
+
+  auto counts =
+      MakeExtractor(part)->Extract(input, &pages_output, &revisions_output);
+
+  if (input.bad() || !pages_output.flush() || !revisions_output.flush()) {
+    throw std::runtime_error("Could not read or write dump part " +
+                             part.input.string());
+  }
+  pages_sink.Close();
+  revisions_sink.Close();
+  return counts;
+}
+
+std::vector<std::size_t> BatchExtractor::BatchExtractorImpl::OrderBySize(
+    const std::vector<DumpPart>& parts) {
+  // A part that can't be sized is left to fail when it is opened.
+  auto sizes = std::vector<uintmax_t>();
+  sizes.reserve(parts.size());
+  for (const auto& part : parts) {
+    auto error = std::error_code();
+    auto size = std::filesystem::file_size(part.input, error);
+    sizes.push_back(error ? 0 : size);
+  }
+
+  auto order = std::vector<std::size_t>(parts.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&sizes](std::size_t first,
+                                           std::size_t second) {
+    return sizes[first] > sizes[second];
+  });
+  return order;
+}
+}  // namespace wikiopencite::citescoop
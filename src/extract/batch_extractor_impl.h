@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_BATCH_EXTRACTOR_IMPL_H_
+#define SRC_EXTRACT_BATCH_EXTRACTOR_IMPL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Implementation of the batch extractor.
+class BatchExtractor::BatchExtractorImpl {
+ public:
+  /// @brief Construct a new batch extractor.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options to extract each part with.
+  /// @param concurrency Number of parts to extract at once, 0 for one
+  /// per hardware thread.
+  BatchExtractorImpl(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                     ExtractorOptions options, unsigned int concurrency);
+
+  /// @brief Extract each part of a dump to its output files.
+  /// @param parts Parts to extract.
+  /// @return Total number of pages followed by total number of
+  /// revisions written.
+  std::pair<uint64_t, uint64_t> Extract(const std::vector<DumpPart>& parts);
+
+ private:
+  std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
+  ExtractorOptions options_;
+  unsigned int concurrency_;
+
+  /// @brief Create the extractor for a part, based on its extension.
+  /// @param part Part to extract.
+  /// @return Extractor for the part.
+  std::unique_ptr<Extractor> MakeExtractor(const DumpPart& part) const;
+
+  /// @brief Extract a single part.
+  /// @param part Part to extract.
+  /// @return Number of pages followed by number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractPart(const DumpPart& part) const;
+
+  /// @brief Order parts largest first.
+  /// @param parts Parts to order.
+  /// @return Indices of the parts, largest part first.
+  static std::vector<std::size_t> OrderBySize(
+      const std::vector<DumpPart>& parts);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_BATCH_EXTRACTOR_IMPL_H_
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_BOUNDED_QUEUE_H_
+#define SRC_EXTRACT_BOUNDED_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <utility>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Thread safe FIFO queue holding at most a fixed number of items.
+///
+/// Producers block while the queue is full, giving backpressure between
+/// pipeline stages so that memory use stays bounded.
+///
+/// @tparam T Type of item held in the queue.
+template <class T>
+class BoundedQueue {
+ public:
+  /// @brief Construct a new queue.
+  /// @param capacity Maximum number of items held in the queue.
+  explicit BoundedQueue(std::size_t capacity) : capacity_(capacity) {}
+
+  /// @brief Push an item, blocking while the queue is full.
+  /// @param item Item to push.
+  /// @return False if the queue has been closed, in which case the item
+  /// is discarded.
+  bool Push(T item) {
+    std::unique_lock lock(mutex_);
+    not_full_.wait(lock,
+                   [this]() { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+
+    items_.push(std::move(item));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// @brief Pop an item, blocking while the queue is empty.
+  /// @return The item, or nothing once the queue is closed and empty.
+  std::optional<T> Pop() {
+    std::unique_lock lock(mutex_);
+    not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+
+    auto item = std::move(items_.front());
+    items_.pop();
+    lock.unlock();
+    not_full_.notify_one();
+    return item;
+  }
+
+  /// @brief Close the queue.
+  ///
+  /// Any blocked producers are woken and further pushes are rejected.
+  /// Items already queued can still be popped.
+  void Close() {
+    {
+      std::scoped_lock lock(mutex_);
+      closed_ = true;
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::size_t capacity_;
+  std::queue<T> items_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  bool closed_ = false;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_BOUNDED_QUEUE_H_
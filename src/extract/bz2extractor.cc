@@ -5,7 +5,9 @@
 #include <istream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -15,6 +17,7 @@
 #include "citescoop/proto/revision.pb.h"
 
 #include "bz2extractor_impl.h"
+#include "multistream_dump_index_impl.h"
 
 namespace wikiopencite::citescoop {
 
@@ -24,6 +27,11 @@ Bz2Extractor::Bz2Extractor(
     const std::shared_ptr<wikiopencite::citescoop::Parser>& parser)
     : impl_(std::make_unique<Bz2ExtractorImpl>(parser)) {}
 
+Bz2Extractor::Bz2Extractor(
+    const std::shared_ptr<wikiopencite::citescoop::Parser>& parser,
+    ExtractorOptions options)
+    : impl_(std::make_unique<Bz2ExtractorImpl>(parser, options)) {}
+
 Bz2Extractor::~Bz2Extractor() = default;
 
 std::pair<std::unique_ptr<std::vector<proto::Page>>,
@@ -35,6 +43,67 @@ Bz2Extractor::Extract(std::istream& stream) {
 std::pair<uint64_t, uint64_t> Bz2Extractor::Extract(
     std::istream& input, std::ostream* pages_output,
     std::ostream* revisions_output) {
-  return impl_->Extract(input, pages_output, revisions_output);
+  return impl_->Extract(input, pages_output, revisions_output,
+                        ExtractorCheckpoint());
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::Extract(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  return impl_->Extract(input, pages_output, revisions_output, checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> Bz2Extractor::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  return impl_->Extract(input, shards);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::Extract(std::istream& input,
+                                                    PageSink& sink) {
+  return impl_->Extract(input, sink);
+}
+
+PageRange Bz2Extractor::Pages(std::istream& input) {
+  return impl_->Pages(input);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  return impl_->ExtractIncremental(input, previous_pages, previous_revisions,
+                                   pages_output, revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  return impl_->ExtractReusing(input, previous, pages_output,
+                               revisions_output, page_versions_output);
+}
+
+std::pair<std::unique_ptr<std::vector<proto::Page>>,
+          std::unique_ptr<std::map<uint64_t, proto::Revision>>>
+Bz2Extractor::ExtractMultistream(std::istream& stream, std::istream& index) {
+  return impl_->ExtractMultistream(stream, index);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::ExtractMultistream(
+    std::istream& input, std::istream& index, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  return impl_->ExtractMultistream(input, index, pages_output,
+                                   revisions_output);
+}
+
+std::optional<ExtractedPage> Bz2Extractor::ExtractPage(
+    std::istream& input, const MultistreamDumpIndex& index, uint64_t page_id) {
+  return impl_->ExtractPage(input, *index.impl_, page_id);
+}
+
+std::optional<ExtractedPage> Bz2Extractor::ExtractPage(
+    std::istream& input, const MultistreamDumpIndex& index,
+    const std::string& title) {
+  return impl_->ExtractPage(input, *index.impl_, title);
 }
 }  // namespace wikiopencite::citescoop
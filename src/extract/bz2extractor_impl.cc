@@ -7,7 +7,11 @@
 #include <istream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <streambuf>
+#include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -20,8 +24,12 @@
 #include "citescoop/proto/revision.pb.h"
 
 #include "base_extractor.h"
-#include "dump_parser.h"
-#include "streaming_dump_parser.h"
+#include "collecting_dump_parser.h"
+#include "multistream_dump_index_impl.h"
+#include "multistream_dump_parser.h"
+#include "multistream_index.h"
+#include "parallel_bz2_decompressor.h"
+#include "parsed_page_writer.h"
 
 namespace wikiopencite::citescoop {
 namespace proto = wikiopencite::proto;
@@ -32,30 +40,171 @@ Bz2Extractor::Bz2ExtractorImpl::Bz2ExtractorImpl(
     // NOLINTNEXTLINE(whitespace/indent_namespace)
     : BaseExtractor(std::move(parser)) {}
 
+Bz2Extractor::Bz2ExtractorImpl::Bz2ExtractorImpl(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    // NOLINTNEXTLINE(whitespace/indent_namespace)
+    : BaseExtractor(std::move(parser), options) {}
+
 std::pair<std::unique_ptr<std::vector<proto::Page>>,
           // NOLINTNEXTLINE(whitespace/indent_namespace)
           std::unique_ptr<std::map<uint64_t, proto::Revision>>>
 Bz2Extractor::Bz2ExtractorImpl::Extract(std::istream& stream) {
-  bio::filtering_streambuf<bio::input> decompression_stream;
-  decompression_stream.push(bio::bzip2_decompressor());
-  decompression_stream.push(stream);
+  auto decompression_stream = MakeDecompressionBuffer(stream);
+  std::istream decompressed_stream(decompression_stream.get());
 
-  std::istream decompressed_stream(&decompression_stream);
-
-  auto xml_parser = DumpParser(citation_parser_);
-  return xml_parser.ParseXML(decompressed_stream);
+  return ExtractXML(decompressed_stream);
 }
 
 std::pair<uint64_t, uint64_t> Bz2Extractor::Bz2ExtractorImpl::Extract(
     std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, pages_output, revisions_output,
+                    checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>>
+Bz2Extractor::Bz2ExtractorImpl::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, shards);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::Bz2ExtractorImpl::Extract(
+    std::istream& input, PageSink& sink) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, sink);
+}
+
+PageRange Bz2Extractor::Bz2ExtractorImpl::Pages(std::istream& input) {
+  return PagesXML(nullptr, MakeDecompressionBuffer(input));
+}
+
+std::pair<uint64_t, uint64_t>
+Bz2Extractor::Bz2ExtractorImpl::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
     std::ostream* revisions_output) {
-  bio::filtering_streambuf<bio::input> decompression_stream;
-  decompression_stream.push(bio::bzip2_decompressor());
-  decompression_stream.push(input);
-
-  std::istream decompressed_stream(&decompression_stream);
-  auto xml_parser = StreamingDumpParser(citation_parser_);
-  return xml_parser.ParseXML(decompressed_stream, pages_output,
-                             revisions_output);
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractIncrementalXML(decompressed_stream, previous_pages,
+                               previous_revisions, pages_output,
+                               revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> Bz2Extractor::Bz2ExtractorImpl::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractReusingXML(decompressed_stream, previous, pages_output,
+                           revisions_output, page_versions_output);
+}
+
+std::pair<std::unique_ptr<std::vector<proto::Page>>,
+          // NOLINTNEXTLINE(whitespace/indent_namespace)
+          std::unique_ptr<std::map<uint64_t, proto::Revision>>>
+Bz2Extractor::Bz2ExtractorImpl::ExtractMultistream(std::istream& stream,
+                                                   std::istream& index) {
+  auto pages = std::make_unique<std::vector<proto::Page>>();
+  auto revisions = std::make_unique<std::map<uint64_t, proto::Revision>>();
+
+  auto xml_parser = MultistreamDumpParser(citation_parser_, options_);
+  xml_parser.Parse(stream, MultistreamIndex::Read(index).StreamOffsets(),
+                   [&pages, &revisions](ParsedPage&& parsed) {
+                     pages->push_back(std::move(parsed.page));
+                     revisions->merge(parsed.revisions);
+                   });
+
+  return std::make_pair(std::move(pages), std::move(revisions));
+}
+
+std::pair<uint64_t, uint64_t>
+Bz2Extractor::Bz2ExtractorImpl::ExtractMultistream(
+    std::istream& input, std::istream& index, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  auto writer = ParsedPageWriter(pages_output, revisions_output,
+                                 options_.revision_encoding);
+  auto xml_parser = MultistreamDumpParser(citation_parser_, options_);
+  xml_parser.Parse(input, MultistreamIndex::Read(index).StreamOffsets(),
+                   [&writer](ParsedPage&& parsed) { writer.Write(parsed); });
+  writer.Flush();
+
+  return writer.counts();
+}
+
+std::optional<ExtractedPage> Bz2Extractor::Bz2ExtractorImpl::ExtractPage(
+    std::istream& input,
+    const MultistreamDumpIndex::MultistreamDumpIndexImpl& index,
+    uint64_t page_id) {
+  auto options = options_;
+  options.page_filter.page_ids =
+      std::make_shared<const std::unordered_set<uint64_t>>(
+          std::unordered_set<uint64_t>{page_id});
+  options.page_filter.titles = nullptr;
+  return ExtractPageStream(input, index.Find(page_id), options);
+}
+
+std::optional<ExtractedPage> Bz2Extractor::Bz2ExtractorImpl::ExtractPage(
+    std::istream& input,
+    const MultistreamDumpIndex::MultistreamDumpIndexImpl& index,
+    const std::string& title) {
+  auto options = options_;
+  options.page_filter.page_ids = nullptr;
+  options.page_filter.titles =
+      std::make_shared<const std::unordered_set<std::string>>(
+          std::unordered_set<std::string>{title});
+  return ExtractPageStream(input, index.Find(title), options);
+}
+
+std::optional<ExtractedPage>
+Bz2Extractor::Bz2ExtractorImpl::ExtractPageStream(
+    std::istream& input, const std::optional<StreamLocation>& location,
+    ExtractorOptions options) {
+  if (!location) {
+    return std::nullopt;
+  }
+
+  input.clear();
+  if (!input.seekg(static_cast<std::streamoff>(location->offset))) {
+    throw DumpParseException("Could not seek to the stream at offset " +
+                             std::to_string(location->offset));
+  }
+
+  // A pool would be started and joined for every lookup, which costs
+  // far more than parsing a single page's revisions in turn.
+  options.revision_threads = 1;
+
+  auto compressed = MultistreamDumpParser::ReadStream(input, location->length);
+  auto xml_parser = MultistreamDumpParser(citation_parser_, options);
+  auto pages = xml_parser.ParseStream(compressed);
+  if (pages.empty()) {
+    return std::nullopt;
+  }
+  return std::move(pages.front());
+}
+
+std::unique_ptr<std::streambuf>
+Bz2Extractor::Bz2ExtractorImpl::MakeDecompressionBuffer(std::istream& input) {
+  if (options_.decompression_threads != 1) {
+    return std::make_unique<ParallelBz2Decompressor>(
+        &input, options_.decompression_threads);
+  }
+
+  auto decompression_stream =
+      std::make_unique<bio::filtering_streambuf<bio::input>>();
+  decompression_stream->push(bio::bzip2_decompressor());
+  decompression_stream->push(input);
+  return decompression_stream;
 }
 }  // namespace wikiopencite::citescoop
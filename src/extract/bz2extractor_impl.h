@@ -8,7 +8,10 @@
 #include <istream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <streambuf>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -18,6 +21,7 @@
 #include "citescoop/proto/revision.pb.h"
 
 #include "base_extractor.h"
+#include "multistream_dump_index_impl.h"
 
 namespace wikiopencite::citescoop {
 
@@ -29,6 +33,12 @@ class Bz2Extractor::Bz2ExtractorImpl : BaseExtractor {
   explicit Bz2ExtractorImpl(
       std::shared_ptr<wikiopencite::citescoop::Parser> parser);
 
+  /// @brief Create a new bzip extractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options.
+  Bz2ExtractorImpl(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                   ExtractorOptions options);
+
   /// @brief Extract implementation. This will decompress the input
   /// stream and pass it off to the XML parser.
   ///
@@ -43,10 +53,119 @@ class Bz2Extractor::Bz2ExtractorImpl : BaseExtractor {
   /// @param input Input compressed bzip stream.
   /// @param pages_output Output stream for pages.
   /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
   /// @return The number of pages written, then the number of revisions written.
   std::pair<uint64_t, uint64_t> Extract(std::istream& input,
                                         std::ostream* pages_output,
-                                        std::ostream* revisions_output);
+                                        std::ostream* revisions_output,
+                                        const ExtractorCheckpoint& checkpoint);
+
+  /// @brief Sharded extract implementation.
+  /// @param input Input compressed bzip stream.
+  /// @param shards Output streams of each shard.
+  /// @return The number of pages written, then the number of revisions
+  /// written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards);
+
+  /// @brief Extract implementation handing pages to a sink.
+  /// @param input Input compressed bz2 stream.
+  /// @param sink Sink to consume each page.
+  /// @return The number of pages consumed, then the number of revisions
+  /// consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input, PageSink& sink);
+
+  /// @brief Lazy extract implementation.
+  /// @param input Input compressed bz2 stream.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input);
+
+  /// @brief Incremental extract implementation.
+  /// @param input Input compressed bz2 stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Reusing extract implementation.
+  /// @param input Input compressed bz2 stream.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output);
+
+  /// @brief Multistream extract implementation. Reads the index and
+  /// hands each bzip2 stream of the dump off to a worker.
+  /// @param stream Input compressed multistream dump.
+  /// @param index Multistream index stream.
+  /// @return Pages and the referenced revisions.
+  std::pair<std::unique_ptr<std::vector<wikiopencite::proto::Page>>,
+            std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>>
+  ExtractMultistream(std::istream& stream, std::istream& index);
+
+  /// @brief Multistream extract implementation, writing pages and
+  /// revisions to the output streams as they are merged.
+  /// @param input Input compressed multistream dump.
+  /// @param index Multistream index stream.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @return The number of pages written, then the number of revisions written.
+  std::pair<uint64_t, uint64_t> ExtractMultistream(
+      std::istream& input, std::istream& index, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Single page extract implementation.
+  /// @param input Seekable compressed multistream dump.
+  /// @param index Multistream dump index.
+  /// @param page_id ID of the page to extract.
+  /// @return The page and its revisions, or nothing if not in the dump.
+  std::optional<ExtractedPage> ExtractPage(
+      std::istream& input,
+      const MultistreamDumpIndex::MultistreamDumpIndexImpl& index,
+      uint64_t page_id);
+
+  /// @brief Single page extract implementation.
+  /// @param input Seekable compressed multistream dump.
+  /// @param index Multistream dump index.
+  /// @param title Title of the page to extract.
+  /// @return The page and its revisions, or nothing if not in the dump.
+  std::optional<ExtractedPage> ExtractPage(
+      std::istream& input,
+      const MultistreamDumpIndex::MultistreamDumpIndexImpl& index,
+      const std::string& title);
+
+ private:
+  /// @brief Parse the stream holding a single page.
+  /// @param input Seekable compressed multistream dump.
+  /// @param location Location of the stream holding the page, if any.
+  /// @param options Options filtering out every other page.
+  /// @return The page and its revisions, or nothing if it was not found
+  /// or was filtered out.
+  std::optional<ExtractedPage> ExtractPageStream(
+      std::istream& input, const std::optional<StreamLocation>& location,
+      ExtractorOptions options);
+
+  /// @brief Create the stream buffer decompressing the input stream.
+  ///
+  /// Uses the parallel block decompressor if configured with more than
+  /// one decompression thread.
+  ///
+  /// @param input Input compressed bzip stream.
+  /// @return Stream buffer of the decompressed input.
+  std::unique_ptr<std::streambuf> MakeDecompressionBuffer(std::istream& input);
 };
 
 }  // namespace wikiopencite::citescoop
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "collecting_dump_parser.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+namespace {
+const char kPageStart[] = "<page>";
+const char kPageEnd[] = "</page>";
+const char kDocumentStart[] = "<mediawiki>";
+const char kDocumentEnd[] = "</mediawiki>";
+}  // namespace
+
+CollectingDumpParser::CollectingDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options, std::shared_ptr<WorkerPool> revision_pool)
+    : DumpParser(std::move(parser), options, std::move(revision_pool)) {}
+
+std::vector<ParsedPage> CollectingDumpParser::ParseXML(std::istream& stream) {
+  pages_.clear();
+  StartParser(stream);
+  return std::move(pages_);
+}
+
+std::vector<ParsedPage> CollectingDumpParser::ParseFragment(
+    const std::string& xml, const ParsedPage* previous) {
+  auto first = xml.find(kPageStart);
+  auto last = xml.rfind(kPageEnd);
+  if (first == std::string::npos || last == std::string::npos) {
+    return {};
+  }
+
+  last += sizeof(kPageEnd) - 1;
+  auto document = std::string(kDocumentStart);
+  document.append(xml, first, last - first);
+  document.append(kDocumentEnd);
+
+  auto stream = std::istringstream(document);
+  SetPreviousPage(previous);
+  auto pages = ParseXML(stream);
+  SetPreviousPage(nullptr);
+  return pages;
+}
+
+void CollectingDumpParser::Store(
+    const std::map<uint64_t, const proto::Revision*>& revisions,
+    const proto::Page& page) {
+  auto& parsed = pages_.emplace_back(ParsedPage{page, {}});
+  for (const auto& [revision_id, revision] : revisions) {
+    parsed.revisions.emplace(revision_id, *revision);
+  }
+}
+
+}  // namespace wikiopencite::citescoop
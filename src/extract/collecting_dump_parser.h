@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_COLLECTING_DUMP_PARSER_H_
+#define SRC_EXTRACT_COLLECTING_DUMP_PARSER_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief A parsed page along with the revisions its citations reference.
+using ParsedPage = ExtractedPage;
+
+/// @brief MediaWiki XML dump parser that keeps each page grouped with
+/// its revisions.
+///
+/// Used by the parallel extraction modes so that the results of each
+/// worker can be merged in the same per-page order the streaming
+/// parser would write them.
+class CollectingDumpParser : private DumpParser {
+ public:
+  /// @brief Construct a new collecting dumps parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options to configure the parser with.
+  /// @param revision_pool Pool to parse the revisions of large pages
+  /// on, shared with other parsers. If null, the parser starts its own
+  /// once a page needs it.
+  CollectingDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                       ExtractorOptions options,
+                       std::shared_ptr<WorkerPool> revision_pool = nullptr);
+
+  /// @brief Parse the dump XML.
+  /// @param stream An input stream of plain XML.
+  /// @return Parsed pages in the order they appear in the stream.
+  std::vector<ParsedPage> ParseXML(std::istream& stream);
+
+  /// @brief Parse a fragment of dump XML.
+  ///
+  /// Parallel extraction hands each worker a run of @c page elements
+  /// cut out of the dump, possibly along with part of the document
+  /// header or footer. Everything outside of the page elements is
+  /// dropped and the pages are wrapped in a root element so that they
+  /// can be parsed on their own.
+  ///
+  /// @param xml Dump XML holding one or more whole page elements.
+  /// @param previous Earlier extraction of the pages, which their
+  /// revisions carry on from, or null if there is none. See
+  /// DumpParser::SetPreviousPage().
+  /// @return Parsed pages in the order they appear in the fragment.
+  std::vector<ParsedPage> ParseFragment(const std::string& xml,
+                                        const ParsedPage* previous = nullptr);
+
+ protected:
+  void Store(
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>& revisions,
+      const wikiopencite::proto::Page& page) override;
+
+ private:
+  std::vector<ParsedPage> pages_;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_COLLECTING_DUMP_PARSER_H_
@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dump_element.h"
+
+#include <string_view>
+
+#include "citescoop/dump_elements.h"
+
+namespace wikiopencite::citescoop {
+
+DumpElement LookupDumpElement(std::string_view name) {
+  const auto* result = DumpElements::lookup(name.data(), name.size());
+  if (result == nullptr) {
+    return DumpElement::kOther;
+  }
+
+  return static_cast<DumpElement>(result->element);
+}
+
+}  // namespace wikiopencite::citescoop
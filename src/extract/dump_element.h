@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_DUMP_ELEMENT_H_
+#define SRC_EXTRACT_DUMP_ELEMENT_H_
+
+#include <string_view>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Elements of the MediaWiki export schema used by the dump
+/// parser.
+///
+/// The values must match those in @c dump_elements.gperf.
+enum class DumpElement {
+  kOther = 0,
+  kPage = 1,
+  kRevision = 2,
+  kContributor = 3,
+  kTitle = 4,
+  kId = 5,
+  kParentId = 6,
+  kUsername = 7,
+  kText = 8,
+  kTimestamp = 9,
+  kSha1 = 10,
+  kNamespace = 11,
+  kRedirect = 12,
+};
+
+/// @brief Look up an element by its name.
+/// @param name Element name, as it appears in the dump.
+/// @return The element, or DumpElement::kOther if the parser has no use
+/// for it.
+DumpElement LookupDumpElement(std::string_view name);
+
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_DUMP_ELEMENT_H_
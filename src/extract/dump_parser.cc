@@ -4,29 +4,78 @@
 #include "dump_parser.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <future>
 #include <istream>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "boost/unordered/unordered_flat_map.hpp"
 #include "citescoop/extract.h"
 #include "citescoop/parser.h"
 #include "citescoop/proto/citation.pb.h"
 #include "citescoop/proto/page.pb.h"
 #include "citescoop/proto/revision.pb.h"
 #include "citescoop/proto/revision_citations.pb.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/timestamp.pb.h"
 #include "google/protobuf/util/time_util.h"
 #include "libxml++/ustring.h"
+#include "libxml/parser.h"
+
+#include "dump_element.h"
+#include "dump_tokenizer.h"
+#include "parser/citation_fingerprint.h"
+#include "revision_buffer.h"
+#include "worker_pool.h"
 
 namespace wikiopencite::citescoop {
 namespace proto = wikiopencite::proto;
+using google::protobuf::Arena;
+
+namespace {
+// Size of the arena block kept between pages. Large enough for the
+// messages of a page with a few hundred revisions.
+const std::size_t kArenaBlockSize = 1 << 20;
+
+// Number of revisions of a large page to keep in flight per thread of
+// the revision pool. Each holds its text until it has been parsed.
+const std::size_t kPendingRevisionsPerThread = 2;
+}  // namespace
+
+std::shared_ptr<WorkerPool> MakeRevisionPool(const ExtractorOptions& options) {
+  if (options.revision_threads == 1) {
+    return nullptr;
+  }
+  return std::make_shared<WorkerPool>(options.revision_threads);
+}
 
-DumpParser::DumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser)
-    : parser_(std::move(parser)) {}
+DumpParser::DumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                       ExtractorOptions options,
+                       std::shared_ptr<WorkerPool> revision_pool)
+    : parser_(std::move(parser)),
+      options_(options),
+      tokenizer_(this),
+      arena_block_(kArenaBlockSize),
+      arena_(MakeArenaOptions(&arena_block_)),
+      buffered_revisions_(options.page_memory_budget),
+      revision_pool_(std::move(revision_pool)) {}
+
+google::protobuf::ArenaOptions DumpParser::MakeArenaOptions(
+    std::vector<char>* initial_block) {
+  auto options = google::protobuf::ArenaOptions();
+  options.initial_block = initial_block->data();
+  options.initial_block_size = initial_block->size();
+  return options;
+}
 
 std::pair<std::unique_ptr<std::vector<proto::Page>>,
           // NOLINTNEXTLINE(whitespace/indent_namespace)
@@ -39,42 +88,129 @@ DumpParser::ParseXML(std::istream& stream) {
 }
 
 void DumpParser::on_start_element(const xmlpp::ustring& name,
-                                  const AttributeList&) {
-  text_buf_ = "";
-  if (name == "page") {
-    in_page_ = true;
-  } else if (name == "revision") {
-    in_revision_ = true;
-  } else if (name == "contributor") {
-    in_contributor_ = true;
-  } else if ((in_page_ && name == "title") || (in_page_ && name == "id") ||
-             (in_revision_ && name == "id") ||
-             (in_revision_ && name == "parentid") ||
-             (in_revision_ && name == "username") ||
-             (in_revision_ && name == "text") ||
-             (in_revision_ && name == "timestamp")) {
-    should_store_ = true;
+                                  const AttributeList& properties) {
+  auto element = LookupDumpElement(name);
+  auto text_sha1 = std::string_view();
+  if (element == DumpElement::kText) {
+    for (const auto& property : properties) {
+      if (property.name == "sha1") {
+        text_sha1 = property.value;
+      }
+    }
   }
+
+  StartElement(element, text_sha1);
 }
 
 void DumpParser::on_end_element(const xmlpp::ustring& name) {
-  if (name == "page") {
+  OnEndElement(LookupDumpElement(name));
+}
+
+void DumpParser::on_characters(const xmlpp::ustring& characters) {
+  OnCharacters(characters);
+}
+
+void DumpParser::OnStartElement(DumpElement element,
+                                std::string_view attributes) {
+  auto text_sha1 = std::string_view();
+  if (element == DumpElement::kText) {
+    text_sha1 = DumpTokenizer::FindAttribute(attributes, "sha1").value_or("");
+  }
+
+  StartElement(element, text_sha1);
+}
+
+void DumpParser::StartElement(DumpElement element,
+                              std::string_view text_sha1) {
+  text_buf_.clear();
+
+  // Nothing in the revisions of a page that has been filtered out is
+  // needed, so they are skipped over.
+  if (skip_page_ && in_revision_) {
+    return;
+  }
+
+  switch (element) {
+    case DumpElement::kPage:
+      OnStartPage();
+      break;
+    case DumpElement::kRevision:
+      // The page header is complete once the first revision starts.
+      if (!page_checked_) {
+        CheckPageFilter();
+      }
+      in_revision_ = true;
+      break;
+    case DumpElement::kContributor:
+      in_contributor_ = true;
+      break;
+    case DumpElement::kTitle:
+      should_store_ = in_page_;
+      break;
+    case DumpElement::kId:
+      should_store_ = in_page_ || in_revision_;
+      break;
+    case DumpElement::kNamespace:
+      should_store_ = in_page_ && !in_revision_;
+      break;
+    case DumpElement::kRedirect:
+      if (in_page_ && !in_revision_) {
+        page_redirect_ = true;
+      }
+      break;
+    case DumpElement::kText:
+      if (in_revision_ && !skip_revision_) {
+        OnStartText(text_sha1);
+      }
+      break;
+    case DumpElement::kParentId:
+    case DumpElement::kUsername:
+    case DumpElement::kTimestamp:
+    case DumpElement::kSha1:
+      should_store_ = in_revision_;
+      break;
+    case DumpElement::kOther:
+      break;
+  }
+}
+
+void DumpParser::OnEndElement(DumpElement element) {
+  if (element == DumpElement::kPage) {
     OnEndPage();
-  } else if (name == "revision") {
+  } else if (element == DumpElement::kRevision) {
     OnEndRevision();
-  } else if (name == "contributor") {
+  } else if (element == DumpElement::kContributor) {
     in_contributor_ = false;
-  } else {
-    OnEndField(name);
+  } else if (!skip_page_) {
+    OnEndField(element);
   }
 
   if (should_store_)
     should_store_ = false;
 }
 
-void DumpParser::on_characters(const xmlpp::ustring& characters) {
-  if (should_store_)
-    text_buf_ += characters;
+void DumpParser::OnCharacters(std::string_view characters) {
+  if (!should_store_) {
+    return;
+  }
+
+  // The tokenizer's text is parsed from its read buffer if the whole of
+  // it arrives at once.
+  if (collecting_text_ && options_.reader == DumpReader::kTokenizer) {
+    if (!text_retained_ && text_buf_.empty()) {
+      text_offset_ = tokenizer_.OffsetOf(characters);
+      text_length_ = characters.size();
+      text_retained_ = true;
+      tokenizer_.Retain(text_offset_);
+      return;
+    }
+    if (text_retained_) {
+      text_buf_.assign(tokenizer_.Retained(text_offset_, text_length_));
+      ReleaseText();
+    }
+  }
+
+  text_buf_ += characters;
 }
 
 void DumpParser::on_warning(const xmlpp::ustring& text) {
@@ -89,106 +225,259 @@ void DumpParser::on_fatal_error(const xmlpp::ustring& text) {
   throw DumpParseException(text);
 }
 
-void DumpParser::Store(const std::map<uint64_t, proto::Revision>& revisions,
-                       const proto::Page& page) {
+void DumpParser::Store(
+    const std::map<uint64_t, const proto::Revision*>& revisions,
+    const proto::Page& page) {
   stored_pages_->push_back(page);
-  stored_revisions_->insert(revisions.begin(), revisions.end());
+  for (const auto& [revision_id, revision] : revisions) {
+    stored_revisions_->emplace(revision_id, *revision);
+  }
 }
 
 void DumpParser::StartParser(std::istream& stream) {
   InitializeParser();
+  if (options_.reader == DumpReader::kTokenizer) {
+    tokenizer_.Parse(stream);
+    return;
+  }
+
   set_substitute_entities(true);
   parse_stream(stream);
 }
 
+uint64_t DumpParser::InputOffset() const {
+  if (options_.reader == DumpReader::kTokenizer) {
+    return tokenizer_.offset();
+  }
+
+  return static_cast<uint64_t>(xmlByteConsumed(context_));
+}
+
 void DumpParser::InitializeParser() {
-  revisions_to_store_ = std::map<uint64_t, proto::Revision>();
-  current_page_ = proto::Page();
-  current_revision_ = proto::Revision();
-  current_page_revisions_ = std::map<uint64_t, proto::Revision>();
-  citations_by_revision_ = std::vector<proto::RevisionCitations>();
+  ResetArena();
   ResetState();
 }
 
-void DumpParser::CheckExistingCitations(
-    proto::RevisionCitations* revision,
-    std::map<std::string, proto::Citation>* discovered_citations,
-    std::map<uint64_t, int>* ref_count) {
+void DumpParser::ResetArena() {
+  // Drop every pointer into the arena before resetting it.
+  revisions_to_store_.clear();
+  referenced_revisions_.clear();
+  free_revisions_.clear();
+  buffered_revisions_.Clear();
+  tracked_revisions_.clear();
+  tracked_history_.clear();
+  discovered_citations_.clear();
+  citations_by_fingerprint_.clear();
+  revisions_ref_count_.clear();
+  keys_by_sha1_.clear();
+  current_keys_.reset();
+  held_revision_.reset();
+  pending_revisions_.clear();
+  pending_parses_.clear();
+  parsed_citations_ = nullptr;
+  page_text_size_ = 0;
+  parallel_page_ = false;
+  in_order_ = true;
+  arena_.Reset();
+
+  current_page_ = Arena::CreateMessage<proto::Page>(&arena_);
+  current_revision_ = Arena::CreateMessage<proto::Revision>(&arena_);
+}
 
-  for (auto& [key, citation] : *discovered_citations) {
-    if (revision->citations().contains(key)) {
-      revision->mutable_citations()->erase(key);
+const proto::Revision* DumpParser::ReferenceRevision(
+    const proto::Revision& revision) {
+  auto [referenced, inserted] =
+      referenced_revisions_.try_emplace(revision.revision_id(), nullptr);
+  if (inserted) {
+    auto* copy = Arena::CreateMessage<proto::Revision>(&arena_);
+    copy->CopyFrom(revision);
+    referenced->second = copy;
+  }
+  return referenced->second;
+}
+
+proto::Revision* DumpParser::NewRevision() {
+  if (free_revisions_.empty()) {
+    return Arena::CreateMessage<proto::Revision>(&arena_);
+  }
+
+  auto* revision = free_revisions_.back();
+  free_revisions_.pop_back();
+  return revision;
+}
 
+void DumpParser::RecycleRevision(proto::Revision* revision) {
+  revision->Clear();
+  free_revisions_.push_back(revision);
+}
+
+void DumpParser::CheckExistingCitations(const proto::Revision& revision) {
+  auto revision_id = revision.revision_id();
+  for (const auto& [fingerprint, citation] : discovered_citations_) {
+    if (revision_fingerprints_.contains(fingerprint)) {
       // Just make sure that we don't mark it as removed. NOTE: This
       // is a slight technical limitation, if a citation is removed
       // from a article and then re-added, we won't detect that is was
       // re-added and will just show that it continues to be there.
-      if (citation.has_revision_removed()) {
-        (*ref_count)[citation.revision_removed()]--;
-        if (ref_count->at(citation.revision_removed()) <= 0) {
-          revisions_to_store_.erase(citation.revision_removed());
+      if (citation->has_revision_removed()) {
+        revisions_ref_count_[citation->revision_removed()]--;
+        if (revisions_ref_count_.at(citation->revision_removed()) <= 0) {
+          revisions_to_store_.erase(citation->revision_removed());
         }
 
-        citation.clear_revision_removed();
+        citation->clear_revision_removed();
       }
     } else {
-      if (!citation.has_revision_removed()) {
-        auto revision_id = revision->revision().revision_id();
-        citation.set_revision_removed(revision_id);
-        revisions_to_store_.insert(
-            {revision_id, current_page_revisions_.at(revision_id)});
-        (*ref_count)[revision_id]++;
+      if (!citation->has_revision_removed()) {
+        citation->set_revision_removed(revision_id);
+        revisions_to_store_.insert({revision_id, ReferenceRevision(revision)});
+        revisions_ref_count_[revision_id]++;
       }
     }
   }
 }
 
-void DumpParser::AddNewCitations(
-    wikiopencite::proto::RevisionCitations* citations,
-    std::map<std::string, wikiopencite::proto::Citation>* discovered_citations,
-    std::map<uint64_t, int>* ref_count) {
-  for (const auto& [key, extracted_citation] : citations->citations()) {
-    if (!discovered_citations->contains(key)) {
-      auto citation = proto::Citation();
-      auto revision_id = citations->revision().revision_id();
-      citation.set_revision_added(revision_id);
+void DumpParser::AddNewCitations(const proto::Revision& revision,
+                                 const CitationKeys& keys,
+                                 const proto::RevisionCitations& citations) {
+  auto revision_id = revision.revision_id();
+  for (auto fingerprint : keys) {
+    if (!citations_by_fingerprint_.contains(fingerprint)) {
+      auto* citation = Arena::CreateMessage<proto::Citation>(&arena_);
+      citation->set_revision_added(revision_id);
+
+      revisions_to_store_.insert({revision_id, ReferenceRevision(revision)});
+      revisions_ref_count_[revision_id]++;
+
+      citation->mutable_citation()->CopyFrom(
+          citations.citations().at(FingerprintKey(fingerprint)));
+      discovered_citations_.push_back({fingerprint, citation});
+      citations_by_fingerprint_.emplace(fingerprint, citation);
+    }
+  }
+}
 
-      revisions_to_store_.insert(
-          {revision_id, current_page_revisions_.at(revision_id)});
-      (*ref_count)[revision_id]++;
+void DumpParser::UpdateCitations(const proto::Revision& revision,
+                                 const CitationKeys& keys,
+                                 const proto::RevisionCitations& citations) {
+  revision_fingerprints_.clear();
+  revision_fingerprints_.insert(keys.begin(), keys.end());
 
-      citation.mutable_citation()->CopyFrom(extracted_citation);
-      discovered_citations->insert({key, citation});
+  CheckExistingCitations(revision);
+  AddNewCitations(revision, keys, citations);
+}
+
+void DumpParser::MakePageCitationList() {
+  if (!in_order_) {
+    RescanPageCitations();
+  }
+
+  // Hand the complete set of citations to the page. They are on the
+  // same arena, so this doesn't copy them.
+  for (const auto& [fingerprint, citation] : discovered_citations_) {
+    current_page_->mutable_citations()->AddAllocated(citation);
+  }
+}
+
+void DumpParser::RescanPageCitations() {
+  // A tracked revision can only add a citation if it is the first of
+  // the tracked revisions to contain it, so the citations they
+  // discovered are the ones they would add again.
+  auto tracked_citations = std::move(citations_by_fingerprint_);
+  citations_by_fingerprint_.clear();
+  discovered_citations_.clear();
+  revisions_ref_count_.clear();
+  revisions_to_store_.clear();
+  SeedCitations();
+
+  // Merge the tracked revisions, which are already in order, with the
+  // sorted buffered revisions. Tracked revisions came first in the
+  // dump, so they go first on a tie.
+  buffered_revisions_.Sort();
+  auto tracked = tracked_revisions_.begin();
+  auto read_tracked = [this, &tracked]() {
+    if (tracked != tracked_revisions_.end() &&
+        !rescan_revision_.ParseFromArray(tracked_history_.data() +
+                                             tracked->offset,
+                                         static_cast<int>(tracked->size))) {
+      throw std::runtime_error("Could not read back tracked revision");
+    }
+  };
+
+  read_tracked();
+  auto* buffered = buffered_revisions_.Next();
+  auto expanded_citations = proto::RevisionCitations();
+  while (tracked != tracked_revisions_.end() || buffered != nullptr) {
+    if (tracked != tracked_revisions_.end() &&
+        (buffered == nullptr ||
+         !IsBefore(buffered->revision().timestamp(),
+                   rescan_revision_.timestamp()))) {
+      ExpandCitationKeys(*tracked->keys, tracked_citations,
+                         &expanded_citations);
+      UpdateCitations(rescan_revision_, *tracked->keys, expanded_citations);
+      ++tracked;
+      read_tracked();
+    } else {
+      UpdateCitations(buffered->revision(), GetCitationKeys(*buffered),
+                      *buffered);
+      buffered = buffered_revisions_.Next();
     }
   }
 }
 
-void DumpParser::MakePageCitationList() {
-  // Sort revisions by date
-  std::ranges::sort(citations_by_revision_,
-                    [](const proto::RevisionCitations& first,
-                       const proto::RevisionCitations& second) {
-                      return first.revision().timestamp().seconds() ==
-                                     second.revision().timestamp().seconds()
-                                 ? first.revision().timestamp().nanos() <
-                                       second.revision().timestamp().nanos()
-                                 : first.revision().timestamp().seconds() <
-                                       second.revision().timestamp().seconds();
-                    });
+void DumpParser::SeedCitations() {
+  if (previous_page_ == nullptr) {
+    return;
+  }
+
+  auto reference = [this](uint64_t revision_id) {
+    auto revision = previous_page_->revisions.find(revision_id);
+    if (revision != previous_page_->revisions.end()) {
+      revisions_to_store_.insert(
+          {revision_id, ReferenceRevision(revision->second)});
+    }
+    revisions_ref_count_[revision_id]++;
+  };
 
-  auto discovered_citations = std::map<std::string, proto::Citation>();
-  auto revisions_ref_count = std::map<uint64_t, int>();
+  for (const auto& previous : previous_page_->page.citations()) {
+    auto fingerprint = FingerprintCitation(previous.citation());
+    if (citations_by_fingerprint_.contains(fingerprint)) {
+      continue;
+    }
+
+    auto* citation = Arena::CreateMessage<proto::Citation>(&arena_);
+    citation->CopyFrom(previous);
+    discovered_citations_.push_back({fingerprint, citation});
+    citations_by_fingerprint_.emplace(fingerprint, citation);
+
+    reference(citation->revision_added());
+    if (citation->has_revision_removed()) {
+      reference(citation->revision_removed());
+    }
+  }
+}
 
-  for (auto& citations : citations_by_revision_) {
-    CheckExistingCitations(&citations, &discovered_citations,
-                           &revisions_ref_count);
-    AddNewCitations(&citations, &discovered_citations, &revisions_ref_count);
+DumpParser::CitationKeys DumpParser::GetCitationKeys(
+    const proto::RevisionCitations& citations) {
+  auto keys = CitationKeys();
+  keys.reserve(static_cast<std::size_t>(citations.citations_size()));
+  for (const auto& [key, citation] : citations.citations()) {
+    keys.push_back(KeyFingerprint(key));
   }
+  std::ranges::sort(keys);
+  return keys;
+}
 
-  // Copy the complete set of citations into the page.
-  for (const auto& [key, citation] : discovered_citations) {
-    auto* added_citation = current_page_.add_citations();
-    added_citation->CopyFrom(citation);
+void DumpParser::ExpandCitationKeys(
+    const CitationKeys& keys,
+    const boost::unordered_flat_map<uint64_t, proto::Citation*>&
+        discovered_citations,
+    proto::RevisionCitations* citations) {
+  citations->Clear();
+  auto* expanded = citations->mutable_citations();
+  for (auto fingerprint : keys) {
+    (*expanded)[FingerprintKey(fingerprint)] =
+        discovered_citations.at(fingerprint)->citation();
   }
 }
 
@@ -197,52 +486,418 @@ void DumpParser::ResetState() {
   in_revision_ = false;
   in_contributor_ = false;
   should_store_ = false;
+  has_revision_text_ = false;
+  revision_parsed_ = false;
+  revision_text_.clear();
+  revision_sha1_.clear();
+  collecting_text_ = false;
+  text_retained_ = false;
+  text_offset_ = 0;
+  text_length_ = 0;
+  skip_revision_ = false;
+  page_namespace_ = 0;
+  page_redirect_ = false;
+  page_checked_ = false;
+  skip_page_ = false;
 }
 
-void DumpParser::OnEndField(const xmlpp::ustring& field_name) {
-  if (in_page_ && field_name == "title") {
-    current_page_.set_title(text_buf_);
+void DumpParser::OnEndField(DumpElement field) {
+  if (in_page_ && field == DumpElement::kTitle) {
+    current_page_->set_title(text_buf_);
   } else if (in_page_ && !in_revision_ && !in_contributor_ &&
-             field_name == "id") {
-    current_page_.set_page_id(static_cast<uint64_t>(std::stol(text_buf_)));
-  } else if (in_revision_ && !in_contributor_ && field_name == "id") {
-    current_revision_.set_revision_id(
+             field == DumpElement::kId) {
+    current_page_->set_page_id(static_cast<uint64_t>(std::stol(text_buf_)));
+  } else if (in_page_ && !in_revision_ && field == DumpElement::kNamespace) {
+    page_namespace_ = std::stoi(text_buf_);
+  } else if (in_revision_ && !in_contributor_ && field == DumpElement::kId) {
+    current_revision_->set_revision_id(
         static_cast<uint64_t>(std::stol(text_buf_)));
-  } else if (in_revision_ && field_name == "parentid") {
-    current_revision_.set_parent_id(
+  } else if (in_revision_ && field == DumpElement::kParentId) {
+    current_revision_->set_parent_id(
         static_cast<uint64_t>(std::stol(text_buf_)));
-  } else if (in_revision_ && field_name == "username") {
-    current_revision_.set_user(text_buf_);
-  } else if (in_revision_ && field_name == "text") {
-    current_citations_ = parser_->Parse(text_buf_);
-  } else if (in_revision_ && field_name == "timestamp") {
+  } else if (in_revision_ && field == DumpElement::kUsername) {
+    current_revision_->set_user(text_buf_);
+  } else if (in_revision_ && field == DumpElement::kText) {
+    collecting_text_ = false;
+    if (!revision_parsed_) {
+      revision_text_.swap(text_buf_);
+      page_text_size_ += RevisionText().size();
+      has_revision_text_ = true;
+    }
+  } else if (in_revision_ && field == DumpElement::kSha1) {
+    if (revision_sha1_.empty()) {
+      revision_sha1_ = text_buf_;
+    }
+  } else if (in_revision_ && field == DumpElement::kTimestamp) {
     auto timestamp = google::protobuf::Timestamp();
     google::protobuf::util::TimeUtil::FromString(text_buf_, &timestamp);
-    current_revision_.mutable_timestamp()->CopyFrom(timestamp);
+    current_revision_->mutable_timestamp()->CopyFrom(timestamp);
+    skip_revision_ = !InRevisionWindow(timestamp);
+    if (!skip_revision_) {
+      CheckRevisionOrder();
+    }
+  }
+}
+
+void DumpParser::OnStartText(std::string_view text_sha1) {
+  revision_sha1_ = text_sha1;
+  if (in_order_ && !revision_sha1_.empty()) {
+    auto cached = keys_by_sha1_.find(revision_sha1_);
+    if (cached != keys_by_sha1_.end()) {
+      current_keys_ = cached->second;
+      revision_parsed_ = true;
+      return;
+    }
+  }
+
+  should_store_ = true;
+  collecting_text_ = true;
+}
+
+std::shared_ptr<const DumpParser::CitationKeys> DumpParser::ParseRevisionText(
+    proto::RevisionCitations* citations) {
+  if (current_keys_ == nullptr && in_order_ && !revision_sha1_.empty()) {
+    auto cached = keys_by_sha1_.find(revision_sha1_);
+    if (cached != keys_by_sha1_.end()) {
+      current_keys_ = cached->second;
+    }
+  }
+
+  if (current_keys_ != nullptr) {
+    citations->Clear();
+    return current_keys_;
+  }
+
+  if (parsed_citations_ != nullptr) {
+    *citations = *parsed_citations_;
+  } else if (has_revision_text_) {
+    *citations = parser_->Parse(RevisionText());
+  } else {
+    citations->Clear();
+  }
+  return nullptr;
+}
+
+void DumpParser::CheckRevisionOrder() {
+  if (in_order_ && !tracked_revisions_.empty() &&
+      IsBefore(current_revision_->timestamp(), last_tracked_timestamp_)) {
+    in_order_ = false;
+  }
+}
+
+void DumpParser::TrackRevision() {
+  // The citations of reused text have all been discovered already, so
+  // only their fingerprints are needed.
+  auto keys = ParseRevisionText(&current_citations_);
+  if (keys == nullptr) {
+    auto parsed_keys = GetCitationKeys(current_citations_);
+
+    // Most edits don't touch the citations, so share the previous
+    // revision's fingerprints where they are the same.
+    if (!tracked_revisions_.empty() &&
+        *tracked_revisions_.back().keys == parsed_keys) {
+      keys = tracked_revisions_.back().keys;
+    } else {
+      keys = std::make_shared<const CitationKeys>(std::move(parsed_keys));
+    }
+
+    if (!revision_sha1_.empty()) {
+      keys_by_sha1_.emplace(revision_sha1_, keys);
+    }
+  }
+
+  UpdateCitations(*current_revision_, *keys, current_citations_);
+
+  auto offset = tracked_history_.size();
+  current_revision_->AppendToString(&tracked_history_);
+  tracked_revisions_.push_back(
+      {.offset = offset,
+       .size = static_cast<uint32_t>(tracked_history_.size() - offset),
+       .keys = std::move(keys)});
+  last_tracked_timestamp_.CopyFrom(current_revision_->timestamp());
+}
+
+void DumpParser::BufferRevision() {
+  auto keys = ParseRevisionText(&current_citations_);
+  if (keys != nullptr) {
+    ExpandCitationKeys(*keys, citations_by_fingerprint_, &current_citations_);
+  }
+  current_citations_.mutable_revision()->CopyFrom(*current_revision_);
+  buffered_revisions_.Add(current_citations_);
+}
+
+void DumpParser::OnStartPage() {
+  in_page_ = true;
+  page_namespace_ = 0;
+  page_redirect_ = false;
+  page_checked_ = false;
+  skip_page_ = false;
+  SeedCitations();
+}
+
+void DumpParser::CheckPageFilter() {
+  page_checked_ = true;
+
+  const auto& filter = options_.page_filter;
+  if (!filter.namespaces.empty() &&
+      std::ranges::find(filter.namespaces, page_namespace_) ==
+          filter.namespaces.end()) {
+    skip_page_ = true;
+  } else if (filter.skip_redirects && page_redirect_) {
+    skip_page_ = true;
+  } else if (filter.page_ids != nullptr || filter.titles != nullptr) {
+    skip_page_ =
+        !(filter.page_ids != nullptr &&
+          filter.page_ids->contains(current_page_->page_id())) &&
+        !(filter.titles != nullptr &&
+          filter.titles->contains(current_page_->title()));
   }
 }
 
 void DumpParser::OnEndPage() {
   in_page_ = false;
-  MakePageCitationList();
+  if (!page_checked_) {
+    CheckPageFilter();
+  }
 
-  Store(revisions_to_store_, current_page_);
+  if (!skip_page_) {
+    if (held_revision_.has_value()) {
+      ProcessHeldRevision();
+    }
+    while (!pending_revisions_.empty()) {
+      ResolvePendingRevision();
+    }
+    MakePageCitationList();
+    Store(revisions_to_store_, *current_page_);
+  }
 
   // Clear everything up
-  current_page_.Clear();
-  current_page_revisions_.clear();
-  citations_by_revision_.clear();
-  revisions_to_store_.clear();
+  ResetArena();
 }
 
 void DumpParser::OnEndRevision() {
   in_revision_ = false;
-  current_citations_.mutable_revision()->CopyFrom(current_revision_);
-  citations_by_revision_.push_back(current_citations_);
-  current_page_revisions_.insert(
-      {current_revision_.revision_id(), current_revision_});
+  if (skip_page_) {
+    return;
+  }
+
+  if (skip_revision_) {
+    // Nothing references a skipped revision, so its message is reused.
+    skip_revision_ = false;
+    current_revision_->Clear();
+    ClearRevisionText();
+    return;
+  }
 
-  current_revision_.Clear();
+  if (options_.revision_filter.bucket == RevisionBucket::kNone) {
+    ProcessRevision();
+  } else {
+    HoldRevision();
+  }
+
+  ClearRevisionText();
+  current_revision_ = NewRevision();
+}
+
+void DumpParser::ProcessRevision() {
+  if (!parallel_page_ && options_.revision_threads != 1 &&
+      page_text_size_ >= options_.parallel_revision_text_size) {
+    parallel_page_ = true;
+    if (revision_pool_ == nullptr) {
+      revision_pool_ = MakeRevisionPool(options_);
+    }
+  }
+
+  // Once any revision of the page is pending, the rest have to queue
+  // behind it to be tracked in order.
+  if (parallel_page_) {
+    SubmitRevision();
+  } else {
+    TrackOrBufferRevision();
+  }
+}
+
+void DumpParser::TrackOrBufferRevision() {
+  CheckRevisionOrder();
+  if (in_order_) {
+    TrackRevision();
+  } else {
+    BufferRevision();
+  }
+
+  // Citations refer to a copy of the revision, so its message is free
+  // to be reused.
+  RecycleRevision(current_revision_);
+}
+
+void DumpParser::SubmitRevision() {
+  OwnRevisionText();
+  auto pending = PendingRevision{.revision = current_revision_,
+                                 .sha1 = revision_sha1_,
+                                 .parsed = revision_parsed_,
+                                 .keys = current_keys_,
+                                 .citations = {},
+                                 .parses_sha1 = false};
+
+  if (pending.keys == nullptr && in_order_ && !revision_sha1_.empty()) {
+    auto cached = keys_by_sha1_.find(revision_sha1_);
+    if (cached != keys_by_sha1_.end()) {
+      pending.keys = cached->second;
+    }
+  }
+
+  if (pending.keys == nullptr && has_revision_text_) {
+    auto in_flight = revision_sha1_.empty()
+                         ? pending_parses_.end()
+                         : pending_parses_.find(revision_sha1_);
+    if (in_flight != pending_parses_.end()) {
+      pending.citations = in_flight->second;
+    } else {
+      pending.citations =
+          revision_pool_
+              ->Submit([parser = parser_, text = std::move(revision_text_)]() {
+                return parser->Parse(text);
+              })
+              .share();
+      if (!revision_sha1_.empty()) {
+        pending_parses_.emplace(revision_sha1_, pending.citations);
+        pending.parses_sha1 = true;
+      }
+    }
+  }
+
+  pending_revisions_.push_back(std::move(pending));
+  if (pending_revisions_.size() >
+      kPendingRevisionsPerThread * revision_pool_->size()) {
+    ResolvePendingRevision();
+  }
+}
+
+void DumpParser::ResolvePendingRevision() {
+  auto pending = std::move(pending_revisions_.front());
+  pending_revisions_.pop_front();
+  if (pending.parses_sha1) {
+    pending_parses_.erase(pending.sha1);
+  }
+
+  if (pending.citations.valid()) {
+    WaitForTask(revision_pool_.get(), pending.citations);
+    parsed_citations_ = &pending.citations.get();
+  }
+
+  // The pending revision's text has been handed to the pool, so it has
+  // none of its own.
+  auto has_text = false;
+  auto swap_pending = [this, &pending, &has_text]() {
+    std::swap(current_revision_, pending.revision);
+    revision_sha1_.swap(pending.sha1);
+    std::swap(has_revision_text_, has_text);
+    std::swap(revision_parsed_, pending.parsed);
+    current_keys_.swap(pending.keys);
+  };
+
+  swap_pending();
+  TrackOrBufferRevision();
+  swap_pending();
+  parsed_citations_ = nullptr;
+}
+
+void DumpParser::HoldRevision() {
+  OwnRevisionText();
+  auto bucket = RevisionBucketOf(current_revision_->timestamp());
+  if (held_revision_.has_value()) {
+    if (held_revision_->bucket != bucket) {
+      ProcessHeldRevision();
+    } else {
+      RecycleRevision(held_revision_->revision);
+    }
+  }
+
+  // Any revision held from the same bucket is superseded, so is
+  // dropped without its text ever being parsed.
+  held_revision_ = HeldRevision{.revision = current_revision_,
+                                .text = std::move(revision_text_),
+                                .sha1 = std::move(revision_sha1_),
+                                .has_text = has_revision_text_,
+                                .parsed = revision_parsed_,
+                                .keys = std::move(current_keys_),
+                                .bucket = bucket};
+}
+
+void DumpParser::ProcessHeldRevision() {
+  auto& held = *held_revision_;
+  auto swap_held = [this, &held]() {
+    std::swap(current_revision_, held.revision);
+    revision_text_.swap(held.text);
+    revision_sha1_.swap(held.sha1);
+    std::swap(has_revision_text_, held.has_text);
+    std::swap(revision_parsed_, held.parsed);
+    current_keys_.swap(held.keys);
+  };
+
+  swap_held();
+  ProcessRevision();
+  swap_held();
+  held_revision_.reset();
+}
+
+void DumpParser::ClearRevisionText() {
+  ReleaseText();
+  revision_text_.clear();
+  revision_sha1_.clear();
+  has_revision_text_ = false;
+  revision_parsed_ = false;
+  current_keys_.reset();
+}
+
+std::string_view DumpParser::RevisionText() const {
+  if (text_retained_) {
+    return tokenizer_.Retained(text_offset_, text_length_);
+  }
+  return revision_text_;
+}
+
+void DumpParser::OwnRevisionText() {
+  if (text_retained_) {
+    revision_text_.assign(RevisionText());
+    ReleaseText();
+  }
+}
+
+void DumpParser::ReleaseText() {
+  if (text_retained_) {
+    tokenizer_.Release();
+    text_retained_ = false;
+  }
+}
+
+bool DumpParser::InRevisionWindow(
+    const google::protobuf::Timestamp& timestamp) const {
+  const auto& filter = options_.revision_filter;
+  auto seconds = timestamp.seconds();
+  return (!filter.from.has_value() ||
+          seconds >= filter.from->time_since_epoch().count()) &&
+         (!filter.to.has_value() ||
+          seconds <= filter.to->time_since_epoch().count());
+}
+
+int64_t DumpParser::RevisionBucketOf(
+    const google::protobuf::Timestamp& timestamp) const {
+  auto day = std::chrono::floor<std::chrono::days>(
+      std::chrono::sys_seconds(std::chrono::seconds(timestamp.seconds())));
+  auto date = std::chrono::year_month_day(day);
+  switch (options_.revision_filter.bucket) {
+    case RevisionBucket::kDay:
+      return day.time_since_epoch().count();
+    case RevisionBucket::kMonth:
+      return static_cast<int64_t>(static_cast<int>(date.year())) * 12 +
+             static_cast<unsigned int>(date.month());
+    case RevisionBucket::kYear:
+      return static_cast<int>(date.year());
+    case RevisionBucket::kNone:
+      break;
+  }
+  return 0;
 }
 
 }  // namespace wikiopencite::citescoop
@@ -4,31 +4,63 @@
 #ifndef SRC_EXTRACT_DUMP_PARSER_H_
 #define SRC_EXTRACT_DUMP_PARSER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <istream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "boost/unordered/unordered_flat_map.hpp"
+#include "boost/unordered/unordered_flat_set.hpp"
+#include "citescoop/extract.h"
 #include "citescoop/parser.h"
 #include "citescoop/proto/citation.pb.h"
 #include "citescoop/proto/page.pb.h"
 #include "citescoop/proto/revision.pb.h"
 #include "citescoop/proto/revision_citations.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/timestamp.pb.h"
 #include "libxml++/parsers/saxparser.h"
 #include "libxml++/ustring.h"
 
+#include "dump_element.h"
+#include "dump_tokenizer.h"
+#include "revision_buffer.h"
+#include "worker_pool.h"
+
 namespace wikiopencite::citescoop {
 
+/// @brief Start the pool to parse the revisions of large pages on.
+/// @param options Extractor options, giving the number of threads.
+/// @return The pool, or null if revisions are only parsed on the
+/// parsing thread.
+std::shared_ptr<WorkerPool> MakeRevisionPool(const ExtractorOptions& options);
+
 /// @brief MediaWiki XML dump parser.
-class DumpParser : public xmlpp::SaxParser {
+///
+/// The dump is read with either libxml++'s SAX parser or the
+/// specialised DumpTokenizer, as selected by ExtractorOptions::reader.
+/// Both feed the same element handlers.
+class DumpParser : public xmlpp::SaxParser, private DumpTokenizer::Handler {
  public:
-  /// @brief Construct a new dumps parser.
+  /// @brief Construct a new dumps parser with extractor options.
   /// @param parser The citation parser to use.
-  explicit DumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser);
+  /// @param options Extractor options to configure the parser with.
+  /// @param revision_pool Pool to parse the revisions of large pages
+  /// on, shared with other parsers. If null, the parser starts its own
+  /// once a page needs it.
+  DumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+             ExtractorOptions options,
+             std::shared_ptr<WorkerPool> revision_pool = nullptr);
 
   /// @brief Parse the dump XML.
   /// @param stream An input stream of plain XML. NOTE: if you are
@@ -53,19 +85,44 @@ class DumpParser : public xmlpp::SaxParser {
 
   /// @brief Store a page and it's referenced revisions.
   /// Once the parser calls this method for a given page, it has
-  /// finished with the page so you may do with it as you wish.
+  /// finished with the page. The page and revisions are allocated on
+  /// the parser's per-page arena, so must be copied if they are needed
+  /// after this returns.
   /// @param revisions Revisions to store.
   /// @param page Page to store.
   virtual void Store(
-      const std::map<uint64_t, wikiopencite::proto::Revision>& revisions,
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>&
+          revisions,
       const wikiopencite::proto::Page& page);
 
   /// @brief Start parsing the input stream.
   /// @param stream Input stream to parse.
   void StartParser(std::istream& stream);
 
+  /// @brief Get the offset in the input stream of the markup being
+  /// handled. Only valid while parsing.
+  /// @return Number of bytes of the input consumed, up to the end of the
+  /// current tag.
+  uint64_t InputOffset() const;
+
+  /// @brief Set an earlier extraction of the pages about to be parsed,
+  /// which their revisions carry on from.
+  ///
+  /// Each page starts out with the earlier extraction's citations, and
+  /// the revisions they reference, rather than with none. The page's
+  /// revisions are then tracked as if they followed on from the ones
+  /// the earlier extraction was made from.
+  ///
+  /// @param previous Earlier extraction of the page, which must outlive
+  /// the parse, or null to start each page afresh.
+  void SetPreviousPage(const ExtractedPage* previous) {
+    previous_page_ = previous;
+  }
+
  private:
   std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
+  ExtractorOptions options_;
+  DumpTokenizer tokenizer_;
 
   // Flags for where we are in the XML document
   bool in_page_;
@@ -74,13 +131,155 @@ class DumpParser : public xmlpp::SaxParser {
   bool should_store_;
   bool store_revision_;
 
+  // Header of the current page, checked against the page filter once
+  // it is complete. The revisions of a page that is filtered out are
+  // skipped.
+  int page_namespace_;
+  bool page_redirect_;
+  bool page_checked_;
+  bool skip_page_;
+
+  // Earlier extraction that each page carries on from, if any.
+  const ExtractedPage* previous_page_ = nullptr;
+
   std::string text_buf_;
-  std::vector<wikiopencite::proto::RevisionCitations> citations_by_revision_;
+
+  // Text of the current revision, held until the revision ends so that
+  // its sha1 is known before it is parsed. With the tokenizer, text
+  // that arrives in one piece is left in its read buffer instead, and
+  // only copied if it spans a refill or is parsed after the revision.
+  std::string revision_text_;
+  bool collecting_text_;
+  bool text_retained_;
+  uint64_t text_offset_;
+  std::size_t text_length_;
+  std::string revision_sha1_;
+  bool has_revision_text_;
+  bool revision_parsed_;
+
+  // Set once the current revision's timestamp is outside of the
+  // revision filter's window, so that the rest of it is skipped.
+  bool skip_revision_;
+
+  // Messages for the current page are allocated on the arena, which is
+  // reset once the page has been stored. The first block of the arena
+  // is kept between pages so most pages never allocate.
+  std::vector<char> arena_block_;
+  google::protobuf::Arena arena_;
+
+  // Fingerprints of the citations in a revision, sorted so that they
+  // can be compared.
+  using CitationKeys = std::vector<uint64_t>;
+
+  // A citation discovered on the current page.
+  struct DiscoveredCitation {
+    uint64_t fingerprint;
+    wikiopencite::proto::Citation* citation;
+  };
+
+  // A revision whose citations have been tracked as it ended. The
+  // revision itself is serialized in tracked_history_.
+  struct TrackedRevision {
+    std::size_t offset;
+    uint32_t size;
+    std::shared_ptr<const CitationKeys> keys;
+  };
+
+  // Citations of the current page are tracked as each revision ends for
+  // as long as the revisions are in chronological order. Only the live
+  // citation set and the revisions it references are kept as messages.
+  // The message of every other revision is reused once it has been
+  // tracked, leaving just its serialized form and the fingerprints of
+  // its citations in case the page has to be sorted. Once a revision is
+  // out of order, the remaining revisions are buffered, spilling to
+  // disk past the page memory budget, and the page is sorted then
+  // scanned when it ends.
+  bool in_order_;
+  std::vector<TrackedRevision> tracked_revisions_;
+  std::string tracked_history_;
+  google::protobuf::Timestamp last_tracked_timestamp_;
+
+  // Reused for each tracked revision read back from tracked_history_,
+  // so it is deliberately not on the arena.
+  wikiopencite::proto::Revision rescan_revision_;
+
+  // Citations discovered on the current page, in the order they were
+  // discovered and by fingerprint.
+  std::vector<DiscoveredCitation> discovered_citations_;
+  boost::unordered_flat_map<uint64_t, wikiopencite::proto::Citation*>
+      citations_by_fingerprint_;
+  boost::unordered_flat_map<uint64_t, int> revisions_ref_count_;
+
+  // Fingerprints of the citations in the revision being checked.
+  boost::unordered_flat_set<uint64_t> revision_fingerprints_;
+
+  // Citation keys of each distinct revision text on the current page,
+  // by the sha1 of the text.
+  std::unordered_map<std::string, std::shared_ptr<const CitationKeys>>
+      keys_by_sha1_;
+  std::shared_ptr<const CitationKeys> current_keys_;
+
+  // Reused for the citations of each revision tracked in order, so it
+  // is deliberately not on the arena.
   wikiopencite::proto::RevisionCitations current_citations_;
-  wikiopencite::proto::Page current_page_;
-  wikiopencite::proto::Revision current_revision_;
-  std::map<uint64_t, wikiopencite::proto::Revision> current_page_revisions_;
-  std::map<uint64_t, wikiopencite::proto::Revision> revisions_to_store_;
+
+  RevisionBuffer buffered_revisions_;
+  wikiopencite::proto::Page* current_page_;
+  wikiopencite::proto::Revision* current_revision_;
+  std::map<uint64_t, const wikiopencite::proto::Revision*>
+      revisions_to_store_;
+
+  // Copies of the revisions that citations have referred to, by
+  // revision ID, kept until the page ends.
+  boost::unordered_flat_map<uint64_t, const wikiopencite::proto::Revision*>
+      referenced_revisions_;
+
+  // Revision messages that have been tracked or buffered, ready to be
+  // reused for the next revision.
+  std::vector<wikiopencite::proto::Revision*> free_revisions_;
+
+  // When sampling revisions by bucket, the latest revision of the
+  // current bucket is held back, unparsed, until a revision from
+  // another bucket or the end of the page shows that it was the last.
+  struct HeldRevision {
+    wikiopencite::proto::Revision* revision;
+    std::string text;
+    std::string sha1;
+    bool has_text;
+    bool parsed;
+    std::shared_ptr<const CitationKeys> keys;
+    int64_t bucket;
+  };
+  std::optional<HeldRevision> held_revision_;
+
+  // Once a page's revision text passes the parallel threshold, its
+  // revisions are parsed on the revision pool. They are still tracked
+  // or buffered in the order they ended, each once its text is parsed,
+  // and only a few per thread are left in flight.
+  struct PendingRevision {
+    wikiopencite::proto::Revision* revision;
+    std::string sha1;
+    bool parsed;
+    std::shared_ptr<const CitationKeys> keys;
+    std::shared_future<wikiopencite::proto::RevisionCitations> citations;
+
+    // Set if this revision's text is the one parsed for its sha1.
+    bool parses_sha1;
+  };
+  std::shared_ptr<WorkerPool> revision_pool_;
+  std::size_t page_text_size_;
+  bool parallel_page_;
+  std::deque<PendingRevision> pending_revisions_;
+
+  // Texts being parsed on the pool by their sha1, so that text repeated
+  // while it is in flight, such as by a revert, is only parsed once.
+  std::unordered_map<
+      std::string,
+      std::shared_future<wikiopencite::proto::RevisionCitations>>
+      pending_parses_;
+
+  // Citations parsed on the pool for the revision being tracked.
+  const wikiopencite::proto::RevisionCitations* parsed_citations_ = nullptr;
 
   std::unique_ptr<std::vector<wikiopencite::proto::Page>> stored_pages_;
   std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>
@@ -89,16 +288,125 @@ class DumpParser : public xmlpp::SaxParser {
   /// @brief Complete the pages citations.
   ///
   /// Will deduplicate the citations and make sure only the first and
-  /// last revision is referenced by the citation.
+  /// last revision is referenced by the citation. If the page's
+  /// revisions were out of order, they are sorted by date and scanned
+  /// again first.
   void MakePageCitationList();
 
+  /// @brief Sort the revisions of an out of order page and scan them
+  /// for the page's citations.
+  ///
+  /// The citations of revisions that were tracked in order are rebuilt
+  /// from their keys.
+  void RescanPageCitations();
+
+  /// @brief Update the citations of the current page with the current
+  /// revision, which is in chronological order.
+  void TrackRevision();
+
+  /// @brief Hold on to the current revision and its citations until the
+  /// end of the page, which is out of chronological order.
+  void BufferRevision();
+
+  /// @brief Check that the current revision is not older than the last
+  /// one tracked, falling back to sorting the page if it is.
+  void CheckRevisionOrder();
+
+  /// @brief Parse the current revision's text.
+  ///
+  /// Text with the same sha1 as text already seen on this page is not
+  /// parsed again, the fingerprints of its citations are returned
+  /// instead and the citations are left empty.
+  ///
+  /// @param citations Citations to fill in.
+  /// @return Fingerprints of the reused citations, or null if the text
+  /// was parsed.
+  std::shared_ptr<const CitationKeys> ParseRevisionText(
+      wikiopencite::proto::RevisionCitations* citations);
+
+  /// @brief Get the sorted fingerprints of a revision's citations.
+  /// @param citations Citations keyed by fingerprint.
+  /// @return Fingerprints of the citations.
+  static CitationKeys GetCitationKeys(
+      const wikiopencite::proto::RevisionCitations& citations);
+
+  /// @brief Fill in the citations of a revision from their fingerprints.
+  /// @param keys Fingerprints of the revision's citations.
+  /// @param discovered_citations Citations that the fingerprints are
+  /// found in.
+  /// @param citations Citations to fill in.
+  static void ExpandCitationKeys(
+      const CitationKeys& keys,
+      const boost::unordered_flat_map<uint64_t,
+                                      wikiopencite::proto::Citation*>&
+          discovered_citations,
+      wikiopencite::proto::RevisionCitations* citations);
+
+  /// @brief Update the page's citations with those of a revision.
+  /// @param revision The revision.
+  /// @param keys Fingerprints of the revision's citations.
+  /// @param citations The revision's citations. Only those that have
+  /// not already been discovered need to be present.
+  void UpdateCitations(
+      const wikiopencite::proto::Revision& revision, const CitationKeys& keys,
+      const wikiopencite::proto::RevisionCitations& citations);
+
+  /// @brief Get the copy of a revision that citations refer to, making
+  /// it the first time the revision is referenced.
+  /// @param revision The revision.
+  /// @return Copy of the revision on the arena.
+  const wikiopencite::proto::Revision* ReferenceRevision(
+      const wikiopencite::proto::Revision& revision);
+
+  /// @brief Get an empty revision message on the arena, reusing a
+  /// recycled one if there is one.
+  /// @return The revision message.
+  wikiopencite::proto::Revision* NewRevision();
+
+  /// @brief Clear a revision message that is no longer needed so that
+  /// it can be reused.
+  /// @param revision The revision message.
+  void RecycleRevision(wikiopencite::proto::Revision* revision);
+
+  /// @brief Add the citations of the earlier extraction of the page to
+  /// the page's citations, along with the revisions they reference.
+  void SeedCitations();
+
   /// @brief Reset the parser state.
   void ResetState();
 
+  // DumpTokenizer handlers
+  void OnStartElement(DumpElement element,
+                      std::string_view attributes) override;
+  void OnEndElement(DumpElement element) override;
+  void OnCharacters(std::string_view characters) override;
+
+  /// @brief Handle when an element starts.
+  /// @param element The element that has started.
+  /// @param text_sha1 For text elements, the value of the sha1
+  /// attribute if present.
+  void StartElement(DumpElement element, std::string_view text_sha1);
+
+  /// @brief Handle the start of a revision's text.
+  ///
+  /// If the text's sha1 is given and text with the same sha1 has
+  /// already been tracked on this page, its citations are reused and
+  /// the text is not collected.
+  ///
+  /// @param text_sha1 Value of the sha1 attribute, or empty.
+  void OnStartText(std::string_view text_sha1);
+
   /// @brief Handle when a field ends.
   /// Handles fields such as id, text and so on.
-  /// @param field_name Name of the field that has ended.
-  void OnEndField(const xmlpp::ustring& field_name);
+  /// @param field The field that has ended.
+  void OnEndField(DumpElement field);
+
+  /// @brief Handle the start of a page.
+  void OnStartPage();
+
+  /// @brief Check the header of the current page against the page
+  /// filter, setting whether the rest of the page should be skipped.
+  void CheckPageFilter();
 
   /// @brief Handle the end of a page.
   /// Will assemble the deduplicated page citations list, store the
@@ -107,13 +415,76 @@ class DumpParser : public xmlpp::SaxParser {
   void OnEndPage();
 
   /// @brief Handle the end of a revision.
-  /// Adds the current revision and it's citations to the required
-  /// datastructures and clears it ready for the next one.
+  /// Tracks or buffers the current revision and it's citations, or
+  /// holds it if sampling revisions, and clears it ready for the next
+  /// one.
   void OnEndRevision();
 
+  /// @brief Track or buffer the current revision and its citations, or
+  /// submit it to the revision pool if the page is large enough.
+  void ProcessRevision();
+
+  /// @brief Track or buffer the current revision, depending on whether
+  /// it is in chronological order.
+  void TrackOrBufferRevision();
+
+  /// @brief Queue the current revision to be parsed on the revision
+  /// pool, taking its text. Tracks the oldest pending revision if too
+  /// many are in flight.
+  void SubmitRevision();
+
+  /// @brief Wait for the oldest pending revision to be parsed, then
+  /// track or buffer it, leaving the current revision as it is.
+  void ResolvePendingRevision();
+
+  /// @brief Hold the current revision as the latest of its bucket,
+  /// first processing the held revision if it is from another bucket.
+  void HoldRevision();
+
+  /// @brief Process the held revision, leaving the current revision as
+  /// it is.
+  void ProcessHeldRevision();
+
+  /// @brief Clear the text of the current revision.
+  void ClearRevisionText();
+
+  /// @brief Get the text of the current revision, wherever it is held.
+  /// @return The text, valid until more input is read.
+  std::string_view RevisionText() const;
+
+  /// @brief Copy the text of the current revision out of the
+  /// tokenizer's read buffer, if it is still there, into
+  /// revision_text_.
+  void OwnRevisionText();
+
+  /// @brief Stop retaining text in the tokenizer's read buffer.
+  void ReleaseText();
+
+  /// @brief Check if a revision is within the revision filter's time
+  /// window.
+  /// @param timestamp Timestamp of the revision.
+  /// @return True if the revision should be extracted.
+  bool InRevisionWindow(const google::protobuf::Timestamp& timestamp) const;
+
+  /// @brief Get the bucket a revision is sampled in.
+  /// @param timestamp Timestamp of the revision.
+  /// @return Number identifying the revision's bucket.
+  int64_t RevisionBucketOf(
+      const google::protobuf::Timestamp& timestamp) const;
+
   /// @brief Initialize the required datastructures for the parser.
   void InitializeParser();
 
+  /// @brief Free everything allocated for the current page and create
+  /// the messages for the next one.
+  void ResetArena();
+
+  /// @brief Create the options for the per-page arena.
+  /// @param initial_block Block for the arena to start with.
+  /// @return Arena options.
+  static google::protobuf::ArenaOptions MakeArenaOptions(
+      std::vector<char>* initial_block);
+
   /// @brief Check if any citations already discovered exist in this
   /// revision.
   /// Any citations that are not found in this revision and that have
@@ -125,32 +496,22 @@ class DumpParser : public xmlpp::SaxParser {
   /// added, the fact it was removed and re-added will not be stored and
   /// this information is lost.
   ///
-  /// @param citations Citations in this revision.
-  /// @param discovered_citations Map of citations previously discovered
-  /// for this page.
-  /// @param ref_count Map of the number of references for each
-  /// revision. Used to make sure only revisions with references are
-  /// stored.
-  void CheckExistingCitations(
-      wikiopencite::proto::RevisionCitations* revision,
-      std::map<std::string, wikiopencite::proto::Citation>*
-          discovered_citations,
-      std::map<uint64_t, int>* ref_count);
+  /// The revision's citations are given by revision_fingerprints_.
+  ///
+  /// @param revision The revision.
+  void CheckExistingCitations(const wikiopencite::proto::Revision& revision);
 
   /// @brief Add any citations not already discovered.
-  /// For any citations that do not already exist in
-  /// discovered_citations, this add them setting the revision_added
-  /// field to the current revision ID.
-  /// @param citations Citations in this revision.
-  /// @param discovered_citations Map of citations already found for
-  /// this page.
-  /// @param ref_count Map of the number of references for each
-  /// revision. Used to make sure only revisions with references are
-  /// stored.
-  void AddNewCitations(wikiopencite::proto::RevisionCitations* citations,
-                       std::map<std::string, wikiopencite::proto::Citation>*
-                           discovered_citations,
-                       std::map<uint64_t, int>* ref_count);
+  /// For any citations that have not already been discovered, this adds
+  /// them setting the revision_added field to the current revision ID.
+  /// Each citation's protobuf message is only built once, when it is
+  /// first discovered.
+  /// @param revision The revision.
+  /// @param keys Fingerprints of the revision's citations.
+  /// @param citations The revision's citations.
+  void AddNewCitations(
+      const wikiopencite::proto::Revision& revision, const CitationKeys& keys,
+      const wikiopencite::proto::RevisionCitations& citations);
 };
 }  // namespace wikiopencite::citescoop
 
@@ -0,0 +1,430 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dump_tokenizer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "citescoop/extract.h"
+
+#include "dump_element.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+// Initial size of the read buffer. It grows if a single piece of markup
+// does not fit.
+const std::size_t kBufferSize = 1 << 22;
+
+// Longest entity or character reference, excluding the ampersand and
+// semicolon. Anything longer is not a reference we can decode.
+const std::size_t kMaxReferenceLength = 16;
+
+const char kUnexpectedEnd[] = "Unexpected end of dump";
+const char kWhitespace[] = " \t\r\n";
+
+/// @brief Check if a code point is allowed in an XML document.
+bool IsXMLChar(std::uint32_t code_point) {
+  return code_point == 0x9 || code_point == 0xA || code_point == 0xD ||
+         (code_point >= 0x20 && code_point <= 0xD7FF) ||
+         (code_point >= 0xE000 && code_point <= 0xFFFD) ||
+         (code_point >= 0x10000 && code_point <= 0x10FFFF);
+}
+
+/// @brief Write a code point as UTF-8.
+/// @return End of the written code point.
+char* WriteUTF8(std::uint32_t code_point, char* output) {
+  if (code_point < 0x80) {
+    *output++ = static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    *output++ = static_cast<char>(0xC0 | (code_point >> 6));
+    *output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    *output++ = static_cast<char>(0xE0 | (code_point >> 12));
+    *output++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    *output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+  } else {
+    *output++ = static_cast<char>(0xF0 | (code_point >> 18));
+    *output++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    *output++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    *output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  return output;
+}
+}  // namespace
+
+DumpTokenizer::DumpTokenizer(Handler* handler) : handler_(handler) {}
+
+void DumpTokenizer::Parse(std::istream& input) {
+  input_ = &input;
+  buffer_.resize(kBufferSize);
+  position_ = 0;
+  end_ = 0;
+  buffer_offset_ = 0;
+  retained_offset_.reset();
+  depth_ = 0;
+  seen_root_ = false;
+
+  while (position_ < end_ || Fill()) {
+    auto markup = buffer_[position_] == '<';
+    if (markup ? ReadMarkup() : ReadText()) {
+      continue;
+    }
+
+    if (!Fill()) {
+      if (markup) {
+        throw DumpParseException(kUnexpectedEnd);
+      }
+
+      // Whatever text was held back is all that is left.
+      EmitText(Available(), false);
+      position_ = end_;
+    }
+  }
+
+  if (!seen_root_) {
+    throw DumpParseException("Document is empty");
+  }
+  if (depth_ > 0) {
+    throw DumpParseException(kUnexpectedEnd);
+  }
+}
+
+bool DumpTokenizer::Fill() {
+  auto discard = position_;
+  if (retained_offset_.has_value()) {
+    discard = std::min(
+        discard, static_cast<std::size_t>(*retained_offset_ - buffer_offset_));
+  }
+  if (discard > 0) {
+    buffer_offset_ += discard;
+    std::memmove(buffer_.data(), buffer_.data() + discard, end_ - discard);
+    end_ -= discard;
+    position_ -= discard;
+  }
+
+  if (end_ == buffer_.size()) {
+    buffer_.resize(buffer_.size() * 2);
+  }
+
+  input_->read(buffer_.data() + end_,
+               static_cast<std::streamsize>(buffer_.size() - end_));
+  auto read = static_cast<std::size_t>(input_->gcount());
+  end_ += read;
+  return read > 0;
+}
+
+std::string_view DumpTokenizer::Available() const {
+  return {buffer_.data() + position_, end_ - position_};
+}
+
+void DumpTokenizer::Retain(uint64_t offset) { retained_offset_ = offset; }
+
+void DumpTokenizer::Release() { retained_offset_.reset(); }
+
+std::string_view DumpTokenizer::Retained(uint64_t offset,
+                                         std::size_t length) const {
+  return {buffer_.data() + (offset - buffer_offset_), length};
+}
+
+uint64_t DumpTokenizer::OffsetOf(std::string_view characters) const {
+  return buffer_offset_ +
+         static_cast<uint64_t>(characters.data() - buffer_.data());
+}
+
+bool DumpTokenizer::ReadText() {
+  auto available = Available();
+  const auto* markup = static_cast<const char*>(
+      std::memchr(available.data(), '<', available.size()));
+  if (markup != nullptr) {
+    auto length = static_cast<std::size_t>(markup - available.data());
+    EmitText(available.substr(0, length), false);
+    position_ += length;
+    return true;
+  }
+
+  // The text carries on past the buffer, so hold back anything that
+  // could be cut short: a reference, or a carriage return that may be
+  // followed by a line feed.
+  auto length = available.size();
+  auto tail = length > kMaxReferenceLength ? length - kMaxReferenceLength : 0;
+  auto reference = available.find('&', tail);
+  if (reference != std::string_view::npos) {
+    length = reference;
+  }
+  if (length > 0 && available[length - 1] == '\r') {
+    length--;
+  }
+
+  EmitText(available.substr(0, length), false);
+  position_ += length;
+  return length == available.size();
+}
+
+bool DumpTokenizer::ReadMarkup() {
+  auto available = Available();
+  if (available.size() < 2) {
+    return false;
+  }
+
+  // Processing instruction, such as the XML declaration.
+  if (available[1] == '?') {
+    auto end = available.find("?>", 2);
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    position_ += end + 2;
+    return true;
+  }
+
+  if (available[1] == '!') {
+    if (available.size() < 4) {
+      return false;
+    }
+
+    if (available.starts_with("<!--")) {
+      auto end = available.find("-->", 4);
+      if (end == std::string_view::npos) {
+        return false;
+      }
+      position_ += end + 3;
+      return true;
+    }
+
+    const std::string_view cdata_start = "<![CDATA[";
+    if (available.size() < cdata_start.size()) {
+      return false;
+    }
+
+    if (available.starts_with(cdata_start)) {
+      auto end = available.find("]]>", cdata_start.size());
+      if (end == std::string_view::npos) {
+        return false;
+      }
+      EmitText(available.substr(cdata_start.size(), end - cdata_start.size()),
+               true);
+      position_ += end + 3;
+      return true;
+    }
+
+    // Document type declaration, possibly with an internal subset.
+    auto end = available.find('>');
+    auto subset = available.find('[');
+    if (subset < end) {
+      end = available.find("]", subset);
+      end = end == std::string_view::npos ? end : available.find('>', end);
+    }
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    position_ += end + 1;
+    return true;
+  }
+
+  if (available[1] == '/') {
+    auto end = available.find('>', 2);
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    position_ += end + 1;
+    EndTag(available.substr(2, end - 2));
+    return true;
+  }
+
+  // Start tag. Attribute values may hold a '>', so skip over them.
+  char quote = 0;
+  for (std::size_t i = 1; i < available.size(); i++) {
+    auto c = available[i];
+    if (quote != 0) {
+      quote = c == quote ? 0 : quote;
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '>') {
+      position_ += i + 1;
+      StartTag(available.substr(1, i - 1));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void DumpTokenizer::StartTag(std::string_view tag) {
+  auto self_closing = tag.ends_with('/');
+  if (self_closing) {
+    tag.remove_suffix(1);
+  }
+
+  auto name = tag.substr(0, tag.find_first_of(kWhitespace));
+  if (name.empty()) {
+    throw DumpParseException("Invalid start tag");
+  }
+  if (depth_ == 0 && seen_root_) {
+    throw DumpParseException("Extra content at the end of the document");
+  }
+  seen_root_ = true;
+
+  if (depth_ == open_elements_.size()) {
+    open_elements_.emplace_back();
+  }
+  open_elements_[depth_++].assign(name);
+
+  auto element = LookupDumpElement(name);
+  handler_->OnStartElement(element, tag.substr(name.size()));
+  if (self_closing) {
+    depth_--;
+    handler_->OnEndElement(element);
+  }
+}
+
+std::optional<std::string_view> DumpTokenizer::FindAttribute(
+    std::string_view attributes, std::string_view name) {
+  while (true) {
+    auto name_start = attributes.find_first_not_of(kWhitespace);
+    if (name_start == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    auto equals = attributes.find('=', name_start);
+    if (equals == std::string_view::npos || equals == name_start) {
+      return std::nullopt;
+    }
+    auto name_end = attributes.find_last_not_of(kWhitespace, equals - 1) + 1;
+    auto attribute = attributes.substr(name_start, name_end - name_start);
+
+    auto value_start = attributes.find_first_not_of(kWhitespace, equals + 1);
+    if (value_start == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto quote = attributes[value_start];
+    auto value_end = attributes.find(quote, value_start + 1);
+    if (value_end == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    if (attribute == name) {
+      return attributes.substr(value_start + 1, value_end - value_start - 1);
+    }
+    attributes.remove_prefix(value_end + 1);
+  }
+}
+
+void DumpTokenizer::EndTag(std::string_view tag) {
+  auto name = tag.substr(0, tag.find_last_not_of(kWhitespace) + 1);
+  if (depth_ == 0 || open_elements_[depth_ - 1] != name) {
+    throw DumpParseException("Mismatched end tag: " + std::string(name));
+  }
+
+  depth_--;
+  handler_->OnEndElement(LookupDumpElement(name));
+}
+
+void DumpTokenizer::EmitText(std::string_view text, bool raw) {
+  if (text.empty()) {
+    return;
+  }
+
+  if (depth_ == 0) {
+    if (text.find_first_not_of(kWhitespace) != std::string_view::npos) {
+      throw DumpParseException("Text outside of the root element");
+    }
+    return;
+  }
+
+  auto needs_decoding =
+      (!raw && std::memchr(text.data(), '&', text.size()) != nullptr) ||
+      std::memchr(text.data(), '\r', text.size()) != nullptr;
+  if (!needs_decoding) {
+    handler_->OnCharacters(text);
+    return;
+  }
+
+  handler_->OnCharacters(text.substr(0, Decode(text, raw)));
+}
+
+std::size_t DumpTokenizer::Decode(std::string_view text, bool raw) {
+  const auto has_carriage_return =
+      std::memchr(text.data(), '\r', text.size()) != nullptr;
+  const auto* special = raw ? "\r" : "&\r";
+
+  // The text has been consumed, so is overwritten as it is decoded.
+  auto* output = buffer_.data() + (text.data() - buffer_.data());
+  auto* const decoded = output;
+  std::size_t start = 0;
+  while (start < text.size()) {
+    auto next = has_carriage_return ? text.find_first_of(special, start)
+                : raw               ? std::string_view::npos
+                                    : text.find('&', start);
+    auto length = std::min(next, text.size()) - start;
+    std::memmove(output, text.data() + start, length);
+    output += length;
+    if (next == std::string_view::npos) {
+      break;
+    }
+
+    // Line endings are normalised to a single line feed.
+    if (text[next] == '\r') {
+      start = next + 1;
+      if (start < text.size() && text[start] == '\n') {
+        start++;
+      }
+      *output++ = '\n';
+      continue;
+    }
+
+    auto end = text.find(';', next + 1);
+    if (end == std::string_view::npos ||
+        end - next - 1 > kMaxReferenceLength) {
+      throw DumpParseException("Unterminated entity reference");
+    }
+    output = DecodeReference(text.substr(next + 1, end - next - 1), output);
+    start = end + 1;
+  }
+  return static_cast<std::size_t>(output - decoded);
+}
+
+char* DumpTokenizer::DecodeReference(std::string_view name, char* output) {
+  if (name == "lt") {
+    *output++ = '<';
+  } else if (name == "gt") {
+    *output++ = '>';
+  } else if (name == "amp") {
+    *output++ = '&';
+  } else if (name == "quot") {
+    *output++ = '"';
+  } else if (name == "apos") {
+    *output++ = '\'';
+  } else if (name.starts_with('#')) {
+    auto digits = name.substr(1);
+    auto base = 10;
+    if (digits.starts_with('x')) {
+      digits.remove_prefix(1);
+      base = 16;
+    }
+
+    std::uint32_t code_point = 0;
+    const auto* last = digits.data() + digits.size();
+    auto [ptr, error] =
+        std::from_chars(digits.data(), last, code_point, base);
+    if (digits.empty() || error != std::errc() || ptr != last ||
+        !IsXMLChar(code_point)) {
+      throw DumpParseException("Invalid character reference: &" +
+                               std::string(name) + ";");
+    }
+    // A character reference is at least as long as its UTF-8.
+    output = WriteUTF8(code_point, output);
+  } else {
+    throw DumpParseException("Undefined entity: &" + std::string(name) + ";");
+  }
+  return output;
+}
+
+}  // namespace wikiopencite::citescoop
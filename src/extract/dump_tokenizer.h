@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_DUMP_TOKENIZER_H_
+#define SRC_EXTRACT_DUMP_TOKENIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dump_element.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Specialised tokenizer for MediaWiki XML dumps.
+///
+/// A general purpose XML parser spends most of its time on a dump
+/// copying and converting revision text that is only ever appended to
+/// a buffer. This tokenizer instead reads the dump into a large buffer,
+/// finds markup with @c memchr and hands text to its handler as views
+/// into that buffer. Text holding entity or character references or
+/// carriage returns is decoded in place, which never lengthens it, so
+/// text is never copied. A handler can keep text past its call with
+/// Retain().
+///
+/// It supports the subset of XML that dumps are written in: elements,
+/// attributes (which are skipped), comments, processing instructions,
+/// CDATA sections, a document type declaration, the predefined entities
+/// and character references. Malformed documents throw
+/// DumpParseException.
+class DumpTokenizer {
+ public:
+  /// @brief Receiver of the tokenizer's events.
+  class Handler {
+   public:
+    virtual ~Handler() = default;
+
+    /// @brief Called when an element starts.
+    /// @param element The element.
+    /// @param attributes Raw attributes of the start tag, only valid for
+    /// the duration of the call. See FindAttribute().
+    virtual void OnStartElement(DumpElement element,
+                                std::string_view attributes) = 0;
+
+    /// @brief Called when an element ends.
+    /// @param element The element.
+    virtual void OnEndElement(DumpElement element) = 0;
+
+    /// @brief Called with decoded text content.
+    /// The text of an element may be split over several calls.
+    /// @param characters Text, only valid for the duration of the call.
+    virtual void OnCharacters(std::string_view characters) = 0;
+  };
+
+  /// @brief Construct a new tokenizer.
+  /// @param handler Handler to pass events to.
+  explicit DumpTokenizer(Handler* handler);
+
+  /// @brief Tokenize a dump.
+  /// @param input An input stream of plain XML.
+  void Parse(std::istream& input);
+
+  /// @brief Find the value of an attribute.
+  ///
+  /// The value is returned as it appears in the dump, references in it
+  /// are not decoded.
+  ///
+  /// @param attributes Raw attributes of a start tag.
+  /// @param name Name of the attribute to find.
+  /// @return The attribute value, or nothing if the attribute is not
+  /// present.
+  static std::optional<std::string_view> FindAttribute(
+      std::string_view attributes, std::string_view name);
+
+  /// @brief Keep the input from an offset in the read buffer until
+  /// Release() is called, so that text handed to the handler from that
+  /// offset on can still be read with Retained(). Only one offset is
+  /// retained at a time.
+  /// @param offset Offset in the input, no earlier than the first text
+  /// still in the buffer. See OffsetOf().
+  void Retain(uint64_t offset);
+
+  /// @brief Stop retaining input, allowing it to be discarded.
+  void Release();
+
+  /// @brief Get retained text.
+  /// @param offset Offset in the input of the text.
+  /// @param length Length of the text as it was handed to the handler.
+  /// @return The text, valid until more input is read or it is
+  /// released.
+  std::string_view Retained(uint64_t offset, std::size_t length) const;
+
+  /// @brief Get the offset in the input of text handed to the handler.
+  /// @param characters Text passed to Handler::OnCharacters().
+  /// @return Offset in the input of its first byte.
+  uint64_t OffsetOf(std::string_view characters) const;
+
+  /// @brief Get the offset in the input of the current position.
+  ///
+  /// While an element's start or end is being handled, this is just past
+  /// its tag.
+  ///
+  /// @return Number of bytes of the input consumed.
+  uint64_t offset() const { return buffer_offset_ + position_; }
+
+ private:
+  Handler* handler_;
+  std::istream* input_ = nullptr;
+
+  // Read buffer, holding unconsumed data in [position_, end_)
+  std::vector<char> buffer_;
+  std::size_t position_ = 0;
+  std::size_t end_ = 0;
+
+  // Offset in the input of the start of the buffer.
+  uint64_t buffer_offset_ = 0;
+
+  // Offset in the input of the first byte to keep in the buffer, if
+  // retaining.
+  std::optional<uint64_t> retained_offset_;
+
+  // Names of the currently open elements, the first depth_ are in use.
+  std::vector<std::string> open_elements_;
+  std::size_t depth_ = 0;
+  bool seen_root_ = false;
+
+  /// @brief Read more of the input into the buffer.
+  /// Views into the buffer are invalidated.
+  /// @return True if any more data was read.
+  bool Fill();
+
+  /// @brief Unconsumed data in the buffer.
+  std::string_view Available() const;
+
+  /// @brief Handle the text up to the next markup.
+  /// @return True if the text was consumed, false if more data is
+  /// needed.
+  bool ReadText();
+
+  /// @brief Handle the markup at the current position.
+  /// @return True if the markup was consumed, false if more data is
+  /// needed.
+  bool ReadMarkup();
+
+  /// @brief Handle a start tag.
+  /// @param tag The tag, without the angle brackets.
+  void StartTag(std::string_view tag);
+
+  /// @brief Handle an end tag.
+  /// @param tag The tag, without the angle brackets.
+  void EndTag(std::string_view tag);
+
+  /// @brief Pass text to the handler, decoding it if needed.
+  /// @param text Raw text in the buffer, which is consumed.
+  /// @param raw If set, the text is not checked for references.
+  void EmitText(std::string_view text, bool raw);
+
+  /// @brief Decode references and line endings in text, in place.
+  /// @param text Raw text in the buffer.
+  /// @param raw If set, only line endings are decoded.
+  /// @return Length of the decoded text, at the start of the raw text.
+  std::size_t Decode(std::string_view text, bool raw);
+
+  /// @brief Decode a single entity or character reference.
+  /// @param name The reference without the leading ampersand and
+  /// trailing semicolon.
+  /// @param output Where to write the decoded character, which is never
+  /// longer than the reference.
+  /// @return End of the decoded character.
+  static char* DecodeReference(std::string_view name, char* output);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_DUMP_TOKENIZER_H_
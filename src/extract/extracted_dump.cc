@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+#include "citescoop/extract.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+#include "google/protobuf/arena.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+using google::protobuf::Arena;
+
+namespace {
+// Largest block the arena allocates. Protobuf's default of 8kB would
+// leave a small wiki's dump spread over thousands of blocks.
+const std::size_t kMaxArenaBlockSize = 1 << 20;
+}  // namespace
+
+class ExtractedDump::ExtractedDumpImpl {
+ public:
+  ExtractedDumpImpl() : arena_(MakeArenaOptions()) {}
+
+  void Add(const proto::Page& page,
+           const std::map<uint64_t, const proto::Revision*>& revisions) {
+    auto* stored_page = Arena::CreateMessage<proto::Page>(&arena_);
+    stored_page->CopyFrom(page);
+    pages_.push_back(stored_page);
+
+    for (const auto& [revision_id, revision] : revisions) {
+      auto [entry, inserted] = index_.try_emplace(revision_id, nullptr);
+      if (!inserted) {
+        continue;
+      }
+      auto* stored_revision = Arena::CreateMessage<proto::Revision>(&arena_);
+      stored_revision->CopyFrom(*revision);
+      entry->second = stored_revision;
+      revisions_.push_back(stored_revision);
+    }
+  }
+
+  const std::vector<const proto::Page*>& pages() const { return pages_; }
+
+  const std::vector<const proto::Revision*>& revisions() const {
+    return revisions_;
+  }
+
+  const proto::Revision* Find(uint64_t revision_id) const {
+    auto entry = index_.find(revision_id);
+    return entry == index_.end() ? nullptr : entry->second;
+  }
+
+  std::size_t SpaceUsed() const {
+    // Each slot of the index also has about a byte of metadata.
+    return static_cast<std::size_t>(arena_.SpaceAllocated()) +
+           pages_.capacity() * sizeof(pages_[0]) +
+           revisions_.capacity() * sizeof(revisions_[0]) +
+           index_.bucket_count() *
+               (sizeof(decltype(index_)::value_type) + 1);
+  }
+
+ private:
+  Arena arena_;
+  std::vector<const proto::Page*> pages_;
+  std::vector<const proto::Revision*> revisions_;
+  boost::unordered_flat_map<uint64_t, const proto::Revision*> index_;
+
+  static google::protobuf::ArenaOptions MakeArenaOptions() {
+    auto options = google::protobuf::ArenaOptions();
+    options.max_block_size = kMaxArenaBlockSize;
+    return options;
+  }
+};
+
+ExtractedDump::ExtractedDump()
+    : impl_(std::make_unique<ExtractedDumpImpl>()) {}
+
+ExtractedDump::~ExtractedDump() = default;
+
+ExtractedDump::ExtractedDump(ExtractedDump&& other) noexcept = default;
+
+ExtractedDump& ExtractedDump::operator=(ExtractedDump&& other) noexcept =
+    default;
+
+void ExtractedDump::Consume(
+    const proto::Page& page,
+    const std::map<uint64_t, const proto::Revision*>& revisions) {
+  impl_->Add(page, revisions);
+}
+
+std::span<const proto::Page* const> ExtractedDump::pages() const {
+  return impl_->pages();
+}
+
+std::span<const proto::Revision* const> ExtractedDump::revisions() const {
+  return impl_->revisions();
+}
+
+const proto::Revision* ExtractedDump::FindRevision(
+    uint64_t revision_id) const {
+  return impl_->Find(revision_id);
+}
+
+std::size_t ExtractedDump::SpaceUsed() const { return impl_->SpaceUsed(); }
+
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "extraction_merger.h"
+
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <arpa/inet.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "collecting_dump_parser.h"
+#include "page_splitter.h"
+#include "parsed_page_writer.h"
+#include "temporary_file.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+ExtractionMerger::ExtractionMerger(std::istream* previous_pages,
+                                   std::istream* previous_revisions,
+                                   std::ostream* pages_output,
+                                   std::ostream* revisions_output,
+                                   CollectingDumpParser* xml_parser)
+    : previous_pages_(previous_pages),
+      previous_revisions_(previous_revisions),
+      pages_output_(pages_output),
+      revisions_output_(revisions_output),
+      xml_parser_(xml_parser),
+      writer_(pages_output, revisions_output) {}
+
+std::pair<uint64_t, uint64_t> ExtractionMerger::Merge(std::istream& input) {
+  auto splitter = PageSplitter(&input);
+  auto page_xml = std::string();
+  while (splitter.NextBatch(1, &page_xml)) {
+    uint64_t page_id = 0;
+    uint64_t latest_revision_id = 0;
+    ScanPage(page_xml, &page_id, &latest_revision_id);
+
+    auto& appearances = changed_pages_[page_id];
+    if (appearances.empty()) {
+      changed_page_ids_.push_back(page_id);
+    }
+    appearances.push_back(Spill(page_xml));
+  }
+
+  auto page_message = std::string();
+  auto revision_message = std::string();
+  auto previous = ParsedPage();
+  while (ReadRaw(previous_pages_, &page_message)) {
+    if (!previous.page.ParseFromString(page_message)) {
+      throw std::runtime_error("Could not parse previous page");
+    }
+
+    auto changed = changed_pages_.find(previous.page.page_id());
+    auto replace = changed != changed_pages_.end();
+    if (!replace) {
+      WriteRaw(pages_output_, page_message);
+      pages_copied_++;
+    }
+
+    // The revisions of a changed page are what its citations carry on
+    // from, so they are kept rather than copied.
+    previous.revisions.clear();
+    for (auto i = CountRevisions(previous.page); i > 0; i--) {
+      if (!ReadRaw(previous_revisions_, &revision_message)) {
+        throw std::runtime_error("Previous revisions end before their page");
+      }
+      if (!replace) {
+        WriteRaw(revisions_output_, revision_message);
+        revisions_copied_++;
+        continue;
+      }
+
+      auto revision = proto::Revision();
+      if (!revision.ParseFromString(revision_message)) {
+        throw std::runtime_error("Could not parse previous revision");
+      }
+      auto revision_id = revision.revision_id();
+      previous.revisions.emplace(revision_id, std::move(revision));
+    }
+
+    if (replace) {
+      WriteChanged(changed->second, &previous);
+      changed_pages_.erase(changed);
+    }
+  }
+
+  if (ReadRaw(previous_revisions_, &revision_message)) {
+    throw std::runtime_error("Previous revisions continue past the pages");
+  }
+
+  // Anything left is a new page. Each is erased once written, so a
+  // page that appears more than once is still only written once.
+  for (auto page_id : changed_page_ids_) {
+    auto changed = changed_pages_.find(page_id);
+    if (changed != changed_pages_.end()) {
+      WriteChanged(changed->second, nullptr);
+      changed_pages_.erase(changed);
+    }
+  }
+
+  auto [pages_written, revisions_written] = writer_.counts();
+  return {pages_copied_ + pages_written,
+          revisions_copied_ + revisions_written};
+}
+
+ExtractionMerger::PageExtent ExtractionMerger::Spill(
+    const std::string& page_xml) {
+  if (!file_.is_open()) {
+    file_ = OpenTemporaryFile();
+    file_size_ = 0;
+  }
+
+  file_.clear();
+  file_.seekp(file_size_);
+  if (!file_.write(page_xml.data(),
+                   static_cast<std::streamsize>(page_xml.size()))) {
+    throw std::runtime_error("Could not write page to temporary file");
+  }
+
+  auto extent = PageExtent{file_size_, page_xml.size()};
+  file_size_ += static_cast<std::streamoff>(page_xml.size());
+  return extent;
+}
+
+void ExtractionMerger::WriteChanged(const std::vector<PageExtent>& appearances,
+                                    const ParsedPage* previous) {
+  // Pages skipped by the page filter parse to nothing, leaving the
+  // previous extraction of the page as it was.
+  auto current = std::optional<ParsedPage>();
+  auto xml = std::string();
+  for (const auto& appearance : appearances) {
+    xml.resize(appearance.size);
+    file_.clear();
+    file_.seekg(appearance.offset);
+    if (!file_.read(xml.data(), static_cast<std::streamsize>(xml.size()))) {
+      throw std::runtime_error("Could not read page from temporary file");
+    }
+
+    auto pages = xml_parser_->ParseFragment(
+        xml, current.has_value() ? &*current : previous);
+    if (!pages.empty()) {
+      current = std::move(pages.front());
+    }
+  }
+
+  if (current.has_value()) {
+    writer_.Write(*current);
+  } else if (previous != nullptr) {
+    writer_.Write(*previous);
+  }
+}
+
+bool ExtractionMerger::ReadRaw(std::istream* input, std::string* message) {
+  uint32_t size = 0;
+  input->read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (input->gcount() == 0 && input->eof()) {
+    return false;
+  }
+  if (input->gcount() != sizeof(size)) {
+    throw std::runtime_error("Previous extraction is truncated");
+  }
+
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  message->resize(ntohl(size));
+  input->read(message->data(), static_cast<std::streamsize>(message->size()));
+  if (static_cast<std::size_t>(input->gcount()) != message->size()) {
+    throw std::runtime_error("Previous extraction is truncated");
+  }
+  return true;
+}
+
+void ExtractionMerger::WriteRaw(std::ostream* output,
+                                const std::string& message) {
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t network_size = htonl(static_cast<uint32_t>(message.size()));
+  output->write(reinterpret_cast<char*>(&network_size), sizeof(network_size));
+  output->write(message.data(), static_cast<std::streamsize>(message.size()));
+}
+
+std::size_t ExtractionMerger::CountRevisions(const proto::Page& page) {
+  auto revisions = std::unordered_set<uint64_t>();
+  for (const auto& citation : page.citations()) {
+    if (citation.has_revision_added()) {
+      revisions.insert(citation.revision_added());
+    }
+    if (citation.has_revision_removed()) {
+      revisions.insert(citation.revision_removed());
+    }
+  }
+  return revisions.size();
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_EXTRACTION_MERGER_H_
+#define SRC_EXTRACT_EXTRACTION_MERGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "citescoop/proto/page.pb.h"
+
+#include "collecting_dump_parser.h"
+#include "parsed_page_writer.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Merge an incremental dump into a previous streaming
+/// extraction.
+///
+/// The incremental dump is cut into whole pages up front, and the ID of
+/// each is found with a plain substring search. Each page is appended
+/// to a temporary file as it is cut, so only its offset and length are
+/// held in memory, and it is read back a page at a time to be parsed.
+/// The previous extraction
+/// is then read back a page at a time, along with the revisions its
+/// citations reference, which follow on in the revisions stream in
+/// order of revision ID. A changed page is parsed when its previous
+/// extraction is reached, carrying on from that extraction's citations,
+/// and replaces it where it was. The rest are copied through byte for
+/// byte. Only page messages are decoded, to find their ID and the
+/// number of revisions that follow them, along with the revisions of
+/// changed pages. Changed pages that were not in the previous
+/// extraction are written at the end.
+class ExtractionMerger {
+ public:
+  /// @brief Construct a new merger.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @param xml_parser Parser to parse the changed pages with.
+  ExtractionMerger(std::istream* previous_pages,
+                   std::istream* previous_revisions,
+                   std::ostream* pages_output, std::ostream* revisions_output,
+                   CollectingDumpParser* xml_parser);
+
+  /// @brief Merge an incremental dump into the previous extraction.
+  ///
+  /// A page that appears more than once in the incremental dump is
+  /// parsed once for each, each carrying on from the one before, and
+  /// written once.
+  ///
+  /// Will throw a std::runtime_error if the previous extraction is
+  /// truncated or its streams don't match.
+  ///
+  /// @param input Plain XML of the incremental dump.
+  /// @return Number of pages written followed by the number of
+  /// revisions written.
+  std::pair<uint64_t, uint64_t> Merge(std::istream& input);
+
+  /// @brief Read the next serialized message of a PBF formatted stream.
+  ///
+  /// Will throw a std::runtime_error if the stream ends part way
+  /// through the message.
+  ///
+  /// @param input Stream to read from.
+  /// @param message Set to the serialized message.
+  /// @return False if the stream has ended.
+  static bool ReadRaw(std::istream* input, std::string* message);
+
+  /// @brief Write a serialized message to a PBF formatted stream.
+  /// @param output Stream to write to.
+  /// @param message Serialized message.
+  static void WriteRaw(std::ostream* output, const std::string& message);
+
+ private:
+  std::istream* previous_pages_;
+  std::istream* previous_revisions_;
+  std::ostream* pages_output_;
+  std::ostream* revisions_output_;
+  CollectingDumpParser* xml_parser_;
+  ParsedPageWriter writer_;
+
+  uint64_t pages_copied_ = 0;
+  uint64_t revisions_copied_ = 0;
+
+  // An appearance of a changed page in the temporary file.
+  struct PageExtent {
+    std::streamoff offset;
+    std::size_t size;
+  };
+
+  // Temporary file holding the XML of every changed page, opened on
+  // the first page.
+  std::fstream file_;
+  std::streamoff file_size_ = 0;
+
+  // Appearances of each changed page, by page ID, in the order they
+  // appear in the incremental dump, until the page has been written.
+  std::unordered_map<uint64_t, std::vector<PageExtent>> changed_pages_;
+  std::vector<uint64_t> changed_page_ids_;
+
+  /// @brief Append the XML of a changed page to the temporary file.
+  /// @param page_xml XML of the page.
+  /// @return Where the page was written.
+  PageExtent Spill(const std::string& page_xml);
+
+  /// @brief Parse each appearance of a changed page in turn, each
+  /// carrying on from the one before, then write the result.
+  /// @param appearances Where each appearance of the page was written
+  /// to the temporary file.
+  /// @param previous Previous extraction of the page, or null if it is
+  /// new.
+  void WriteChanged(const std::vector<PageExtent>& appearances,
+                    const ParsedPage* previous);
+
+  /// @brief Count the distinct revisions referenced by a page's
+  /// citations, which are the revisions written after it.
+  /// @param page Page to count the revisions of.
+  /// @return Number of revisions referenced.
+  static std::size_t CountRevisions(const wikiopencite::proto::Page& page);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_EXTRACTION_MERGER_H_
@@ -3,8 +3,23 @@
 
 #include "citescoop/extract.h"
 
+#include <cstdint>
+#include <map>
+
+#include "citescoop/proto/revision.pb.h"
+
 namespace wikiopencite::citescoop {
 
 Extractor::~Extractor() = default;
 
+PageSink::~PageSink() = default;
+
+void PageSink::Consume(ExtractedPage&& page) {
+  auto revisions = std::map<uint64_t, const wikiopencite::proto::Revision*>();
+  for (const auto& [revision_id, revision] : page.revisions) {
+    revisions.emplace(revision_id, &revision);
+  }
+  Consume(page.page, revisions);
+}
+
 }  // namespace wikiopencite::citescoop
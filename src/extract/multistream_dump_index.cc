@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "citescoop/extract.h"
+
+#include "multistream_dump_index_impl.h"
+#include "multistream_index.h"
+
+namespace wikiopencite::citescoop {
+
+MultistreamDumpIndex::MultistreamDumpIndexImpl::MultistreamDumpIndexImpl(
+    std::istream& index) {
+  auto parsed = MultistreamIndex::Read(index);
+  offsets_ = parsed.StreamOffsets();
+
+  const auto& entries = parsed.entries();
+  offsets_by_id_.reserve(entries.size());
+  offsets_by_title_.reserve(entries.size());
+  for (const auto& entry : entries) {
+    offsets_by_id_.emplace(entry.page_id, entry.offset);
+    offsets_by_title_.emplace(entry.title, entry.offset);
+  }
+}
+
+std::optional<StreamLocation>
+MultistreamDumpIndex::MultistreamDumpIndexImpl::Find(uint64_t page_id) const {
+  auto offset = offsets_by_id_.find(page_id);
+  if (offset == offsets_by_id_.end()) {
+    return std::nullopt;
+  }
+  return Locate(offset->second);
+}
+
+std::optional<StreamLocation>
+MultistreamDumpIndex::MultistreamDumpIndexImpl::Find(
+    const std::string& title) const {
+  auto offset = offsets_by_title_.find(title);
+  if (offset == offsets_by_title_.end()) {
+    return std::nullopt;
+  }
+  return Locate(offset->second);
+}
+
+StreamLocation MultistreamDumpIndex::MultistreamDumpIndexImpl::Locate(
+    uint64_t offset) const {
+  // The last stream of pages is followed by one holding the end of the
+  // document, so it is read to the end of the dump.
+  auto next = std::ranges::upper_bound(offsets_, offset);
+  return {offset, next == offsets_.end() ? 0 : *next - offset};
+}
+
+MultistreamDumpIndex::MultistreamDumpIndex(std::istream& index)
+    : impl_(std::make_unique<MultistreamDumpIndexImpl>(index)) {}
+
+MultistreamDumpIndex::MultistreamDumpIndex(
+    MultistreamDumpIndex&& other) noexcept = default;
+
+MultistreamDumpIndex& MultistreamDumpIndex::operator=(
+    MultistreamDumpIndex&& other) noexcept = default;
+
+MultistreamDumpIndex::~MultistreamDumpIndex() = default;
+
+std::size_t MultistreamDumpIndex::size() const { return impl_->size(); }
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_MULTISTREAM_DUMP_INDEX_IMPL_H_
+#define SRC_EXTRACT_MULTISTREAM_DUMP_INDEX_IMPL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+#include "citescoop/extract.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Location of a bzip2 stream within a multistream dump.
+struct StreamLocation {
+  /// Byte offset of the stream
+  uint64_t offset;
+
+  /// Length of the stream in bytes, or 0 if it runs to the end of the
+  /// dump.
+  uint64_t length;
+};
+
+/// @brief Implementation of the in-memory multistream dump index.
+class MultistreamDumpIndex::MultistreamDumpIndexImpl {
+ public:
+  /// @brief Read a multistream index.
+  /// @param index Index stream, either bzip2 compressed or plain text.
+  explicit MultistreamDumpIndexImpl(std::istream& index);
+
+  /// @brief Find the stream holding a page.
+  /// @param page_id ID of the page.
+  /// @return Location of the stream, or nothing if the page is not in
+  /// the index.
+  std::optional<StreamLocation> Find(uint64_t page_id) const;
+
+  /// @brief Find the stream holding a page.
+  /// @param title Title of the page.
+  /// @return Location of the stream, or nothing if the page is not in
+  /// the index.
+  std::optional<StreamLocation> Find(const std::string& title) const;
+
+  /// @brief Get the number of pages in the index.
+  /// @return Number of pages.
+  std::size_t size() const { return offsets_by_id_.size(); }
+
+ private:
+  // Sorted offsets of every stream, to find where each one ends.
+  std::vector<uint64_t> offsets_;
+  boost::unordered_flat_map<uint64_t, uint64_t> offsets_by_id_;
+  boost::unordered_flat_map<std::string, uint64_t> offsets_by_title_;
+
+  /// @brief Get the location of the stream starting at an offset.
+  /// @param offset Offset of the stream.
+  /// @return Location of the stream.
+  StreamLocation Locate(uint64_t offset) const;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_MULTISTREAM_DUMP_INDEX_IMPL_H_
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "multistream_dump_parser.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/iostreams/categories.hpp"
+#include "boost/iostreams/device/array.hpp"
+#include "boost/iostreams/filter/bzip2.hpp"
+#include "boost/iostreams/filtering_streambuf.hpp"
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "collecting_dump_parser.h"
+#include "dump_parser.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+namespace bio = boost::iostreams;
+
+namespace {
+// Number of streams to keep in flight per worker. Enough to keep the
+// workers busy while the reader is blocked on a slow stream.
+const unsigned int kStreamsPerWorker = 2;
+}  // namespace
+
+MultistreamDumpParser::MultistreamDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : parser_(std::move(parser)),
+      options_(options),
+      revision_pool_(MakeRevisionPool(options)) {}
+
+void MultistreamDumpParser::Parse(
+    std::istream& input, const std::vector<uint64_t>& offsets,
+    const std::function<void(ParsedPage&&)>& sink) {
+  auto pool = WorkerPool(options_.threads);
+  const auto max_pending = pool.size() * kStreamsPerWorker;
+  auto pending = std::deque<std::future<std::vector<ParsedPage>>>();
+
+  uint64_t position = 0;
+  for (auto offset = offsets.begin(); offset != offsets.end(); offset++) {
+    input.ignore(static_cast<std::streamsize>(*offset - position));
+
+    auto next = std::next(offset);
+    auto length = next == offsets.end() ? 0 : *next - *offset;
+    auto compressed = ReadStream(input, length);
+    position = *offset + compressed.size();
+    if (compressed.empty()) {
+      break;
+    }
+
+    pending.push_back(
+        pool.Submit([this, compressed = std::move(compressed)]() {
+          return ParseStream(compressed);
+        }));
+
+    while (pending.size() >= max_pending) {
+      Drain(&pending, sink);
+    }
+  }
+
+  while (!pending.empty()) {
+    Drain(&pending, sink);
+  }
+}
+
+std::vector<ParsedPage> MultistreamDumpParser::ParseStream(
+    const std::string& compressed) const {
+  bio::filtering_streambuf<bio::input> decompression_stream;
+  decompression_stream.push(bio::bzip2_decompressor());
+  decompression_stream.push(
+      bio::array_source(compressed.data(), compressed.size()));
+
+  std::istream decompressed_stream(&decompression_stream);
+  auto xml = std::string(std::istreambuf_iterator<char>(decompressed_stream),
+                         std::istreambuf_iterator<char>());
+
+  auto xml_parser = CollectingDumpParser(parser_, options_, revision_pool_);
+  return xml_parser.ParseFragment(xml);
+}
+
+void MultistreamDumpParser::Drain(
+    std::deque<std::future<std::vector<ParsedPage>>>* pending,
+    const std::function<void(ParsedPage&&)>& sink) const {
+  auto pages = TakeCompleted(pending, options_.preserve_order);
+  for (auto& page : pages) {
+    sink(std::move(page));
+  }
+}
+
+std::string MultistreamDumpParser::ReadStream(std::istream& input,
+                                              uint64_t length) {
+  if (length == 0) {
+    return {std::istreambuf_iterator<char>(input),
+            std::istreambuf_iterator<char>()};
+  }
+
+  auto compressed = std::string(length, '\0');
+  input.read(compressed.data(), static_cast<std::streamsize>(length));
+  compressed.resize(static_cast<std::size_t>(input.gcount()));
+  return compressed;
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_MULTISTREAM_DUMP_PARSER_H_
+#define SRC_EXTRACT_MULTISTREAM_DUMP_PARSER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "collecting_dump_parser.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Parallel parser for bzip2 multistream dumps.
+///
+/// The compressed dump is read sequentially on the calling thread and
+/// cut into its independent bzip2 streams using the offsets from the
+/// multistream index. Each stream is decompressed and parsed by its own
+/// CollectingDumpParser on a worker pool, and the parsed pages are
+/// handed back to the calling thread.
+class MultistreamDumpParser {
+ public:
+  /// @brief Construct a new multistream dump parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options, controlling the number of
+  /// workers and whether the page order is preserved.
+  MultistreamDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                        ExtractorOptions options);
+
+  /// @brief Parse a multistream dump.
+  ///
+  /// The number of streams in flight is bounded so that memory use
+  /// stays proportional to the number of workers rather than the size
+  /// of the dump.
+  ///
+  /// @param input Stream of the compressed multistream dump.
+  /// @param offsets Sorted byte offsets of each bzip2 stream holding
+  /// pages. Any data before the first offset (the site info header) is
+  /// skipped.
+  /// @param sink Called on the calling thread with each parsed page.
+  void Parse(std::istream& input, const std::vector<uint64_t>& offsets,
+             const std::function<void(ParsedPage&&)>& sink);
+
+  /// @brief Decompress and parse a single bzip2 stream of the dump.
+  /// @param compressed The compressed bzip2 stream.
+  /// @return Pages held in the stream, in the order they appear.
+  std::vector<ParsedPage> ParseStream(const std::string& compressed) const;
+
+  /// @brief Read a single bzip2 stream from the dump.
+  /// @param input Compressed dump, positioned at the start of the stream.
+  /// @param length Length of the stream in bytes, or 0 to read until the
+  /// end of the input.
+  /// @return The compressed stream.
+  static std::string ReadStream(std::istream& input, uint64_t length);
+
+ private:
+  std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
+  ExtractorOptions options_;
+
+  // Shared by the parsers of every stream.
+  std::shared_ptr<WorkerPool> revision_pool_;
+
+  /// @brief Pass the next completed stream's pages to the sink.
+  ///
+  /// If preserving order, this will wait for the oldest stream to
+  /// finish. Otherwise the first finished stream is used.
+  ///
+  /// @param pending Streams currently being parsed.
+  /// @param sink Sink to pass pages to.
+  void Drain(std::deque<std::future<std::vector<ParsedPage>>>* pending,
+             const std::function<void(ParsedPage&&)>& sink) const;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_MULTISTREAM_DUMP_PARSER_H_
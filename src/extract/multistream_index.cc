@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "multistream_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/iostreams/categories.hpp"
+#include "boost/iostreams/filter/bzip2.hpp"
+#include "boost/iostreams/filtering_streambuf.hpp"
+#include "citescoop/extract.h"
+
+namespace wikiopencite::citescoop {
+namespace bio = boost::iostreams;
+
+MultistreamIndex MultistreamIndex::Read(std::istream& input) {
+  auto index = MultistreamIndex();
+
+  // Index lines always start with a digit, so a leading 'B' can only be
+  // the start of the "BZh" bzip2 magic.
+  if (input.peek() == 'B') {
+    bio::filtering_streambuf<bio::input> decompression_stream;
+    decompression_stream.push(bio::bzip2_decompressor());
+    decompression_stream.push(input);
+
+    std::istream decompressed_stream(&decompression_stream);
+    index.ReadEntries(decompressed_stream);
+  } else {
+    index.ReadEntries(input);
+  }
+
+  return index;
+}
+
+std::vector<uint64_t> MultistreamIndex::StreamOffsets() const {
+  auto offsets = std::vector<uint64_t>();
+  offsets.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    offsets.push_back(entry.offset);
+  }
+
+  std::ranges::sort(offsets);
+  auto duplicates = std::ranges::unique(offsets);
+  offsets.erase(duplicates.begin(), duplicates.end());
+  return offsets;
+}
+
+void MultistreamIndex::ReadEntries(std::istream& input) {
+  std::string line;
+  while (std::getline(input, line)) {
+    if (!line.empty()) {
+      entries_.push_back(ParseLine(line));
+    }
+  }
+}
+
+MultistreamIndexEntry MultistreamIndex::ParseLine(const std::string& line) {
+  // Titles may themselves contain colons, so only split on the first two.
+  auto first = line.find(':');
+  auto second =
+      first == std::string::npos ? first : line.find(':', first + 1);
+  if (second == std::string::npos) {
+    throw DumpParseException("Malformed multistream index line: " + line);
+  }
+
+  try {
+    return MultistreamIndexEntry{
+        .offset = static_cast<uint64_t>(std::stoull(line.substr(0, first))),
+        .page_id = static_cast<uint64_t>(
+            std::stoull(line.substr(first + 1, second - first - 1))),
+        .title = line.substr(second + 1)};
+  } catch (const std::logic_error&) {
+    throw DumpParseException("Malformed multistream index line: " + line);
+  }
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_MULTISTREAM_INDEX_H_
+#define SRC_EXTRACT_MULTISTREAM_INDEX_H_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace wikiopencite::citescoop {
+
+/// @brief A single entry of a multistream dump index.
+struct MultistreamIndexEntry {
+  /// Byte offset of the bzip2 stream containing the page
+  uint64_t offset;
+
+  /// ID of the page
+  uint64_t page_id;
+
+  /// Title of the page
+  std::string title;
+};
+
+/// @brief Index of a Wikimedia multistream dump.
+///
+/// The index is a text file (normally bzip2 compressed) with one line
+/// per page in the format @c offset:page_id:title, where offset is the
+/// byte offset of the bzip2 stream containing the page within the dump.
+class MultistreamIndex {
+ public:
+  /// @brief Read a multistream index.
+  ///
+  /// Will throw a DumpParseException if any line of the index is
+  /// malformed.
+  ///
+  /// @param input Index stream, either bzip2 compressed or plain text.
+  /// @return The parsed index.
+  static MultistreamIndex Read(std::istream& input);
+
+  /// @brief Get the index entries in the order they appear in the index.
+  /// @return Index entries.
+  const std::vector<MultistreamIndexEntry>& entries() const {
+    return entries_;
+  }
+
+  /// @brief Get the distinct stream offsets in the dump.
+  /// @return Sorted byte offsets of each bzip2 stream holding pages.
+  std::vector<uint64_t> StreamOffsets() const;
+
+ private:
+  /// @brief Read the entries of a plain text index.
+  /// @param input Plain text index stream.
+  void ReadEntries(std::istream& input);
+
+  /// @brief Parse a single line of the index.
+  /// @param line Line to parse.
+  /// @return The parsed entry.
+  static MultistreamIndexEntry ParseLine(const std::string& line);
+
+  std::vector<MultistreamIndexEntry> entries_;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_MULTISTREAM_INDEX_H_
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <streambuf>
+#include <utility>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "page_range_impl.h"
+
+namespace wikiopencite::citescoop {
+
+PageRange::PageRangeImpl::PageRangeImpl(
+    std::istream* input, std::unique_ptr<std::streambuf> decompression,
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : decompression_(std::move(decompression)),
+      decompressed_(decompression_ == nullptr
+                        ? nullptr
+                        : std::make_unique<std::istream>(decompression_.get())),
+      splitter_(decompressed_ == nullptr ? input : decompressed_.get()),
+      parser_(std::move(parser), options) {}
+
+void PageRange::PageRangeImpl::Start() {
+  if (!started_) {
+    started_ = true;
+    Next();
+  }
+}
+
+bool PageRange::PageRangeImpl::Next() {
+  // A single byte limit cuts exactly one page at a time. Pages that are
+  // filtered out parse to nothing, so carry on to the next one.
+  while (!done_ && splitter_.NextBatch(1, &page_xml_)) {
+    auto pages = parser_.ParseFragment(page_xml_);
+    if (!pages.empty()) {
+      current_ = std::move(pages.front());
+      return true;
+    }
+  }
+
+  done_ = true;
+  return false;
+}
+
+PageRange::PageRange(std::unique_ptr<PageRangeImpl> impl)
+    : impl_(std::move(impl)) {}
+
+PageRange::PageRange(PageRange&& other) noexcept = default;
+
+PageRange& PageRange::operator=(PageRange&& other) noexcept = default;
+
+PageRange::~PageRange() = default;
+
+PageRange::Iterator PageRange::begin() {
+  impl_->Start();
+  return Iterator(this);
+}
+
+ExtractedPage& PageRange::Iterator::operator*() const {
+  return range_->impl_->current();
+}
+
+ExtractedPage* PageRange::Iterator::operator->() const {
+  return &range_->impl_->current();
+}
+
+PageRange::Iterator& PageRange::Iterator::operator++() {
+  range_->impl_->Next();
+  return *this;
+}
+
+void PageRange::Iterator::operator++(int) { ++*this; }
+
+bool PageRange::Iterator::operator==(std::default_sentinel_t /*end*/) const {
+  return range_ == nullptr || range_->impl_->done();
+}
+
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PAGE_RANGE_IMPL_H_
+#define SRC_EXTRACT_PAGE_RANGE_IMPL_H_
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "collecting_dump_parser.h"
+#include "page_splitter.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Implementation of a lazily extracted page range.
+///
+/// The dump is cut into pages with a page splitter, reading only as far
+/// as the end of the next page, which is then parsed on its own.
+class PageRange::PageRangeImpl {
+ public:
+  /// @brief Construct a new page range implementation.
+  /// @param input Stream of plain dump XML. Ignored if decompression is
+  /// set.
+  /// @param decompression Stream buffer of the decompressed dump XML,
+  /// owned by the range. May be null.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options to configure the parser with.
+  PageRangeImpl(std::istream* input,
+                std::unique_ptr<std::streambuf> decompression,
+                std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                ExtractorOptions options);
+
+  /// @brief Extract the first page, if not already started.
+  void Start();
+
+  /// @brief Extract the next page.
+  /// @return False once there are no more pages.
+  bool Next();
+
+  /// @brief Get the current page.
+  /// @return The most recently extracted page.
+  ExtractedPage& current() { return current_; }
+
+  /// @brief Check if every page has been extracted.
+  /// @return True once there are no more pages.
+  bool done() const { return done_; }
+
+ private:
+  std::unique_ptr<std::streambuf> decompression_;
+  std::unique_ptr<std::istream> decompressed_;
+  PageSplitter splitter_;
+  CollectingDumpParser parser_;
+
+  std::string page_xml_;
+  ExtractedPage current_;
+  bool started_ = false;
+  bool done_ = false;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PAGE_RANGE_IMPL_H_
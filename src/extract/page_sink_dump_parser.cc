@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "page_sink_dump_parser.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+PageSinkDumpParser::PageSinkDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : DumpParser(std::move(parser), options) {}
+
+std::pair<uint64_t, uint64_t> PageSinkDumpParser::ParseXML(
+    std::istream& input, PageSink& sink) {
+  sink_ = &sink;
+  pages_consumed_ = 0;
+  revisions_consumed_ = 0;
+
+  StartParser(input);
+
+  return {pages_consumed_, revisions_consumed_};
+}
+
+void PageSinkDumpParser::Store(
+    const std::map<uint64_t, const proto::Revision*>& revisions,
+    const proto::Page& page) {
+  sink_->Consume(page, revisions);
+  pages_consumed_++;
+  revisions_consumed_ += revisions.size();
+}
+
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PAGE_SINK_DUMP_PARSER_H_
+#define SRC_EXTRACT_PAGE_SINK_DUMP_PARSER_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief MediaWiki XML dump parser handing pages to a sink as they are
+/// parsed.
+///
+/// Pages are passed to the sink straight from the parser's per-page
+/// arena, so nothing is copied or serialized.
+class PageSinkDumpParser : private DumpParser {
+ public:
+  /// @brief Construct a new dumps parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options to configure the parser with.
+  PageSinkDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                     ExtractorOptions options);
+
+  /// @brief Parse the dump XML.
+  /// @param input An input stream of plain XML. NOTE: if you are
+  /// dealing with a compressed dump, this must have already been
+  /// decompressed by this point.
+  /// @param sink Sink to consume each page.
+  /// @return Number of pages consumed followed by the number of
+  /// revisions consumed.
+  std::pair<uint64_t, uint64_t> ParseXML(std::istream& input, PageSink& sink);
+
+ protected:
+  void Store(
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>& revisions,
+      const wikiopencite::proto::Page& page) override;
+
+ private:
+  PageSink* sink_ = nullptr;
+  uint64_t pages_consumed_ = 0;
+  uint64_t revisions_consumed_ = 0;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PAGE_SINK_DUMP_PARSER_H_
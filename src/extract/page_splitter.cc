@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "page_splitter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+
+#include "citescoop/extract.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+const char kPageStart[] = "<page>";
+const char kPageEnd[] = "</page>";
+const char kDocumentEnd[] = "</mediawiki>";
+const char kRevisionStart[] = "<revision>";
+const char kIdStart[] = "<id>";
+const std::streamsize kReadSize = 1 << 20;
+
+/// @brief Read the number inside an id element.
+/// @param xml XML holding the element.
+/// @param start Position of the element's start tag.
+/// @return The number, or 0 if there isn't one.
+uint64_t ReadId(const std::string& xml, std::size_t start) {
+  const auto* first = xml.data() + start + sizeof(kIdStart) - 1;
+  uint64_t id = 0;
+  std::from_chars(first, xml.data() + xml.size(), id);
+  return id;
+}
+}  // namespace
+
+PageSplitter::PageSplitter(std::istream* input) : input_(input) {}
+
+bool PageSplitter::NextBatch(std::size_t max_size, std::string* batch) {
+  buffer_.erase(0, position_);
+  position_ = 0;
+
+  std::size_t end = 0;
+  while (end < max_size) {
+    auto page_end = FindPageEnd(end);
+    if (page_end == std::string::npos) {
+      break;
+    }
+    end = page_end;
+  }
+
+  if (end == 0) {
+    CheckTrailer();
+    return false;
+  }
+
+  batch->assign(buffer_, 0, end);
+  position_ = end;
+  return true;
+}
+
+std::size_t PageSplitter::FindPageEnd(std::size_t from) {
+  const auto end_length = sizeof(kPageEnd) - 1;
+  auto search_from = from;
+
+  while (true) {
+    auto page_end = buffer_.find(kPageEnd, search_from);
+    if (page_end != std::string::npos) {
+      return page_end + end_length;
+    }
+
+    // Allow for the end tag being split across two chunks.
+    search_from = buffer_.size() < end_length
+                      ? from
+                      : std::max(from, buffer_.size() - end_length + 1);
+    if (!ReadChunk()) {
+      return std::string::npos;
+    }
+  }
+}
+
+bool PageSplitter::ReadChunk() {
+  auto size = buffer_.size();
+  buffer_.resize(size + kReadSize);
+  input_->read(buffer_.data() + size, kReadSize);
+  buffer_.resize(size + static_cast<std::size_t>(input_->gcount()));
+  return buffer_.size() != size;
+}
+
+void PageSplitter::CheckTrailer() {
+  while (ReadChunk()) {
+  }
+
+  if (buffer_.find(kPageStart) != std::string::npos ||
+      buffer_.find(kDocumentEnd) == std::string::npos) {
+    throw DumpParseException("Unexpected end of dump");
+  }
+}
+
+void ScanPage(const std::string& xml, uint64_t* page_id,
+              uint64_t* latest_revision_id) {
+  *page_id = 0;
+  *latest_revision_id = 0;
+  auto page = xml.find(kPageStart);
+  if (page == std::string::npos) {
+    return;
+  }
+
+  auto revision = xml.find(kRevisionStart, page);
+  auto id = xml.find(kIdStart, page);
+  if (id < revision) {
+    *page_id = ReadId(xml, id);
+  }
+
+  while (revision != std::string::npos) {
+    id = xml.find(kIdStart, revision);
+    if (id == std::string::npos) {
+      return;
+    }
+    *latest_revision_id = std::max(*latest_revision_id, ReadId(xml, id));
+    revision = xml.find(kRevisionStart, id);
+  }
+}
+}  // namespace wikiopencite::citescoop
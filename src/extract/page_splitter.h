@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PAGE_SPLITTER_H_
+#define SRC_EXTRACT_PAGE_SPLITTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Cut a MediaWiki XML dump into runs of whole page elements.
+///
+/// Revision text is always escaped in the dumps, so a literal
+/// @c </page> can only ever be the end of a page element. This allows
+/// pages to be found with a plain substring search, without parsing
+/// the XML.
+class PageSplitter {
+ public:
+  /// @brief Construct a new page splitter.
+  /// @param input Stream of plain dump XML.
+  explicit PageSplitter(std::istream* input);
+
+  /// @brief Read the next run of whole pages.
+  ///
+  /// Will throw a DumpParseException if the dump ends part way through
+  /// a page or without closing the document.
+  ///
+  /// @param max_size Stop adding pages to the batch once it is at least
+  /// this many bytes.
+  /// @param batch Set to the XML of one or more whole page elements.
+  /// @return False once there are no more pages.
+  bool NextBatch(std::size_t max_size, std::string* batch);
+
+ private:
+  std::istream* input_;
+  std::string buffer_;
+  std::size_t position_ = 0;
+
+  /// @brief Find the next page end, reading more input if required.
+  /// @param from Position in the buffer to search from.
+  /// @return Position of the end of the next page, or npos if the
+  /// input has been exhausted.
+  std::size_t FindPageEnd(std::size_t from);
+
+  /// @brief Read the next chunk of input into the buffer.
+  /// @return False if the input has been exhausted.
+  bool ReadChunk();
+
+  /// @brief Check the remainder of the dump after the last page.
+  void CheckTrailer();
+};
+
+/// @brief Find the ID and highest revision ID of a page without
+/// parsing its XML.
+///
+/// A page's own id element comes before its first revision, and each
+/// revision's id element is the first inside it. Revision text is
+/// always escaped, so can't hold any of the tags searched for.
+///
+/// @param xml XML of the page.
+/// @param page_id Set to the page's ID, or 0 if not found.
+/// @param latest_revision_id Set to the highest revision ID, or 0 if
+/// the page has no revisions.
+void ScanPage(const std::string& xml, uint64_t* page_id,
+              uint64_t* latest_revision_id);
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PAGE_SPLITTER_H_
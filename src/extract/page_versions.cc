@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "page_versions.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+
+namespace wikiopencite::citescoop {
+
+namespace {
+// Longest encoding of a 64-bit varint.
+const std::size_t kMaxVarintSize = 10;
+
+// Number of varints in a page version.
+const std::size_t kFieldCount = 5;
+
+/// @brief Write a varint to a buffer.
+/// @return End of the varint in the buffer.
+char* WriteVarint(uint64_t value, char* target) {
+  while (value >= 0x80) {
+    *target++ = static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  *target++ = static_cast<char>(value);
+  return target;
+}
+
+/// @brief Read a varint from a stream buffer.
+/// @return False if the buffer ended before the varint did.
+bool ReadVarint(std::streambuf* input, uint64_t* value) {
+  *value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    auto byte = input->sbumpc();
+    if (byte == std::streambuf::traits_type::eof()) {
+      return false;
+    }
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  throw std::runtime_error("Page versions hold a malformed varint");
+}
+}  // namespace
+
+void WritePageVersion(std::ostream* output, const PageVersion& version) {
+  auto buffer = std::array<char, kMaxVarintSize * kFieldCount>();
+  auto* end = WriteVarint(version.page_id, buffer.data());
+  end = WriteVarint(version.latest_revision_id, end);
+  end = WriteVarint(version.page_offset, end);
+  end = WriteVarint(version.revisions_offset, end);
+  end = WriteVarint(version.revision_count, end);
+  output->write(buffer.data(), end - buffer.data());
+}
+
+PageVersionIndex ReadPageVersions(std::istream* input) {
+  auto versions = PageVersionIndex();
+  auto* buffer = input->rdbuf();
+  while (buffer->sgetc() != std::streambuf::traits_type::eof()) {
+    auto version = PageVersion();
+    if (!ReadVarint(buffer, &version.page_id) ||
+        !ReadVarint(buffer, &version.latest_revision_id) ||
+        !ReadVarint(buffer, &version.page_offset) ||
+        !ReadVarint(buffer, &version.revisions_offset) ||
+        !ReadVarint(buffer, &version.revision_count)) {
+      throw std::runtime_error("Page versions are truncated");
+    }
+    versions.insert_or_assign(version.page_id, version);
+  }
+  return versions;
+}
+}  // namespace wikiopencite::citescoop
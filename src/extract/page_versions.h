@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PAGE_VERSIONS_H_
+#define SRC_EXTRACT_PAGE_VERSIONS_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Where an extraction wrote a page, and the revision of the
+/// page it was extracted at.
+struct PageVersion {
+  /// ID of the page
+  uint64_t page_id = 0;
+
+  /// Highest revision ID of the page in the dump
+  uint64_t latest_revision_id = 0;
+
+  /// Offset of the page's message in the pages output
+  uint64_t page_offset = 0;
+
+  /// Offset of the page's first revision in the revisions output
+  uint64_t revisions_offset = 0;
+
+  /// Number of revisions written after the page
+  uint64_t revision_count = 0;
+};
+
+/// @brief Page versions by page ID.
+using PageVersionIndex = boost::unordered_flat_map<uint64_t, PageVersion>;
+
+/// @brief Write a page version to a page versions stream.
+///
+/// Each page version is written as five varints, one per field of
+/// PageVersion in the order they are declared.
+///
+/// @param output Stream to write to.
+/// @param version Page version to write.
+void WritePageVersion(std::ostream* output, const PageVersion& version);
+
+/// @brief Read every page version of a page versions stream.
+///
+/// Will throw a std::runtime_error if the stream is truncated.
+///
+/// @param input Stream to read from.
+/// @return Page versions by page ID. If a page appears more than once,
+/// its last version is kept.
+PageVersionIndex ReadPageVersions(std::istream* input);
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PAGE_VERSIONS_H_
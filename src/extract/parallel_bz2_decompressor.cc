@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "parallel_bz2_decompressor.h"
+
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "boost/iostreams/categories.hpp"
+#include "boost/iostreams/device/array.hpp"
+#include "boost/iostreams/filter/bzip2.hpp"
+#include "boost/iostreams/filtering_streambuf.hpp"
+#include "citescoop/extract.h"
+
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+namespace bio = boost::iostreams;
+
+namespace {
+const uint64_t kBlockMagic = 0x314159265359;
+const uint64_t kEndOfStreamMagic = 0x177245385090;
+const unsigned int kMagicBits = 48;
+const uint64_t kMagicMask = (uint64_t{1} << kMagicBits) - 1;
+
+// Each block is followed by its 32 bit CRC. For a single block stream
+// the combined stream CRC is the same as the block CRC.
+const unsigned int kCrcBytes = 4;
+const unsigned int kCrcOffset = kMagicBits / 8;
+
+// Always declare the largest block size, it is only an upper bound.
+const char kStreamHeader[] = "BZh9";
+const char kEndOfStream[] = "\x17\x72\x45\x38\x50\x90";
+
+const std::streamsize kReadSize = 1 << 20;
+const unsigned int kBlocksPerWorker = 2;
+
+// Give up recovering a block after merging this many segments. Chance
+// magic numbers are rare enough that more than one in a row indicates
+// corrupt input.
+const int kMaxMergedSegments = 8;
+}  // namespace
+
+ParallelBz2Decompressor::ParallelBz2Decompressor(std::istream* input,
+                                                 unsigned int threads)
+    : input_(input), pool_(threads) {}
+
+ParallelBz2Decompressor::~ParallelBz2Decompressor() = default;
+
+ParallelBz2Decompressor::int_type ParallelBz2Decompressor::underflow() {
+  while (gptr() == egptr()) {
+    if (!NextBlock()) {
+      return traits_type::eof();
+    }
+  }
+
+  return traits_type::to_int_type(*gptr());
+}
+
+bool ParallelBz2Decompressor::NextBlock() {
+  FillPending();
+
+  // Skip the end of stream segments, they hold no data.
+  while (!pending_.empty() &&
+         pending_.front().type == SegmentType::kEndOfStream) {
+    pending_.pop_front();
+    FillPending();
+  }
+
+  if (pending_.empty()) {
+    return false;
+  }
+
+  auto result = pending_.front().result.get();
+  if (result.has_value()) {
+    block_ = std::move(result.value());
+    pending_.pop_front();
+  } else {
+    block_ = RecoverBlock();
+  }
+
+  setg(block_.data(), block_.data(), block_.data() + block_.size());
+  return true;
+}
+
+void ParallelBz2Decompressor::FillPending() {
+  const auto max_pending = pool_.size() * kBlocksPerWorker;
+  while (pending_.size() < max_pending) {
+    auto segment = Segment();
+    if (!ScanSegment(&segment)) {
+      return;
+    }
+
+    Submit(&segment);
+    pending_.push_back(std::move(segment));
+  }
+}
+
+void ParallelBz2Decompressor::Submit(Segment* segment) {
+  if (segment->type != SegmentType::kBlock) {
+    return;
+  }
+
+  segment->result =
+      pool_.Submit([stream = MakeStream(segment->bits, segment->length)]() {
+        return Decompress(stream);
+      });
+}
+
+std::string ParallelBz2Decompressor::RecoverBlock() {
+  auto merged = std::move(pending_.front());
+  pending_.pop_front();
+
+  for (int i = 0; i < kMaxMergedSegments; i++) {
+    if (pending_.empty()) {
+      FillPending();
+    }
+    if (pending_.empty()) {
+      break;
+    }
+
+    auto& next = pending_.front();
+    AppendBits(&merged.bits, &merged.length, next.bits, next.length);
+    pending_.pop_front();
+
+    auto result = Decompress(MakeStream(merged.bits, merged.length));
+    if (result.has_value()) {
+      return std::move(result.value());
+    }
+  }
+
+  throw DumpParseException("Failed to decompress bzip2 block");
+}
+
+bool ParallelBz2Decompressor::ScanSegment(Segment* segment) {
+  while (true) {
+    if (!boundaries_.empty()) {
+      auto boundary = boundaries_.front();
+      boundaries_.pop_front();
+
+      auto had_segment = in_segment_;
+      if (had_segment) {
+        CutSegment(segment, boundary.position);
+      }
+
+      in_segment_ = true;
+      segment_start_ = boundary.position;
+      segment_type_ = boundary.type;
+      if (had_segment) {
+        return true;
+      }
+      continue;
+    }
+
+    if (!ScanByte()) {
+      if (!in_segment_) {
+        return false;
+      }
+
+      CutSegment(segment, (buffer_start_ + buffer_.size()) * 8);
+      in_segment_ = false;
+      return true;
+    }
+  }
+}
+
+bool ParallelBz2Decompressor::ScanByte() {
+  if (scan_index_ == buffer_start_ + buffer_.size()) {
+    auto size = buffer_.size();
+    buffer_.resize(size + kReadSize);
+    input_->read(buffer_.data() + size, kReadSize);
+    buffer_.resize(size + static_cast<std::size_t>(input_->gcount()));
+
+    if (scan_index_ == buffer_start_ + buffer_.size()) {
+      return false;
+    }
+  }
+
+  window_ = (window_ << 8) |
+            static_cast<unsigned char>(buffer_[scan_index_ - buffer_start_]);
+  scan_index_++;
+
+  // Check every bit alignment of a magic number ending in this byte, in
+  // order of position.
+  for (unsigned int shift = 8; shift-- > 0;) {
+    auto end = scan_index_ * 8 - shift;
+    if (end < kMagicBits) {
+      continue;
+    }
+
+    auto candidate = (window_ >> shift) & kMagicMask;
+    if (candidate == kBlockMagic) {
+      boundaries_.push_back({end - kMagicBits, SegmentType::kBlock});
+    } else if (candidate == kEndOfStreamMagic) {
+      boundaries_.push_back({end - kMagicBits, SegmentType::kEndOfStream});
+    }
+  }
+
+  return true;
+}
+
+void ParallelBz2Decompressor::CutSegment(Segment* segment, uint64_t end) {
+  const auto first_byte = segment_start_ / 8 - buffer_start_;
+  const auto shift = static_cast<unsigned int>(segment_start_ % 8);
+  const auto length = end - segment_start_;
+  const auto bytes = static_cast<std::size_t>((length + 7) / 8);
+
+  segment->type = segment_type_;
+  segment->length = length;
+  segment->bits = std::string(bytes, '\0');
+  for (std::size_t i = 0; i < bytes; i++) {
+    auto index = static_cast<std::size_t>(first_byte) + i;
+    auto high = static_cast<unsigned char>(buffer_[index]);
+    auto byte = static_cast<unsigned int>(high) << shift;
+    if (shift != 0 && index + 1 < buffer_.size()) {
+      auto low = static_cast<unsigned char>(buffer_[index + 1]);
+      byte |= static_cast<unsigned int>(low) >> (8U - shift);
+    }
+    segment->bits[i] = static_cast<char>(byte);
+  }
+  if (length % 8 != 0) {
+    segment->bits.back() = static_cast<char>(
+        static_cast<unsigned char>(segment->bits.back()) &
+        (0xFF << (8 - length % 8)));
+  }
+
+  // Everything before the byte holding the end of this segment has now
+  // been consumed.
+  auto consumed = end / 8 - buffer_start_;
+  buffer_.erase(0, static_cast<std::size_t>(consumed));
+  buffer_start_ += consumed;
+}
+
+std::string ParallelBz2Decompressor::MakeStream(const std::string& bits,
+                                                uint64_t length) {
+  auto stream = std::string(kStreamHeader);
+  uint64_t stream_length = stream.size() * 8;
+
+  AppendBits(&stream, &stream_length, bits, length);
+  AppendBits(&stream, &stream_length, kEndOfStream, kMagicBits);
+  AppendBits(&stream, &stream_length, bits.substr(kCrcOffset, kCrcBytes),
+             kCrcBytes * 8);
+  return stream;
+}
+
+std::optional<std::string> ParallelBz2Decompressor::Decompress(
+    const std::string& stream) {
+  try {
+    bio::filtering_streambuf<bio::input> decompression_stream;
+    decompression_stream.push(bio::bzip2_decompressor());
+    decompression_stream.push(bio::array_source(stream.data(), stream.size()));
+
+    return std::string(std::istreambuf_iterator<char>(&decompression_stream),
+                       std::istreambuf_iterator<char>());
+  } catch (const std::ios_base::failure&) {
+    return std::nullopt;
+  }
+}
+
+void ParallelBz2Decompressor::AppendBits(std::string* output,
+                                         uint64_t* output_length,
+                                         const std::string& bits,
+                                         uint64_t length) {
+  const auto shift = static_cast<unsigned int>(*output_length % 8);
+  const auto bytes = static_cast<std::size_t>((length + 7) / 8);
+
+  if (shift == 0) {
+    output->append(bits, 0, bytes);
+  } else {
+    for (std::size_t i = 0; i < bytes; i++) {
+      auto byte = static_cast<unsigned char>(bits[i]);
+      output->back() = static_cast<char>(
+          static_cast<unsigned char>(output->back()) | (byte >> shift));
+      output->push_back(static_cast<char>(byte << (8U - shift)));
+    }
+  }
+
+  // Drop any bytes and bits past the end of the appended run.
+  *output_length += length;
+  output->resize(static_cast<std::size_t>((*output_length + 7) / 8));
+  if (*output_length % 8 != 0) {
+    output->back() = static_cast<char>(
+        static_cast<unsigned char>(output->back()) &
+        (0xFF << (8 - *output_length % 8)));
+  }
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PARALLEL_BZ2_DECOMPRESSOR_H_
+#define SRC_EXTRACT_PARALLEL_BZ2_DECOMPRESSOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <istream>
+#include <optional>
+#include <streambuf>
+#include <string>
+
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Stream buffer decompressing bzip2 data on multiple threads.
+///
+/// bzip2 compresses data in independent blocks of up to 900kB, each
+/// starting with the bit-aligned magic number 0x314159265359 (and each
+/// stream ending with 0x177245385090). This scans the compressed input
+/// for those magic numbers, wraps every block in a stream of its own
+/// and decompresses the blocks on a worker pool. The decompressed
+/// blocks are then read back in their original order.
+///
+/// As the magic numbers may also occur by chance inside compressed
+/// data, a block that fails to decompress is merged with the segments
+/// following it until it decompresses successfully.
+class ParallelBz2Decompressor : public std::streambuf {
+ public:
+  /// @brief Construct a new parallel decompressor.
+  /// @param input Stream of bzip2 compressed data. May hold several
+  /// concatenated bzip2 streams.
+  /// @param threads Number of decompression threads to use. If 0, one
+  /// thread per hardware thread is used.
+  ParallelBz2Decompressor(std::istream* input, unsigned int threads);
+
+  ~ParallelBz2Decompressor() override;
+
+  ParallelBz2Decompressor(const ParallelBz2Decompressor&) = delete;
+  ParallelBz2Decompressor& operator=(const ParallelBz2Decompressor&) = delete;
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  /// @brief Type of magic number a segment starts with.
+  enum class SegmentType { kBlock, kEndOfStream };
+
+  /// @brief A run of compressed bits from one magic number up to the
+  /// next.
+  struct Segment {
+    /// Magic number the segment starts with
+    SegmentType type;
+
+    /// Segment bits, packed most significant bit first
+    std::string bits;
+
+    /// Number of bits in the segment
+    uint64_t length;
+
+    /// Decompressed block, empty if the segment is not a block
+    std::future<std::optional<std::string>> result;
+  };
+
+  /// @brief A magic number found in the input.
+  struct Boundary {
+    /// Absolute bit position of the magic number
+    uint64_t position;
+
+    /// Magic number found
+    SegmentType type;
+  };
+
+  std::istream* input_;
+  WorkerPool pool_;
+  std::deque<Segment> pending_;
+  std::string block_;
+
+  // Scanner state
+  std::string buffer_;
+  uint64_t buffer_start_ = 0;
+  uint64_t scan_index_ = 0;
+  uint64_t window_ = 0;
+  std::deque<Boundary> boundaries_;
+  bool in_segment_ = false;
+  uint64_t segment_start_ = 0;
+  SegmentType segment_type_ = SegmentType::kBlock;
+
+  /// @brief Scan the input up to the end of the next segment.
+  /// @param segment Segment to populate.
+  /// @return False once the input is exhausted.
+  bool ScanSegment(Segment* segment);
+
+  /// @brief Scan the next byte of input for magic numbers.
+  /// @return False once the input is exhausted.
+  bool ScanByte();
+
+  /// @brief Copy a run of bits out of the input buffer.
+  /// @param segment Segment to populate.
+  /// @param end Absolute bit position the segment ends at.
+  void CutSegment(Segment* segment, uint64_t end);
+
+  /// @brief Scan segments and submit blocks until enough are in flight.
+  void FillPending();
+
+  /// @brief Move on to the next decompressed block.
+  /// @return False once all blocks have been read.
+  bool NextBlock();
+
+  /// @brief Recover a block that failed to decompress by merging it
+  /// with the segments that follow it.
+  ///
+  /// Will throw a DumpParseException if the block cannot be recovered.
+  ///
+  /// @return The decompressed block.
+  std::string RecoverBlock();
+
+  /// @brief Submit a segment to be decompressed if it is a block.
+  /// @param segment Segment to submit.
+  void Submit(Segment* segment);
+
+  /// @brief Wrap a block in a standalone single block bzip2 stream.
+  /// @param bits Block bits, starting at the block magic number.
+  /// @param length Number of bits in the block.
+  /// @return A complete bzip2 stream.
+  static std::string MakeStream(const std::string& bits, uint64_t length);
+
+  /// @brief Decompress a complete bzip2 stream.
+  /// @param stream Stream to decompress.
+  /// @return Decompressed data, or nothing if the data is invalid.
+  static std::optional<std::string> Decompress(const std::string& stream);
+
+  /// @brief Append a run of bits to a packed bit string.
+  /// @param output Bit string to append to.
+  /// @param output_length Number of bits in output.
+  /// @param bits Bits to append, packed most significant bit first.
+  /// @param length Number of bits to append.
+  static void AppendBits(std::string* output, uint64_t* output_length,
+                         const std::string& bits, uint64_t length);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PARALLEL_BZ2_DECOMPRESSOR_H_
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "parallel_zstd_decompressor.h"
+
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "boost/iostreams/categories.hpp"
+#include "boost/iostreams/device/array.hpp"
+#include "boost/iostreams/filter/zstd.hpp"
+#include "boost/iostreams/filtering_streambuf.hpp"
+#include "citescoop/extract.h"
+
+#include "worker_pool.h"
+#include "zstd_seek_table.h"
+
+namespace wikiopencite::citescoop {
+namespace bio = boost::iostreams;
+
+namespace {
+const unsigned int kFramesPerWorker = 2;
+}  // namespace
+
+ParallelZstdDecompressor::ParallelZstdDecompressor(std::istream* input,
+                                                   ZstdSeekTable seek_table,
+                                                   unsigned int threads)
+    : input_(input), seek_table_(std::move(seek_table)), pool_(threads) {}
+
+ParallelZstdDecompressor::~ParallelZstdDecompressor() = default;
+
+ParallelZstdDecompressor::int_type ParallelZstdDecompressor::underflow() {
+  while (gptr() == egptr()) {
+    if (!NextFrame()) {
+      return traits_type::eof();
+    }
+  }
+
+  return traits_type::to_int_type(*gptr());
+}
+
+bool ParallelZstdDecompressor::NextFrame() {
+  FillPending();
+  if (pending_.empty()) {
+    return false;
+  }
+
+  frame_ = pending_.front().get();
+  pending_.pop_front();
+
+  setg(frame_.data(), frame_.data(), frame_.data() + frame_.size());
+  return true;
+}
+
+void ParallelZstdDecompressor::FillPending() {
+  const auto& frames = seek_table_.frames();
+  const auto max_pending = pool_.size() * kFramesPerWorker;
+  while (pending_.size() < max_pending && next_frame_ < frames.size()) {
+    auto frame = frames[next_frame_++];
+    auto compressed = std::string(frame.compressed_size, '\0');
+    input_->read(compressed.data(), frame.compressed_size);
+    if (input_->gcount() != frame.compressed_size) {
+      throw DumpParseException("Unexpected end of zstd stream");
+    }
+
+    pending_.push_back(
+        pool_.Submit([compressed = std::move(compressed), frame]() {
+          return Decompress(compressed, frame);
+        }));
+  }
+}
+
+std::string ParallelZstdDecompressor::Decompress(const std::string& compressed,
+                                                 ZstdFrame frame) {
+  auto decompressed = std::string();
+  decompressed.reserve(frame.decompressed_size);
+
+  try {
+    bio::filtering_streambuf<bio::input> decompression_stream;
+    decompression_stream.push(bio::zstd_decompressor());
+    decompression_stream.push(
+        bio::array_source(compressed.data(), compressed.size()));
+
+    decompressed.append(
+        std::istreambuf_iterator<char>(&decompression_stream),
+        std::istreambuf_iterator<char>());
+  } catch (const std::ios_base::failure&) {
+    throw DumpParseException("Failed to decompress zstd frame");
+  }
+
+  if (decompressed.size() != frame.decompressed_size) {
+    throw DumpParseException("zstd frame does not match seek table");
+  }
+
+  return decompressed;
+}
+}  // namespace wikiopencite::citescoop
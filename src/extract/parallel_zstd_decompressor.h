@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PARALLEL_ZSTD_DECOMPRESSOR_H_
+#define SRC_EXTRACT_PARALLEL_ZSTD_DECOMPRESSOR_H_
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <istream>
+#include <streambuf>
+#include <string>
+
+#include "worker_pool.h"
+#include "zstd_seek_table.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Stream buffer decompressing seekable zstd data on multiple
+/// threads.
+///
+/// The frames of a seekable zstd stream are compressed independently,
+/// and the seek table gives the size of each. This reads the frames
+/// sequentially, decompresses them on a worker pool and then reads the
+/// decompressed frames back in their original order.
+class ParallelZstdDecompressor : public std::streambuf {
+ public:
+  /// @brief Construct a new parallel decompressor.
+  /// @param input Stream of seekable zstd data, positioned at the start
+  /// of the first frame.
+  /// @param seek_table Seek table of the input.
+  /// @param threads Number of decompression threads to use. If 0, one
+  /// thread per hardware thread is used.
+  ParallelZstdDecompressor(std::istream* input, ZstdSeekTable seek_table,
+                           unsigned int threads);
+
+  ~ParallelZstdDecompressor() override;
+
+  ParallelZstdDecompressor(const ParallelZstdDecompressor&) = delete;
+  ParallelZstdDecompressor& operator=(const ParallelZstdDecompressor&) =
+      delete;
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  std::istream* input_;
+  ZstdSeekTable seek_table_;
+  WorkerPool pool_;
+  std::size_t next_frame_ = 0;
+  std::deque<std::future<std::string>> pending_;
+  std::string frame_;
+
+  /// @brief Read frames and submit them until enough are in flight.
+  void FillPending();
+
+  /// @brief Move on to the next decompressed frame.
+  /// @return False once all frames have been read.
+  bool NextFrame();
+
+  /// @brief Decompress a single frame.
+  ///
+  /// Will throw a DumpParseException if the frame is invalid or does
+  /// not match the seek table.
+  ///
+  /// @param compressed The compressed frame.
+  /// @param frame Seek table entry of the frame.
+  /// @return The decompressed frame.
+  static std::string Decompress(const std::string& compressed,
+                                ZstdFrame frame);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PARALLEL_ZSTD_DECOMPRESSOR_H_
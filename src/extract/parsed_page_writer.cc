@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "parsed_page_writer.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+
+#include "citescoop/extract.h"
+#include "citescoop/io.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "collecting_dump_parser.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+ParsedPageWriter::ParsedPageWriter(std::ostream* pages_output,
+                                   std::ostream* revisions_output,
+                                   RevisionEncoding revision_encoding)
+    : page_writer_(pages_output), revision_writer_(revisions_output) {
+  if (revision_encoding == RevisionEncoding::kCompact) {
+    compact_writer_ = std::make_unique<CompactRevisionWriter>(revisions_output);
+  }
+}
+
+void ParsedPageWriter::Write(const ParsedPage& parsed) {
+  WritePage(parsed.page);
+
+  for (const auto& [unused, revision] : parsed.revisions) {
+    WriteRevision(revision);
+    revisions_written_++;
+  }
+}
+
+void ParsedPageWriter::Write(
+    const proto::Page& page,
+    const std::map<uint64_t, const proto::Revision*>& revisions) {
+  WritePage(page);
+
+  for (const auto& [unused, revision] : revisions) {
+    WriteRevision(*revision);
+    revisions_written_++;
+  }
+}
+
+void ParsedPageWriter::Flush() {
+  if (compact_writer_ != nullptr) {
+    revision_bytes_written_ += compact_writer_->Flush();
+  }
+}
+
+void ParsedPageWriter::WritePage(const proto::Page& page) {
+  page_bytes_written_ += page_writer_.WriteMessage(page) + sizeof(uint32_t);
+  pages_written_++;
+}
+
+void ParsedPageWriter::WriteRevision(const proto::Revision& revision) {
+  if (compact_writer_ != nullptr) {
+    revision_bytes_written_ += compact_writer_->WriteRevision(revision);
+  } else {
+    revision_bytes_written_ +=
+        revision_writer_.WriteMessage(revision) + sizeof(uint32_t);
+  }
+}
+}  // namespace wikiopencite::citescoop
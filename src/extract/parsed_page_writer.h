@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PARSED_PAGE_WRITER_H_
+#define SRC_EXTRACT_PARSED_PAGE_WRITER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <utility>
+
+#include "citescoop/extract.h"
+#include "citescoop/io.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "collecting_dump_parser.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Write parsed pages to PBF formatted output streams.
+///
+/// Pages and revisions are written in exactly the same layout as the
+/// StreamingDumpParser writes them. Compact revisions are buffered, so
+/// the writer must be flushed once every page has been written.
+class ParsedPageWriter {
+ public:
+  /// @brief Construct a new writer.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param revision_encoding Encoding to write revisions in.
+  ParsedPageWriter(
+      std::ostream* pages_output, std::ostream* revisions_output,
+      RevisionEncoding revision_encoding = RevisionEncoding::kMessages);
+
+  /// @brief Write a page followed by its revisions.
+  /// @param parsed Page to write.
+  void Write(const ParsedPage& parsed);
+
+  /// @brief Write a page followed by its revisions.
+  /// @param page Page to write.
+  /// @param revisions Revisions referenced by the page, by revision ID.
+  void Write(
+      const wikiopencite::proto::Page& page,
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>&
+          revisions);
+
+  /// @brief Write any buffered revisions.
+  ///
+  /// Will throw std::runtime_error if they could not be written.
+  void Flush();
+
+  /// @brief Get the number of messages written.
+  /// @return Number of pages written followed by the number of
+  /// revisions written.
+  std::pair<uint64_t, uint64_t> counts() const {
+    return {pages_written_, revisions_written_};
+  }
+
+  /// @brief Get the number of bytes written to each output stream.
+  /// @return Bytes written to the pages output followed by bytes written
+  /// to the revisions output. Buffered compact revisions are only
+  /// counted once their block has been written.
+  std::pair<uint64_t, uint64_t> bytes_written() const {
+    return {page_bytes_written_, revision_bytes_written_};
+  }
+
+ private:
+  uint64_t pages_written_ = 0;
+  uint64_t revisions_written_ = 0;
+  uint64_t page_bytes_written_ = 0;
+  uint64_t revision_bytes_written_ = 0;
+  MessageWriter page_writer_;
+  MessageWriter revision_writer_;
+
+  // Only set when writing compact revisions.
+  std::unique_ptr<CompactRevisionWriter> compact_writer_;
+
+  /// @brief Write a page message.
+  /// @param page Page to write.
+  void WritePage(const wikiopencite::proto::Page& page);
+
+  /// @brief Write a revision in the writer's encoding.
+  /// @param revision Revision to write.
+  void WriteRevision(const wikiopencite::proto::Revision& revision);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PARSED_PAGE_WRITER_H_
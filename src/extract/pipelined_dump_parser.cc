@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pipelined_dump_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "bounded_queue.h"
+#include "collecting_dump_parser.h"
+#include "dump_parser.h"
+#include "page_splitter.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+// Target size of a batch of pages. Large enough to amortise the cost
+// of a task over many small pages, while big pages get a batch each.
+const std::size_t kBatchSize = 1 << 20;
+
+// Number of batches to keep queued and in flight per worker.
+const unsigned int kBatchesPerWorker = 2;
+}  // namespace
+
+PipelinedDumpParser::PipelinedDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : parser_(std::move(parser)), options_(options) {}
+
+void PipelinedDumpParser::Parse(
+    std::istream& input, const std::function<void(ParsedPage&&)>& sink,
+    const std::function<void(uint64_t)>& on_batch) {
+  auto pool = WorkerPool(options_.threads);
+  auto revision_pool = MakeRevisionPool(options_);
+  const auto max_pending = pool.size() * kBatchesPerWorker;
+
+  auto batches = BoundedQueue<std::string>(max_pending);
+  std::exception_ptr read_error;
+  auto reader = std::jthread(ReadBatches, &input, &batches, &read_error);
+
+  // Offset in the input just past each pending batch. Batches are
+  // only taken in the order they were submitted when the page order is
+  // preserved, so these only line up with them then.
+  auto pending = std::deque<std::future<std::vector<ParsedPage>>>();
+  auto batch_ends = std::deque<uint64_t>();
+  uint64_t input_offset = 0;
+  auto drain = [this, &pending, &batch_ends, &sink, &on_batch]() {
+    auto pages = TakeCompleted(&pending, options_.preserve_order);
+    for (auto& page : pages) {
+      sink(std::move(page));
+    }
+
+    auto batch_end = batch_ends.front();
+    batch_ends.pop_front();
+    if (on_batch && options_.preserve_order) {
+      on_batch(batch_end);
+    }
+  };
+
+  try {
+    while (auto batch = batches.Pop()) {
+      input_offset += batch->size();
+      batch_ends.push_back(input_offset);
+      pending.push_back(pool.Submit(
+          [this, revision_pool, batch = std::move(*batch)]() {
+            auto xml_parser =
+                CollectingDumpParser(parser_, options_, revision_pool);
+            return xml_parser.ParseFragment(batch);
+          }));
+
+      while (pending.size() >= max_pending) {
+        drain();
+      }
+    }
+
+    while (!pending.empty()) {
+      drain();
+    }
+  } catch (...) {
+    // Unblock the reader so that it can be joined.
+    batches.Close();
+    throw;
+  }
+
+  reader.join();
+  if (read_error) {
+    std::rethrow_exception(read_error);
+  }
+}
+
+void PipelinedDumpParser::ReadBatches(std::istream* input,
+                                      BoundedQueue<std::string>* batches,
+                                      std::exception_ptr* error) {
+  try {
+    auto splitter = PageSplitter(input);
+    auto batch = std::string();
+    while (splitter.NextBatch(kBatchSize, &batch)) {
+      if (!batches->Push(std::move(batch))) {
+        return;
+      }
+      batch = std::string();
+    }
+  } catch (...) {
+    *error = std::current_exception();
+  }
+
+  batches->Close();
+}
+}  // namespace wikiopencite::citescoop
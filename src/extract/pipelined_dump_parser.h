@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_PIPELINED_DUMP_PARSER_H_
+#define SRC_EXTRACT_PIPELINED_DUMP_PARSER_H_
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "bounded_queue.h"
+#include "collecting_dump_parser.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief MediaWiki XML dump parser running page parsing in parallel.
+///
+/// The dump is processed in three stages:
+///  1. A reader thread cuts the XML into batches of whole pages.
+///  2. A worker pool parses each batch with its own
+///     CollectingDumpParser, so citation parsing and lifecycle tracking
+///     are spread across cores.
+///  3. The calling thread reorders the parsed pages back into dump
+///     order (unless configured otherwise) and hands them to the sink.
+///
+/// The stages are connected by bounded queues, so memory use is capped
+/// at a small number of batches per worker.
+class PipelinedDumpParser {
+ public:
+  /// @brief Construct a new pipelined dump parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options, controlling the number of
+  /// workers and whether the page order is preserved.
+  PipelinedDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                      ExtractorOptions options);
+
+  /// @brief Parse the dump XML.
+  /// @param input An input stream of plain XML. NOTE: if you are
+  /// dealing with a compressed dump, this must have already been
+  /// decompressed by this point.
+  /// @param sink Called on the calling thread with each parsed page.
+  /// @param on_batch Called on the calling thread once every page of a
+  /// batch has been handed to the sink, with the offset in the input
+  /// just past the batch. Only called when the page order is preserved.
+  /// May be null.
+  void Parse(std::istream& input,
+             const std::function<void(ParsedPage&&)>& sink,
+             const std::function<void(uint64_t)>& on_batch = nullptr);
+
+ private:
+  std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
+  ExtractorOptions options_;
+
+  /// @brief Reader stage, splits the input into batches of pages.
+  /// @param input An input stream of plain XML.
+  /// @param batches Queue to push batches to. Closed once the input is
+  /// exhausted.
+  /// @param error Set if reading the input fails.
+  static void ReadBatches(std::istream* input,
+                          BoundedQueue<std::string>* batches,
+                          std::exception_ptr* error);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_PIPELINED_DUMP_PARSER_H_
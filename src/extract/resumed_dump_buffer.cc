@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "resumed_dump_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <streambuf>
+#include <string_view>
+
+#include "citescoop/extract.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+const std::string_view kDocumentStart = "<mediawiki>";
+const std::size_t kReadSize = 1 << 20;
+}  // namespace
+
+void SkipDumpInput(std::istream* input, uint64_t offset) {
+  input->ignore(static_cast<std::streamsize>(offset));
+  if (static_cast<uint64_t>(input->gcount()) != offset) {
+    throw DumpParseException("Dump ends before the checkpoint");
+  }
+}
+
+ResumedDumpBuffer::ResumedDumpBuffer(std::istream* input, uint64_t offset)
+    : input_(input),
+      offset_(offset),
+      buffer_(kDocumentStart.begin(), kDocumentStart.end()) {
+  SkipDumpInput(input_, offset_);
+  setg(buffer_.data(), buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+uint64_t ResumedDumpBuffer::DumpOffset(uint64_t offset) const {
+  return offset_ + offset - kDocumentStart.size();
+}
+
+ResumedDumpBuffer::int_type ResumedDumpBuffer::underflow() {
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  buffer_.resize(kReadSize);
+  input_->read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  auto read = static_cast<std::size_t>(input_->gcount());
+  if (read == 0) {
+    return traits_type::eof();
+  }
+
+  setg(buffer_.data(), buffer_.data(), buffer_.data() + read);
+  return traits_type::to_int_type(*gptr());
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_RESUMED_DUMP_BUFFER_H_
+#define SRC_EXTRACT_RESUMED_DUMP_BUFFER_H_
+
+#include <cstdint>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Skip the start of a dump.
+///
+/// Will throw a DumpParseException if the dump ends first.
+///
+/// @param input Stream of plain dump XML.
+/// @param offset Number of bytes to skip.
+void SkipDumpInput(std::istream* input, uint64_t offset);
+
+/// @brief Stream buffer of a dump resumed part way through.
+///
+/// The dump is skipped up to the offset to resume from, which must be
+/// between two pages. As the parsers expect pages to be inside the
+/// document's root element, a root start tag is read before the rest of
+/// the dump.
+class ResumedDumpBuffer : public std::streambuf {
+ public:
+  /// @brief Construct a new resumed dump buffer.
+  /// @param input Stream of plain dump XML, read from the start.
+  /// @param offset Offset in the dump to resume from.
+  ResumedDumpBuffer(std::istream* input, uint64_t offset);
+
+  /// @brief Convert an offset in this buffer to an offset in the dump.
+  /// @param offset Offset in this buffer, past the root start tag.
+  /// @return Offset in the dump.
+  uint64_t DumpOffset(uint64_t offset) const;
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  std::istream* input_;
+  uint64_t offset_;
+  std::vector<char> buffer_;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_RESUMED_DUMP_BUFFER_H_
@@ -0,0 +1,223 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "reusing_dump_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "collecting_dump_parser.h"
+#include "dump_parser.h"
+#include "extraction_merger.h"
+#include "page_splitter.h"
+#include "page_versions.h"
+#include "parsed_page_writer.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+// Target size of a batch of changed pages, as for the pipelined parser.
+const std::size_t kBatchSize = 1 << 20;
+
+// Number of batches to keep in flight per worker.
+const unsigned int kBatchesPerWorker = 2;
+
+// Most pages to hold waiting behind a batch that is still being
+// parsed.
+const std::size_t kMaxPendingPages = 1 << 16;
+
+// Position of a previous extraction's stream before its first seek.
+const uint64_t kUnknownPosition = UINT64_MAX;
+}  // namespace
+
+ReusingDumpParser::ReusingDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : parser_(std::move(parser)), options_(std::move(options)) {}
+
+std::pair<uint64_t, uint64_t> ReusingDumpParser::Parse(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  previous_ = previous;
+  previous_versions_ = previous.page_versions != nullptr
+                           ? ReadPageVersions(previous.page_versions)
+                           : PageVersionIndex();
+  previous_pages_position_ = kUnknownPosition;
+  previous_revisions_position_ = kUnknownPosition;
+  pages_output_ = pages_output;
+  revisions_output_ = revisions_output;
+  page_versions_output_ = page_versions_output;
+  writer_ = std::make_unique<ParsedPageWriter>(pages_output, revisions_output);
+  page_bytes_copied_ = revision_bytes_copied_ = 0;
+  pages_copied_ = revisions_copied_ = 0;
+
+  revision_pool_ = MakeRevisionPool(options_);
+  if (options_.pipeline) {
+    pool_ = std::make_unique<WorkerPool>(options_.threads);
+  } else {
+    xml_parser_ = std::make_unique<CollectingDumpParser>(parser_, options_,
+                                                         revision_pool_);
+  }
+  const auto max_batches =
+      pool_ != nullptr ? pool_->size() * kBatchesPerWorker : 1;
+  pending_.clear();
+  open_batch_.reset();
+  batches_in_flight_ = 0;
+
+  auto splitter = PageSplitter(&input);
+  auto page_xml = std::string();
+  while (splitter.NextBatch(1, &page_xml)) {
+    uint64_t page_id = 0;
+    uint64_t latest_revision_id = 0;
+    ScanPage(page_xml, &page_id, &latest_revision_id);
+
+    auto version = previous_versions_.find(page_id);
+    if (latest_revision_id != 0 && version != previous_versions_.end() &&
+        version->second.latest_revision_id == latest_revision_id) {
+      pending_.push_back({page_id, latest_revision_id, &version->second, {}});
+    } else {
+      if (open_batch_ == nullptr) {
+        open_batch_ = std::make_shared<Batch>();
+      }
+      open_batch_->xml.append(page_xml);
+      pending_.push_back({page_id, latest_revision_id, nullptr, open_batch_});
+      if (open_batch_->xml.size() >= kBatchSize) {
+        Submit(open_batch_.get());
+      }
+    }
+
+    while (pending_.size() > kMaxPendingPages ||
+           batches_in_flight_ >= max_batches) {
+      WriteNext();
+    }
+  }
+
+  while (!pending_.empty()) {
+    WriteNext();
+  }
+  writer_->Flush();
+
+  auto [pages_written, revisions_written] = writer_->counts();
+  return {pages_copied_ + pages_written, revisions_copied_ + revisions_written};
+}
+
+void ReusingDumpParser::Submit(Batch* batch) {
+  if (open_batch_.get() == batch) {
+    open_batch_.reset();
+  }
+  batch->submitted = true;
+  batches_in_flight_++;
+
+  auto xml = std::move(batch->xml);
+  if (pool_ != nullptr) {
+    batch->result = pool_->Submit(
+        [this, revision_pool = revision_pool_, xml = std::move(xml)]() {
+          auto xml_parser =
+              CollectingDumpParser(parser_, options_, revision_pool);
+          return xml_parser.ParseFragment(xml);
+        });
+  } else {
+    // Parsed when its first page is written, on the calling thread.
+    batch->result =
+        std::async(std::launch::deferred, [this, xml = std::move(xml)]() {
+          return xml_parser_->ParseFragment(xml);
+        });
+  }
+}
+
+void ReusingDumpParser::WriteNext() {
+  auto page = std::move(pending_.front());
+  pending_.pop_front();
+  if (page.previous != nullptr) {
+    CopyPrevious(*page.previous);
+    return;
+  }
+
+  auto& batch = *page.batch;
+  if (!batch.submitted) {
+    Submit(&batch);
+  }
+  if (!batch.taken) {
+    batch.pages = batch.result.get();
+    batch.taken = true;
+    batches_in_flight_--;
+  }
+
+  // Pages skipped by the page filter are missing from the batch.
+  if (batch.next_page < batch.pages.size() &&
+      batch.pages[batch.next_page].page.page_id() == page.page_id) {
+    const auto& parsed = batch.pages[batch.next_page++];
+    WriteVersion(page.page_id, page.latest_revision_id,
+                 parsed.revisions.size());
+    writer_->Write(parsed);
+  }
+}
+
+void ReusingDumpParser::CopyPrevious(const PageVersion& version) {
+  WriteVersion(version.page_id, version.latest_revision_id,
+               version.revision_count);
+
+  SeekPrevious(previous_.pages, &previous_pages_position_,
+               version.page_offset);
+  if (!ExtractionMerger::ReadRaw(previous_.pages, &message_)) {
+    throw std::runtime_error("Previous pages end before a page version");
+  }
+  previous_pages_position_ += sizeof(uint32_t) + message_.size();
+  ExtractionMerger::WriteRaw(pages_output_, message_);
+  page_bytes_copied_ += sizeof(uint32_t) + message_.size();
+  pages_copied_++;
+
+  if (version.revision_count == 0) {
+    return;
+  }
+  SeekPrevious(previous_.revisions, &previous_revisions_position_,
+               version.revisions_offset);
+  for (uint64_t i = 0; i < version.revision_count; i++) {
+    if (!ExtractionMerger::ReadRaw(previous_.revisions, &message_)) {
+      throw std::runtime_error("Previous revisions end before their page");
+    }
+    previous_revisions_position_ += sizeof(uint32_t) + message_.size();
+    ExtractionMerger::WriteRaw(revisions_output_, message_);
+    revision_bytes_copied_ += sizeof(uint32_t) + message_.size();
+    revisions_copied_++;
+  }
+}
+
+void ReusingDumpParser::WriteVersion(uint64_t page_id,
+                                     uint64_t latest_revision_id,
+                                     uint64_t revision_count) {
+  auto [page_bytes, revision_bytes] = writer_->bytes_written();
+  WritePageVersion(page_versions_output_,
+                   {.page_id = page_id,
+                    .latest_revision_id = latest_revision_id,
+                    .page_offset = page_bytes_copied_ + page_bytes,
+                    .revisions_offset = revision_bytes_copied_ + revision_bytes,
+                    .revision_count = revision_count});
+}
+
+void ReusingDumpParser::SeekPrevious(std::istream* input, uint64_t* position,
+                                     uint64_t offset) {
+  if (*position == offset) {
+    return;
+  }
+  input->clear();
+  input->seekg(static_cast<std::streamoff>(offset));
+  if (!*input) {
+    throw std::runtime_error("Could not seek previous extraction");
+  }
+  *position = offset;
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_REUSING_DUMP_PARSER_H_
+#define SRC_EXTRACT_REUSING_DUMP_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+
+#include "collecting_dump_parser.h"
+#include "page_versions.h"
+#include "parsed_page_writer.h"
+#include "worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief MediaWiki XML dump parser reusing the results of an earlier
+/// extraction for pages that haven't changed.
+///
+/// The dump is cut into whole pages, and the page ID and highest
+/// revision ID of each are found with plain substring searches. A page
+/// the previous extraction holds at the same revision is copied from
+/// its outputs, found through its page versions. The other pages are
+/// gathered into batches and parsed by CollectingDumpParser, on a
+/// worker pool if ExtractorOptions::pipeline is set. Pages are written
+/// in dump order, whichever way they were produced.
+class ReusingDumpParser {
+ public:
+  /// @brief Construct a new reusing dump parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options to configure the parser with.
+  ReusingDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                    ExtractorOptions options);
+
+  /// @brief Parse the dump XML.
+  ///
+  /// Will throw a std::runtime_error if the previous extraction is
+  /// truncated.
+  ///
+  /// @param input An input stream of plain XML. NOTE: if you are
+  /// dealing with a compressed dump, this must have already been
+  /// decompressed by this point.
+  /// @param previous Outputs of the previous extraction, each null if
+  /// there is none.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return Number of pages written followed by the number of
+  /// revisions written.
+  std::pair<uint64_t, uint64_t> Parse(std::istream& input,
+                                      const PreviousExtraction& previous,
+                                      std::ostream* pages_output,
+                                      std::ostream* revisions_output,
+                                      std::ostream* page_versions_output);
+
+ private:
+  /// @brief Changed pages parsed together.
+  struct Batch {
+    /// XML of the pages, until the batch is submitted
+    std::string xml;
+
+    /// Set once the batch has been submitted
+    bool submitted = false;
+
+    /// Parsed pages, once submitted
+    std::future<std::vector<ParsedPage>> result;
+
+    /// Parsed pages, once taken from the result
+    std::vector<ParsedPage> pages;
+
+    /// Set once the parsed pages have been taken from the result
+    bool taken = false;
+
+    /// Next of the parsed pages to write
+    std::size_t next_page = 0;
+  };
+
+  /// @brief A page waiting to be written.
+  struct PendingPage {
+    /// ID of the page
+    uint64_t page_id;
+
+    /// Highest revision ID of the page in the dump
+    uint64_t latest_revision_id;
+
+    /// Version of the page in the previous extraction to copy, or null
+    /// if the page has changed
+    const PageVersion* previous;
+
+    /// Batch the page is parsed in if it has changed
+    std::shared_ptr<Batch> batch;
+  };
+
+  std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
+  ExtractorOptions options_;
+
+  // State of the current parse.
+  PreviousExtraction previous_;
+  PageVersionIndex previous_versions_;
+  uint64_t previous_pages_position_ = 0;
+  uint64_t previous_revisions_position_ = 0;
+  std::ostream* pages_output_ = nullptr;
+  std::ostream* revisions_output_ = nullptr;
+  std::ostream* page_versions_output_ = nullptr;
+  std::unique_ptr<ParsedPageWriter> writer_;
+  uint64_t page_bytes_copied_ = 0;
+  uint64_t revision_bytes_copied_ = 0;
+  uint64_t pages_copied_ = 0;
+  uint64_t revisions_copied_ = 0;
+  std::string message_;
+
+  // Pages are parsed on the pool if set, otherwise on the calling
+  // thread with the one parser.
+  std::unique_ptr<WorkerPool> pool_;
+  std::shared_ptr<WorkerPool> revision_pool_;
+  std::unique_ptr<CollectingDumpParser> xml_parser_;
+  std::deque<PendingPage> pending_;
+  std::shared_ptr<Batch> open_batch_;
+  std::size_t batches_in_flight_ = 0;
+
+  /// @brief Start parsing a batch.
+  /// @param batch Batch to submit.
+  void Submit(Batch* batch);
+
+  /// @brief Write the oldest pending page.
+  void WriteNext();
+
+  /// @brief Copy a page and its revisions from the previous extraction.
+  /// @param version Version of the page in the previous extraction.
+  void CopyPrevious(const PageVersion& version);
+
+  /// @brief Write a page version for the page about to be written.
+  /// @param page_id ID of the page.
+  /// @param latest_revision_id Highest revision ID of the page.
+  /// @param revision_count Number of revisions written after the page.
+  void WriteVersion(uint64_t page_id, uint64_t latest_revision_id,
+                    uint64_t revision_count);
+
+  /// @brief Seek a stream of the previous extraction, unless it is
+  /// already there.
+  /// @param input Stream to seek.
+  /// @param position Current position of the stream, updated.
+  /// @param offset Offset to seek to.
+  static void SeekPrevious(std::istream* input, uint64_t* position,
+                           uint64_t offset);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_REUSING_DUMP_PARSER_H_
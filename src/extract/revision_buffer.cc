@@ -0,0 +1,223 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "revision_buffer.h"
+
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "citescoop/io.h"
+#include "citescoop/proto/revision_citations.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/timestamp.pb.h"
+
+#include "temporary_file.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+namespace {
+/// Fewest bytes of a run to read from the temporary file at once.
+const std::size_t kMinimumReadSize = 4096;
+}  // namespace
+
+bool IsBefore(const google::protobuf::Timestamp& first,
+              const google::protobuf::Timestamp& second) {
+  return first.seconds() == second.seconds()
+             ? first.nanos() < second.nanos()
+             : first.seconds() < second.seconds();
+}
+
+RevisionBuffer::RevisionBuffer(std::size_t memory_budget)
+    : memory_budget_(memory_budget) {}
+
+void RevisionBuffer::Add(const proto::RevisionCitations& citations) {
+  auto* revision = google::protobuf::Arena::CreateMessage<
+      proto::RevisionCitations>(&arena_);
+  revision->CopyFrom(citations);
+  revisions_.push_back(revision);
+
+  memory_used_ += citations.ByteSizeLong();
+  if (memory_budget_ > 0 && memory_used_ > memory_budget_) {
+    Spill();
+  }
+}
+
+void RevisionBuffer::SortRevisions() {
+  std::ranges::stable_sort(
+      revisions_, [](const proto::RevisionCitations* first,
+                     const proto::RevisionCitations* second) {
+        return IsBefore(first->revision().timestamp(),
+                        second->revision().timestamp());
+      });
+}
+
+void RevisionBuffer::Spill() {
+  SortRevisions();
+
+  if (!file_.is_open()) {
+    file_ = OpenTemporaryFile();
+    file_size_ = 0;
+  }
+
+  file_.clear();
+  file_.seekp(file_size_);
+  auto writer = MessageWriter(&file_);
+  for (const auto* revision : revisions_) {
+    writer.WriteMessage(*revision);
+  }
+  if (!file_.flush()) {
+    throw std::runtime_error("Could not write revisions to temporary file");
+  }
+
+  auto& run = runs_.emplace_back();
+  run.offset = file_size_;
+  file_size_ = file_.tellp();
+  run.end = file_size_;
+
+  revisions_.clear();
+  arena_.Reset();
+  memory_used_ = 0;
+}
+
+void RevisionBuffer::Sort() {
+  SortRevisions();
+  next_revision_ = 0;
+
+  if (runs_.empty()) {
+    return;
+  }
+
+  // Share the budget between the runs, so that reading them back uses
+  // about as much memory as a single run did.
+  read_size_ = std::max(kMinimumReadSize, memory_budget_ / runs_.size());
+  heap_.clear();
+  for (std::size_t i = 0; i < runs_.size(); i++) {
+    ReadNext(&runs_[i]);
+    if (runs_[i].next != nullptr) {
+      heap_.push_back(i);
+    }
+  }
+  std::ranges::make_heap(heap_, [this](std::size_t first, std::size_t second) {
+    return IsLater(first, second);
+  });
+}
+
+bool RevisionBuffer::IsLater(std::size_t first, std::size_t second) const {
+  const auto& first_timestamp = runs_[first].next->revision().timestamp();
+  const auto& second_timestamp = runs_[second].next->revision().timestamp();
+  if (IsBefore(second_timestamp, first_timestamp)) {
+    return true;
+  }
+  if (IsBefore(first_timestamp, second_timestamp)) {
+    return false;
+  }
+  // Runs were written in the order their revisions were added.
+  return first > second;
+}
+
+void RevisionBuffer::Fill(Run* run, std::size_t size) {
+  auto available = run->buffer.size() - run->buffer_position;
+  if (available >= size) {
+    return;
+  }
+
+  run->buffer.erase(0, run->buffer_position);
+  run->buffer_position = 0;
+
+  auto remaining = static_cast<std::size_t>(run->end - run->offset);
+  auto count = std::min(std::max(size - available, read_size_), remaining);
+  if (available + count < size) {
+    throw std::runtime_error("Temporary file ended within a revision");
+  }
+
+  run->buffer.resize(available + count);
+  file_.clear();
+  file_.seekg(run->offset);
+  if (!file_.read(run->buffer.data() + available,
+                  static_cast<std::streamsize>(count))) {
+    throw std::runtime_error("Could not read revisions from temporary file");
+  }
+  run->offset += static_cast<std::streamoff>(count);
+}
+
+void RevisionBuffer::ReadNext(Run* run) {
+  if (run->buffer_position == run->buffer.size() && run->offset == run->end) {
+    run->next.reset();
+    return;
+  }
+
+  // Revisions are written by MessageWriter, each after its size in
+  // network byte order.
+  uint32_t size = 0;
+  Fill(run, sizeof(size));
+  std::memcpy(&size, run->buffer.data() + run->buffer_position, sizeof(size));
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  size = ntohl(size);
+
+  Fill(run, sizeof(size) + size);
+  auto message = std::make_unique<proto::RevisionCitations>();
+  if (!message->ParseFromArray(
+          run->buffer.data() + run->buffer_position + sizeof(size),
+          static_cast<int>(size))) {
+    throw std::runtime_error("Could not parse revision from temporary file");
+  }
+  run->buffer_position += sizeof(size) + size;
+  run->next = std::move(message);
+}
+
+proto::RevisionCitations* RevisionBuffer::Next() {
+  // The revisions still in memory were added after every run, so on a
+  // tie the runs win.
+  Run* earliest = heap_.empty() ? nullptr : &runs_[heap_.front()];
+  if (next_revision_ < revisions_.size() &&
+      (earliest == nullptr ||
+       IsBefore(revisions_[next_revision_]->revision().timestamp(),
+                earliest->next->revision().timestamp()))) {
+    return revisions_[next_revision_++];
+  }
+
+  if (earliest == nullptr) {
+    return nullptr;
+  }
+
+  auto is_later = [this](std::size_t first, std::size_t second) {
+    return IsLater(first, second);
+  };
+  std::ranges::pop_heap(heap_, is_later);
+  current_ = std::move(earliest->next);
+  ReadNext(earliest);
+  if (earliest->next == nullptr) {
+    heap_.pop_back();
+  } else {
+    std::ranges::push_heap(heap_, is_later);
+  }
+  return current_.get();
+}
+
+void RevisionBuffer::Clear() {
+  revisions_.clear();
+  arena_.Reset();
+  memory_used_ = 0;
+  next_revision_ = 0;
+  runs_.clear();
+  heap_.clear();
+  current_.reset();
+  if (file_.is_open()) {
+    file_.close();
+  }
+  file_size_ = 0;
+}
+
+}  // namespace wikiopencite::citescoop
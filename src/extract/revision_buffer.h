@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_REVISION_BUFFER_H_
+#define SRC_EXTRACT_REVISION_BUFFER_H_
+
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "citescoop/proto/revision_citations.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/timestamp.pb.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Check if a timestamp is before another.
+/// @param first Timestamp to check.
+/// @param second Timestamp to compare against.
+/// @return True if first is strictly before second.
+bool IsBefore(const google::protobuf::Timestamp& first,
+              const google::protobuf::Timestamp& second);
+
+/// @brief Buffer sorting a page's revisions by timestamp.
+///
+/// Revisions are held in memory until they exceed the memory budget, at
+/// which point they are sorted and appended to a temporary file as a
+/// run. Every run of a page shares the one file. Once every revision
+/// has been added, the runs are merged through a heap as they are read
+/// back. Revisions with the same timestamp are returned in the order
+/// they were added.
+class RevisionBuffer {
+ public:
+  /// @brief Construct a new revision buffer.
+  /// @param memory_budget Serialized size in bytes of the revisions to
+  /// hold in memory before writing them to a temporary file. If 0,
+  /// revisions are only ever held in memory.
+  explicit RevisionBuffer(std::size_t memory_budget);
+
+  /// @brief Add a revision and its citations.
+  /// @param citations Revision and its citations.
+  void Add(const wikiopencite::proto::RevisionCitations& citations);
+
+  /// @brief Check if no revisions have been added.
+  /// @return True if the buffer is empty.
+  bool empty() const { return revisions_.empty() && runs_.empty(); }
+
+  /// @brief Sort the revisions, ready to be read back with Next().
+  /// No more revisions may be added until the buffer is cleared.
+  void Sort();
+
+  /// @brief Read the next revision in timestamp order.
+  /// @return The revision, which is only valid until the next call, or
+  /// null if every revision has been read.
+  wikiopencite::proto::RevisionCitations* Next();
+
+  /// @brief Remove every revision and the temporary file.
+  void Clear();
+
+ private:
+  // A sorted run of revisions in the temporary file.
+  struct Run {
+    // Offset of the first byte of the run not yet read into the buffer.
+    std::streamoff offset;
+    // Offset one past the last byte of the run.
+    std::streamoff end;
+    // Bytes read from the run but not yet parsed, from buffer_position.
+    std::string buffer;
+    std::size_t buffer_position = 0;
+    std::unique_ptr<wikiopencite::proto::RevisionCitations> next;
+  };
+
+  std::size_t memory_budget_;
+  std::size_t memory_used_ = 0;
+
+  // Revisions held in memory, which are sorted last.
+  google::protobuf::Arena arena_;
+  std::vector<wikiopencite::proto::RevisionCitations*> revisions_;
+  std::size_t next_revision_ = 0;
+
+  // Temporary file holding every run, opened on the first spill.
+  std::fstream file_;
+  std::streamoff file_size_ = 0;
+  std::vector<Run> runs_;
+  // Indices of the runs with a revision left, as a heap with the
+  // earliest revision at the front.
+  std::vector<std::size_t> heap_;
+  // Bytes of each run to read from the file at once.
+  std::size_t read_size_ = 0;
+  std::unique_ptr<wikiopencite::proto::RevisionCitations> current_;
+
+  /// @brief Sort the revisions held in memory.
+  void SortRevisions();
+
+  /// @brief Write the revisions held in memory to a new run and free
+  /// them.
+  void Spill();
+
+  /// @brief Check if a run's next revision should be read after
+  /// another's.
+  /// @param first Index of the run to check.
+  /// @param second Index of the run to compare against.
+  /// @return True if first's revision is later, or is at the same time
+  /// and was added after second's.
+  bool IsLater(std::size_t first, std::size_t second) const;
+
+  /// @brief Read the next revision of a run into Run::next.
+  /// @param run Run to read from.
+  void ReadNext(Run* run);
+
+  /// @brief Read more of a run from the file until its buffer holds
+  /// enough unparsed bytes.
+  /// @param run Run to read from.
+  /// @param size Number of unparsed bytes needed.
+  void Fill(Run* run, std::size_t size);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_REVISION_BUFFER_H_
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sharded_dump_parser.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+#include "sharded_page_writer.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+ShardedDumpParser::ShardedDumpParser(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : DumpParser(std::move(parser), options),
+      revision_encoding_(options.revision_encoding) {}
+
+std::vector<std::pair<uint64_t, uint64_t>> ShardedDumpParser::ParseXML(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  // Pages are written straight from the parser's arena, so there is
+  // nothing to gain from writer threads.
+  writer_ = std::make_unique<ShardedPageWriter>(
+      shards, false, revision_encoding_);
+
+  StartParser(input);
+
+  return writer_->Finish();
+}
+
+void ShardedDumpParser::Store(
+    const std::map<uint64_t, const proto::Revision*>& revisions,
+    const proto::Page& page) {
+  writer_->Write(page, revisions);
+}
+
+}  // namespace wikiopencite::citescoop
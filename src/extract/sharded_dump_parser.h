@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_SHARDED_DUMP_PARSER_H_
+#define SRC_EXTRACT_SHARDED_DUMP_PARSER_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "dump_parser.h"
+#include "sharded_page_writer.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief MediaWiki XML dump parser writing pages to shards of output
+/// streams as they are parsed.
+class ShardedDumpParser : private DumpParser {
+ public:
+  /// @brief Construct a new dumps parser.
+  /// @param parser The citation parser to use.
+  /// @param options Extractor options to configure the parser with.
+  ShardedDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                    ExtractorOptions options);
+
+  /// @brief Parse the dump XML.
+  /// @param input An input stream of plain XML. NOTE: if you are
+  /// dealing with a compressed dump, this must have already been
+  /// decompressed by this point.
+  /// @param shards Output streams of each shard.
+  /// @return Number of pages written followed by the number of
+  /// revisions written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> ParseXML(
+      std::istream& input, const std::vector<ShardOutput>& shards);
+
+ protected:
+  void Store(
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>& revisions,
+      const wikiopencite::proto::Page& page) override;
+
+ private:
+  RevisionEncoding revision_encoding_;
+  std::unique_ptr<ShardedPageWriter> writer_;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_SHARDED_DUMP_PARSER_H_
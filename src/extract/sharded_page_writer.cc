@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sharded_page_writer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "bounded_queue.h"
+#include "collecting_dump_parser.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+namespace {
+// Number of pages to queue for each shard's writer thread.
+const std::size_t kQueuedPagesPerShard = 64;
+}  // namespace
+
+std::size_t PageShard(uint64_t page_id, std::size_t shard_count) {
+  // splitmix64 finalizer, spreading runs of consecutive IDs over the
+  // shards.
+  auto hash = page_id;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return static_cast<std::size_t>(hash % shard_count);
+}
+
+ShardedPageWriter::ShardedPageWriter(const std::vector<ShardOutput>& shards,
+                                     bool background,
+                                     RevisionEncoding revision_encoding) {
+  if (shards.empty()) {
+    throw std::invalid_argument("At least one shard is required");
+  }
+
+  for (const auto& output : shards) {
+    auto& shard = shards_.emplace_back(
+        std::make_unique<Shard>(output, revision_encoding));
+    if (background) {
+      shard->queue =
+          std::make_unique<BoundedQueue<ParsedPage>>(kQueuedPagesPerShard);
+      shard->thread = std::thread(WriteShard, shard.get());
+    }
+  }
+}
+
+ShardedPageWriter::~ShardedPageWriter() { Stop(); }
+
+void ShardedPageWriter::Write(ParsedPage&& parsed) {
+  auto& shard = *shards_[PageShard(parsed.page.page_id(), shards_.size())];
+  if (shard.queue == nullptr) {
+    shard.writer.Write(parsed);
+    return;
+  }
+
+  // The queue is only closed early if the shard's writer failed.
+  if (!shard.queue->Push(std::move(parsed))) {
+    std::rethrow_exception(shard.error);
+  }
+}
+
+void ShardedPageWriter::Write(
+    const proto::Page& page,
+    const std::map<uint64_t, const proto::Revision*>& revisions) {
+  shards_[PageShard(page.page_id(), shards_.size())]->writer.Write(page,
+                                                                   revisions);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> ShardedPageWriter::Finish() {
+  Stop();
+
+  auto counts = std::vector<std::pair<uint64_t, uint64_t>>();
+  for (const auto& shard : shards_) {
+    if (shard->error) {
+      std::rethrow_exception(shard->error);
+    }
+    shard->writer.Flush();
+    counts.push_back(shard->writer.counts());
+  }
+  return counts;
+}
+
+void ShardedPageWriter::Stop() {
+  for (auto& shard : shards_) {
+    if (shard->queue != nullptr) {
+      shard->queue->Close();
+    }
+  }
+
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      shard->thread.join();
+    }
+  }
+}
+
+void ShardedPageWriter::WriteShard(Shard* shard) {
+  try {
+    while (auto parsed = shard->queue->Pop()) {
+      shard->writer.Write(*parsed);
+    }
+  } catch (...) {
+    shard->error = std::current_exception();
+
+    // Stop accepting pages, so that nothing waits on this shard.
+    shard->queue->Close();
+  }
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_SHARDED_PAGE_WRITER_H_
+#define SRC_EXTRACT_SHARDED_PAGE_WRITER_H_
+
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "bounded_queue.h"
+#include "collecting_dump_parser.h"
+#include "parsed_page_writer.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Write parsed pages to shards of output streams, chosen by
+/// PageShard().
+///
+/// When writing in the background, each shard has its own queue and
+/// writer thread, so shards are written concurrently without sharing a
+/// lock.
+class ShardedPageWriter {
+ public:
+  /// @brief Construct a new writer.
+  ///
+  /// Will throw std::invalid_argument if there are no shards.
+  ///
+  /// @param shards Output streams of each shard.
+  /// @param background If set, each shard is written on its own thread.
+  /// @param revision_encoding Encoding to write revisions in.
+  ShardedPageWriter(
+      const std::vector<ShardOutput>& shards, bool background,
+      RevisionEncoding revision_encoding = RevisionEncoding::kMessages);
+
+  /// @brief Finish writing any queued pages and join the writer threads.
+  ~ShardedPageWriter();
+
+  ShardedPageWriter(const ShardedPageWriter&) = delete;
+  ShardedPageWriter& operator=(const ShardedPageWriter&) = delete;
+
+  /// @brief Write a page followed by its revisions to its shard.
+  ///
+  /// In the background, the page is queued, blocking while its shard's
+  /// queue is full. If the shard's writer has failed, its error is
+  /// thrown.
+  ///
+  /// @param parsed Page to write.
+  void Write(ParsedPage&& parsed);
+
+  /// @brief Write a page followed by its revisions to its shard. Only
+  /// for writers that are not writing in the background.
+  /// @param page Page to write.
+  /// @param revisions Revisions referenced by the page, by revision ID.
+  void Write(
+      const wikiopencite::proto::Page& page,
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>&
+          revisions);
+
+  /// @brief Wait for every queued page to be written, then flush the
+  /// shards' writers.
+  ///
+  /// Any error from a shard's writer is thrown.
+  ///
+  /// @return Number of pages written followed by the number of
+  /// revisions written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Finish();
+
+ private:
+  struct Shard {
+    Shard(const ShardOutput& output, RevisionEncoding revision_encoding)
+        : writer(output.pages_output, output.revisions_output,
+                 revision_encoding) {}
+
+    ParsedPageWriter writer;
+
+    // Only used when writing in the background.
+    std::unique_ptr<BoundedQueue<ParsedPage>> queue;
+    std::thread thread;
+    std::exception_ptr error;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  /// @brief Close the shards' queues and join their writer threads.
+  void Stop();
+
+  /// @brief Write the pages queued for a shard until its queue closes.
+  /// @param shard Shard to write.
+  static void WriteShard(Shard* shard);
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_SHARDED_PAGE_WRITER_H_
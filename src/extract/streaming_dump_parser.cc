@@ -8,43 +8,120 @@
 #include <map>
 #include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <utility>
 
+#include "citescoop/extract.h"
 #include "citescoop/io.h"
 #include "citescoop/parser.h"
 #include "citescoop/proto/page.pb.h"
 #include "citescoop/proto/revision.pb.h"
 
 #include "dump_parser.h"
+#include "resumed_dump_buffer.h"
 
 namespace wikiopencite::citescoop {
 namespace proto = wikiopencite::proto;
 
 StreamingDumpParser::StreamingDumpParser(
-    std::shared_ptr<wikiopencite::citescoop::Parser> parser)
-    : DumpParser(std::move(parser)) {}
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    : DumpParser(std::move(parser), options),
+      revision_encoding_(options.revision_encoding),
+      checkpoint_interval_(options.checkpoint_interval),
+      on_checkpoint_(std::move(options.on_checkpoint)) {}
 
 std::pair<uint64_t, uint64_t> StreamingDumpParser::ParseXML(
     std::istream& input, std::ostream* pages_output,
-    std::ostream* revisions_output) {
-  page_writer_ = std::make_unique<MessageWriter>(pages_output);
-  revision_writer_ = std::make_unique<MessageWriter>(revisions_output);
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  page_writer_ = std::make_unique<AsyncMessageWriter>(pages_output);
+  revisions_output_ = revisions_output;
+  if (revision_encoding_ == RevisionEncoding::kCompact) {
+    compact_writer_ = std::make_unique<CompactRevisionWriter>(revisions_output);
+  } else {
+    revision_writer_ = std::make_unique<AsyncMessageWriter>(revisions_output);
+  }
+
+  pages_written_ = checkpoint.pages_written;
+  revisions_written_ = checkpoint.revisions_written;
+  pages_output_size_ = checkpoint.pages_output_size;
+  revisions_output_size_ = checkpoint.revisions_output_size;
 
-  StartParser(input);
+  if (checkpoint.input_offset == 0) {
+    StartParser(input);
+  } else {
+    ResumedDumpBuffer resumed_buffer(&input, checkpoint.input_offset);
+    std::istream resumed_input(&resumed_buffer);
+    resumed_buffer_ = &resumed_buffer;
+    StartParser(resumed_input);
+    resumed_buffer_ = nullptr;
+  }
 
+  page_writer_->Close();
+  if (compact_writer_ != nullptr) {
+    FlushRevisions();
+  } else {
+    revision_writer_->Close();
+  }
   return {pages_written_, revisions_written_};
 }
 
 void StreamingDumpParser::Store(
-    const std::map<uint64_t, proto::Revision>& revisions,
+    const std::map<uint64_t, const proto::Revision*>& revisions,
     const proto::Page& page) {
-  page_writer_->WriteMessage(page);
+  pages_output_size_ += sizeof(uint32_t) + page_writer_->WriteMessage(page);
   pages_written_++;
 
   for (const auto& [unused, revision] : revisions) {
-    revision_writer_->WriteMessage(revision);
+    WriteRevision(*revision);
     revisions_written_++;
   }
+
+  if (checkpoint_interval_ > 0 && pages_written_ % checkpoint_interval_ == 0) {
+    Checkpoint();
+  }
+}
+
+void StreamingDumpParser::WriteRevision(const proto::Revision& revision) {
+  if (compact_writer_ != nullptr) {
+    revisions_output_size_ += compact_writer_->WriteRevision(revision);
+  } else {
+    revisions_output_size_ +=
+        sizeof(uint32_t) + revision_writer_->WriteMessage(revision);
+  }
+}
+
+void StreamingDumpParser::FlushRevisions() {
+  if (compact_writer_ == nullptr) {
+    revision_writer_->Flush();
+    return;
+  }
+
+  // The open block is written, so that a checkpoint's output size
+  // covers every revision written before it.
+  revisions_output_size_ += compact_writer_->Flush();
+  if (!revisions_output_->flush()) {
+    throw std::runtime_error("Could not write revisions to output stream");
+  }
+}
+
+void StreamingDumpParser::Checkpoint() {
+  page_writer_->Flush();
+  FlushRevisions();
+
+  if (!on_checkpoint_) {
+    return;
+  }
+
+  auto checkpoint = ExtractorCheckpoint();
+  checkpoint.input_offset = resumed_buffer_ == nullptr
+                                ? InputOffset()
+                                : resumed_buffer_->DumpOffset(InputOffset());
+  checkpoint.pages_written = pages_written_;
+  checkpoint.revisions_written = revisions_written_;
+  checkpoint.pages_output_size = pages_output_size_;
+  checkpoint.revisions_output_size = revisions_output_size_;
+  on_checkpoint_(checkpoint);
 }
 
 }  // namespace wikiopencite::citescoop
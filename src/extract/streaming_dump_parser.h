@@ -5,18 +5,21 @@
 #define SRC_EXTRACT_STREAMING_DUMP_PARSER_H_
 
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <map>
 #include <memory>
 #include <ostream>
 #include <utility>
 
+#include "citescoop/extract.h"
 #include "citescoop/io.h"
 #include "citescoop/parser.h"
 #include "citescoop/proto/page.pb.h"
 #include "citescoop/proto/revision.pb.h"
 
 #include "dump_parser.h"
+#include "resumed_dump_buffer.h"
 
 namespace wikiopencite::citescoop {
 
@@ -25,8 +28,9 @@ class StreamingDumpParser : private DumpParser {
  public:
   /// @brief Construct a new dumps parser.
   /// @param parser The citation parser to use.
-  explicit StreamingDumpParser(
-      std::shared_ptr<wikiopencite::citescoop::Parser> parser);
+  /// @param options Extractor options to configure the parser with.
+  StreamingDumpParser(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                      ExtractorOptions options);
 
   /// @brief Parse the dump XML.
   /// @param input An input stream of plain XML. NOTE: if you are
@@ -34,21 +38,56 @@ class StreamingDumpParser : private DumpParser {
   /// decompressed by this point.
   /// @param pages_output Output stream for pages.
   /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from. If its input offset is
+  /// 0, the dump is parsed from the start.
   /// @return Number of pages written to the stream followed by the
-  /// number of revisions written.
+  /// number of revisions written, including those written before the
+  /// checkpoint.
   std::pair<uint64_t, uint64_t> ParseXML(std::istream& input,
                                          std::ostream* pages_output,
-                                         std::ostream* revisions_output);
+                                         std::ostream* revisions_output,
+                                         const ExtractorCheckpoint& checkpoint);
 
  protected:
-  void Store(const std::map<uint64_t, wikiopencite::proto::Revision>& revisions,
-             const wikiopencite::proto::Page& page) override;
+  void Store(
+      const std::map<uint64_t, const wikiopencite::proto::Revision*>& revisions,
+      const wikiopencite::proto::Page& page) override;
 
  private:
   uint64_t pages_written_ = 0;
   uint64_t revisions_written_ = 0;
-  std::unique_ptr<MessageWriter> page_writer_;
-  std::unique_ptr<MessageWriter> revision_writer_;
+  uint64_t pages_output_size_ = 0;
+  uint64_t revisions_output_size_ = 0;
+
+  // Messages are serialized and written on background threads, keeping
+  // the output off the parsing thread.
+  std::unique_ptr<AsyncMessageWriter> page_writer_;
+  std::unique_ptr<AsyncMessageWriter> revision_writer_;
+
+  // Compact revisions are encoded into blocks here instead, which are
+  // written straight to the output once full.
+  RevisionEncoding revision_encoding_;
+  std::unique_ptr<CompactRevisionWriter> compact_writer_;
+  std::ostream* revisions_output_ = nullptr;
+
+  uint64_t checkpoint_interval_;
+  std::function<void(const ExtractorCheckpoint&)> on_checkpoint_;
+
+  // Buffer the dump is read through when resuming, which offsets in
+  // the input are relative to.
+  const ResumedDumpBuffer* resumed_buffer_ = nullptr;
+
+  /// @brief Write a revision in the parser's revision encoding.
+  /// @param revision Revision to write.
+  void WriteRevision(const wikiopencite::proto::Revision& revision);
+
+  /// @brief Write every revision written so far to the revisions
+  /// output and flush it.
+  void FlushRevisions();
+
+  /// @brief Flush the outputs and report a checkpoint after the page
+  /// just written.
+  void Checkpoint();
 };
 }  // namespace wikiopencite::citescoop
 
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "temporary_file.h"
+
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <system_error>
+
+namespace wikiopencite::citescoop {
+
+std::fstream OpenTemporaryFile() {
+  auto path = (std::filesystem::temp_directory_path() / "citescoop-XXXXXX")
+                  .string();
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  auto descriptor = mkstemp(path.data());
+  if (descriptor == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Could not create temporary file");
+  }
+
+  auto file = std::fstream(path, std::ios::in | std::ios::out |
+                                     std::ios::binary | std::ios::trunc);
+  close(descriptor);
+  std::filesystem::remove(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open temporary file " + path);
+  }
+  return file;
+}
+}  // namespace wikiopencite::citescoop
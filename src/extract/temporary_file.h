@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_TEMPORARY_FILE_H_
+#define SRC_EXTRACT_TEMPORARY_FILE_H_
+
+#include <fstream>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Open a new temporary file for reading and writing.
+///
+/// The file is removed straight away, so it is cleaned up once closed
+/// however extraction ends.
+///
+/// Will throw a std::system_error if the file can't be created.
+///
+/// @return The open file.
+std::fstream OpenTemporaryFile();
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_TEMPORARY_FILE_H_
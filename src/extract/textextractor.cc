@@ -24,6 +24,11 @@ TextExtractor::TextExtractor(
     const std::shared_ptr<wikiopencite::citescoop::Parser>& parser)
     : impl_(std::make_unique<TextExtractorImpl>(parser)) {}
 
+TextExtractor::TextExtractor(
+    const std::shared_ptr<wikiopencite::citescoop::Parser>& parser,
+    ExtractorOptions options)
+    : impl_(std::make_unique<TextExtractorImpl>(parser, options)) {}
+
 TextExtractor::~TextExtractor() = default;
 
 std::pair<std::unique_ptr<std::vector<proto::Page>>,
@@ -35,6 +40,43 @@ TextExtractor::Extract(std::istream& stream) {
 std::pair<uint64_t, uint64_t> TextExtractor::Extract(
     std::istream& input, std::ostream* pages_output,
     std::ostream* revisions_output) {
-  return impl_->Extract(input, pages_output, revisions_output);
+  return impl_->Extract(input, pages_output, revisions_output,
+                        ExtractorCheckpoint());
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::Extract(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  return impl_->Extract(input, pages_output, revisions_output, checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> TextExtractor::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  return impl_->Extract(input, shards);
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::Extract(std::istream& input,
+                                                     PageSink& sink) {
+  return impl_->Extract(input, sink);
+}
+
+PageRange TextExtractor::Pages(std::istream& input) {
+  return impl_->Pages(input);
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  return impl_->ExtractIncremental(input, previous_pages, previous_revisions,
+                                   pages_output, revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  return impl_->ExtractReusing(input, previous, pages_output,
+                               revisions_output, page_versions_output);
 }
 }  // namespace wikiopencite::citescoop
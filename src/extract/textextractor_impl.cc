@@ -17,8 +17,6 @@
 #include "citescoop/proto/revision.pb.h"
 
 #include "base_extractor.h"
-#include "dump_parser.h"
-#include "streaming_dump_parser.h"
 
 namespace wikiopencite::citescoop {
 namespace proto = wikiopencite::proto;
@@ -28,18 +26,54 @@ TextExtractor::TextExtractorImpl::TextExtractorImpl(
     // NOLINTNEXTLINE(whitespace/indent_namespace)
     : BaseExtractor(std::move(parser)) {}
 
+TextExtractor::TextExtractorImpl::TextExtractorImpl(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    // NOLINTNEXTLINE(whitespace/indent_namespace)
+    : BaseExtractor(std::move(parser), options) {}
+
 std::pair<std::unique_ptr<std::vector<proto::Page>>,
           // NOLINTNEXTLINE(whitespace/indent_namespace)
           std::unique_ptr<std::map<uint64_t, proto::Revision>>>
 TextExtractor::TextExtractorImpl::Extract(std::istream& stream) {
-  auto xml_parser = DumpParser(citation_parser_);
-  return xml_parser.ParseXML(stream);
+  return ExtractXML(stream);
 }
 
 std::pair<uint64_t, uint64_t> TextExtractor::TextExtractorImpl::Extract(
     std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  return ExtractXML(input, pages_output, revisions_output, checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>>
+TextExtractor::TextExtractorImpl::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  return ExtractXML(input, shards);
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::TextExtractorImpl::Extract(
+    std::istream& input, PageSink& sink) {
+  return ExtractXML(input, sink);
+}
+
+PageRange TextExtractor::TextExtractorImpl::Pages(std::istream& input) {
+  return PagesXML(&input, nullptr);
+}
+
+std::pair<uint64_t, uint64_t>
+TextExtractor::TextExtractorImpl::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
     std::ostream* revisions_output) {
-  auto xml_parser = StreamingDumpParser(citation_parser_);
-  return xml_parser.ParseXML(input, pages_output, revisions_output);
+  return ExtractIncrementalXML(input, previous_pages, previous_revisions,
+                               pages_output, revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> TextExtractor::TextExtractorImpl::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  return ExtractReusingXML(input, previous, pages_output, revisions_output,
+                           page_versions_output);
 }
 }  // namespace wikiopencite::citescoop
@@ -29,6 +29,12 @@ class TextExtractor::TextExtractorImpl : BaseExtractor {
   explicit TextExtractorImpl(
       std::shared_ptr<wikiopencite::citescoop::Parser> parser);
 
+  /// @brief Construct a new text extractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options.
+  TextExtractorImpl(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                    ExtractorOptions options);
+
   /// @brief Extract citations from a text stream.
   /// @param stream Stream to parse.
   /// @return Pages and referenced revisions.
@@ -40,10 +46,59 @@ class TextExtractor::TextExtractorImpl : BaseExtractor {
   /// @param input Input text stream.
   /// @param pages_output Output stream for pages.
   /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
   /// @return The number of pages written, then the number of revisions written.
   std::pair<uint64_t, uint64_t> Extract(std::istream& input,
                                         std::ostream* pages_output,
-                                        std::ostream* revisions_output);
+                                        std::ostream* revisions_output,
+                                        const ExtractorCheckpoint& checkpoint);
+
+  /// @brief Sharded extract implementation.
+  /// @param input Input text stream.
+  /// @param shards Output streams of each shard.
+  /// @return The number of pages written, then the number of revisions
+  /// written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards);
+
+  /// @brief Extract implementation handing pages to a sink.
+  /// @param input Input text stream.
+  /// @param sink Sink to consume each page.
+  /// @return The number of pages consumed, then the number of revisions
+  /// consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input, PageSink& sink);
+
+  /// @brief Lazy extract implementation.
+  /// @param input Input text stream.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input);
+
+  /// @brief Incremental extract implementation.
+  /// @param input Input text stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Reusing extract implementation.
+  /// @param input Input text stream.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output);
 
  private:
   std::shared_ptr<wikiopencite::citescoop::Parser> parser_;
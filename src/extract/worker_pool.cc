@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "worker_pool.h"
+
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+
+namespace wikiopencite::citescoop {
+
+WorkerPool::WorkerPool(unsigned int threads) {
+  const auto count = ResolveThreads(threads);
+  workers_.reserve(count);
+  for (unsigned int i = 0; i < count; i++) {
+    workers_.emplace_back([this]() { Run(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+    tasks_ = std::queue<std::function<void()>>();
+  }
+  task_available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+unsigned int WorkerPool::ResolveThreads(unsigned int threads) {
+  if (threads != 0) {
+    return threads;
+  }
+
+  const auto hardware_threads = std::thread::hardware_concurrency();
+  return hardware_threads == 0 ? 1 : hardware_threads;
+}
+
+bool WorkerPool::RunQueuedTask() {
+  std::function<void()> task;
+  {
+    std::scoped_lock lock(mutex_);
+    if (stopping_ || tasks_.empty()) {
+      return false;
+    }
+
+    task = std::move(tasks_.front());
+    tasks_.pop();
+  }
+
+  task();
+  return true;
+}
+
+void WorkerPool::Run() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(mutex_);
+      task_available_.wait(lock,
+                           [this]() { return stopping_ || !tasks_.empty(); });
+      if (stopping_) {
+        return;
+      }
+
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+
+    task();
+  }
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_WORKER_POOL_H_
+#define SRC_EXTRACT_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wikiopencite::citescoop {
+
+/// @brief Fixed size pool of worker threads.
+///
+/// Tasks are run in submission order on the first available worker.
+/// Any tasks still queued when the pool is destroyed are discarded,
+/// their futures will report a broken promise.
+class WorkerPool {
+ public:
+  /// @brief Start a new worker pool.
+  /// @param threads Number of workers to start. If 0, one worker per
+  /// hardware thread is started.
+  explicit WorkerPool(unsigned int threads);
+
+  /// @brief Discard any queued tasks and join the workers.
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /// @brief Queue a task to be run on the pool.
+  /// @param task Task to run.
+  /// @return Future holding the result of the task, or any exception
+  /// it threw.
+  template <class F>
+  std::future<std::invoke_result_t<F>> Submit(F task) {
+    using Result = std::invoke_result_t<F>;
+    auto packaged =
+        std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    auto future = packaged->get_future();
+    {
+      std::scoped_lock lock(mutex_);
+      tasks_.emplace([packaged]() { (*packaged)(); });
+    }
+    task_available_.notify_one();
+    return future;
+  }
+
+  /// @brief Take the oldest queued task and run it on the calling
+  /// thread.
+  /// @return True if a task was run, false if none were queued.
+  bool RunQueuedTask();
+
+  /// @brief Get the number of workers in the pool.
+  /// @return Number of workers.
+  unsigned int size() const {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+  /// @brief Resolve a requested thread count.
+  /// @param threads Requested number of threads, 0 for one per hardware
+  /// thread.
+  /// @return Number of threads to use, always at least 1.
+  static unsigned int ResolveThreads(unsigned int threads);
+
+ private:
+  /// @brief Worker loop, runs tasks until the pool is stopped.
+  void Run();
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  bool stopping_ = false;
+};
+
+/// @brief Wait for a task to finish, running the pool's queued tasks on
+/// the calling thread in the meantime rather than sitting idle.
+///
+/// Tasks that are waited on this way must never wait on the pool
+/// themselves.
+///
+/// @tparam T Result type of the task.
+/// @param pool Pool the task was submitted to.
+/// @param future Future of the task.
+template <class T>
+void WaitForTask(WorkerPool* pool, const std::shared_future<T>& future) {
+  while (future.wait_for(std::chrono::seconds(0)) !=
+         std::future_status::ready) {
+    if (!pool->RunQueuedTask()) {
+      // The task is already running on a worker.
+      future.wait();
+      return;
+    }
+  }
+}
+
+/// @brief Take the result of the next completed task.
+///
+/// If preserving order, this waits for the oldest task. Otherwise the
+/// first task that has already finished is used, only waiting for the
+/// oldest task if none have.
+///
+/// @tparam T Result type of the tasks.
+/// @param pending Futures of the tasks in flight, oldest first. Must
+/// not be empty.
+/// @param preserve_order Should results be taken in submission order?
+/// @return The task result.
+template <class T>
+T TakeCompleted(std::deque<std::future<T>>* pending, bool preserve_order) {
+  auto ready = pending->begin();
+  if (!preserve_order) {
+    for (auto it = pending->begin(); it != pending->end(); it++) {
+      if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        ready = it;
+        break;
+      }
+    }
+  }
+
+  auto future = std::move(*ready);
+  pending->erase(ready);
+  return future.get();
+}
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_WORKER_POOL_H_
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "zstd_seek_table.h"
+
+#include <array>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <optional>
+
+namespace wikiopencite::citescoop {
+
+namespace {
+const uint32_t kSkippableFrameMagic = 0x184D2A5E;
+const uint32_t kSeekableMagic = 0x8F92EAB1;
+
+// Skippable frame header: magic number and frame size.
+const std::streamoff kFrameHeaderSize = 8;
+
+// Footer: number of frames, table descriptor and seekable magic number.
+const std::streamoff kFooterSize = 9;
+
+// Seek table descriptor flags.
+const unsigned int kChecksumFlag = 0x80;
+const unsigned int kReservedBits = 0x7C;
+
+// Each entry holds the compressed and decompressed size, optionally
+// followed by a checksum.
+const std::streamoff kEntrySize = 8;
+const std::streamoff kChecksumSize = 4;
+
+/// @brief Decode a little endian 32 bit integer.
+uint32_t ReadLittleEndian(const unsigned char* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+/// @brief Read a little endian 32 bit integer from a stream.
+std::optional<uint32_t> ReadLittleEndian(std::istream& input) {
+  auto bytes = std::array<unsigned char, 4>();
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  input.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+  if (!input) {
+    return std::nullopt;
+  }
+  return ReadLittleEndian(bytes.data());
+}
+}  // namespace
+
+std::optional<ZstdSeekTable> ZstdSeekTable::Read(std::istream& input) {
+  const auto start = input.tellg();
+  if (start == std::streampos(-1)) {
+    input.clear();
+    return std::nullopt;
+  }
+
+  auto table = ReadTable(input, start);
+
+  input.clear();
+  input.seekg(start);
+  return table;
+}
+
+std::optional<ZstdSeekTable> ZstdSeekTable::ReadTable(std::istream& input,
+                                                      std::streamoff start) {
+  input.seekg(0, std::ios::end);
+  const std::streamoff end = input.tellg();
+  if (!input || end - start < kFrameHeaderSize + kFooterSize) {
+    return std::nullopt;
+  }
+
+  auto footer = std::array<unsigned char, kFooterSize>();
+  input.seekg(end - kFooterSize);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  input.read(reinterpret_cast<char*>(footer.data()), footer.size());
+  if (!input || ReadLittleEndian(&footer[5]) != kSeekableMagic ||
+      (footer[4] & kReservedBits) != 0) {
+    return std::nullopt;
+  }
+
+  const auto frame_count = ReadLittleEndian(footer.data());
+  const auto entry_size =
+      kEntrySize + ((footer[4] & kChecksumFlag) != 0 ? kChecksumSize : 0);
+  const auto table_size =
+      kFrameHeaderSize + static_cast<std::streamoff>(frame_count) * entry_size +
+      kFooterSize;
+  if (end - start < table_size) {
+    return std::nullopt;
+  }
+
+  input.seekg(end - table_size);
+  auto magic = ReadLittleEndian(input);
+  auto frame_size = ReadLittleEndian(input);
+  if (magic != kSkippableFrameMagic || !frame_size.has_value() ||
+      *frame_size != table_size - kFrameHeaderSize) {
+    return std::nullopt;
+  }
+
+  auto table = ZstdSeekTable();
+  table.frames_.reserve(frame_count);
+  std::streamoff compressed_size = 0;
+  for (uint32_t i = 0; i < frame_count; i++) {
+    auto entry = std::array<unsigned char, kEntrySize + kChecksumSize>();
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    input.read(reinterpret_cast<char*>(entry.data()), entry_size);
+    if (!input) {
+      return std::nullopt;
+    }
+
+    auto frame = ZstdFrame{ReadLittleEndian(entry.data()),
+                           ReadLittleEndian(&entry[4])};
+    compressed_size += frame.compressed_size;
+    table.frames_.push_back(frame);
+  }
+
+  // The frames must account for everything before the seek table.
+  if (compressed_size != end - start - table_size) {
+    return std::nullopt;
+  }
+
+  return table;
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_ZSTD_SEEK_TABLE_H_
+#define SRC_EXTRACT_ZSTD_SEEK_TABLE_H_
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <vector>
+
+namespace wikiopencite::citescoop {
+
+/// @brief A single frame of a seekable zstd stream.
+struct ZstdFrame {
+  /// Size of the compressed frame in bytes
+  uint32_t compressed_size;
+
+  /// Size of the frame once decompressed in bytes
+  uint32_t decompressed_size;
+};
+
+/// @brief Seek table of a seekable zstd stream.
+///
+/// The seekable format splits the data into independently compressed
+/// frames and appends a skippable frame listing the compressed and
+/// decompressed size of each, ending with a footer holding the number
+/// of frames and the seekable magic number.
+class ZstdSeekTable {
+ public:
+  /// @brief Read the seek table from the end of a stream.
+  ///
+  /// The input is left positioned where it was, so it can then be read
+  /// from the first frame onwards.
+  ///
+  /// @param input Stream of zstd compressed data, positioned at the
+  /// start of the first frame.
+  /// @return The seek table, or nothing if the input is not seekable or
+  /// has no valid seek table.
+  static std::optional<ZstdSeekTable> Read(std::istream& input);
+
+  /// @brief Get the frames in the order they appear in the stream.
+  /// @return Stream frames, excluding the seek table.
+  const std::vector<ZstdFrame>& frames() const { return frames_; }
+
+ private:
+  /// @brief Read the seek table, leaving the input wherever it ends up.
+  /// @param input Stream of zstd compressed data.
+  /// @param start Position of the first frame.
+  /// @return The seek table, or nothing if there isn't a valid one.
+  static std::optional<ZstdSeekTable> ReadTable(std::istream& input,
+                                                std::streamoff start);
+
+  std::vector<ZstdFrame> frames_;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_ZSTD_SEEK_TABLE_H_
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "zstdextractor_impl.h"
+
+namespace wikiopencite::citescoop {
+
+namespace proto = wikiopencite::proto;
+
+ZstdExtractor::ZstdExtractor(
+    const std::shared_ptr<wikiopencite::citescoop::Parser>& parser)
+    : impl_(std::make_unique<ZstdExtractorImpl>(parser)) {}
+
+ZstdExtractor::ZstdExtractor(
+    const std::shared_ptr<wikiopencite::citescoop::Parser>& parser,
+    ExtractorOptions options)
+    : impl_(std::make_unique<ZstdExtractorImpl>(parser, options)) {}
+
+ZstdExtractor::~ZstdExtractor() = default;
+
+std::pair<std::unique_ptr<std::vector<proto::Page>>,
+          std::unique_ptr<std::map<uint64_t, proto::Revision>>>
+ZstdExtractor::Extract(std::istream& stream) {
+  return impl_->Extract(stream);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::Extract(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  return impl_->Extract(input, pages_output, revisions_output,
+                        ExtractorCheckpoint());
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::Extract(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  return impl_->Extract(input, pages_output, revisions_output, checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> ZstdExtractor::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  return impl_->Extract(input, shards);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::Extract(std::istream& input,
+                                                     PageSink& sink) {
+  return impl_->Extract(input, sink);
+}
+
+PageRange ZstdExtractor::Pages(std::istream& input) {
+  return impl_->Pages(input);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  return impl_->ExtractIncremental(input, previous_pages, previous_revisions,
+                                   pages_output, revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  return impl_->ExtractReusing(input, previous, pages_output,
+                               revisions_output, page_versions_output);
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "zstdextractor_impl.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+#include "boost/iostreams/categories.hpp"
+#include "boost/iostreams/filter/zstd.hpp"
+#include "boost/iostreams/filtering_streambuf.hpp"
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "base_extractor.h"
+#include "parallel_zstd_decompressor.h"
+#include "zstd_seek_table.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+namespace bio = boost::iostreams;
+
+ZstdExtractor::ZstdExtractorImpl::ZstdExtractorImpl(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser)
+    // NOLINTNEXTLINE(whitespace/indent_namespace)
+    : BaseExtractor(std::move(parser)) {}
+
+ZstdExtractor::ZstdExtractorImpl::ZstdExtractorImpl(
+    std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+    ExtractorOptions options)
+    // NOLINTNEXTLINE(whitespace/indent_namespace)
+    : BaseExtractor(std::move(parser), options) {}
+
+std::pair<std::unique_ptr<std::vector<proto::Page>>,
+          // NOLINTNEXTLINE(whitespace/indent_namespace)
+          std::unique_ptr<std::map<uint64_t, proto::Revision>>>
+ZstdExtractor::ZstdExtractorImpl::Extract(std::istream& stream) {
+  auto decompression_stream = MakeDecompressionBuffer(stream);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::ZstdExtractorImpl::Extract(
+    std::istream& input, std::ostream* pages_output,
+    std::ostream* revisions_output, const ExtractorCheckpoint& checkpoint) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, pages_output, revisions_output,
+                    checkpoint);
+}
+
+std::vector<std::pair<uint64_t, uint64_t>>
+ZstdExtractor::ZstdExtractorImpl::Extract(
+    std::istream& input, const std::vector<ShardOutput>& shards) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, shards);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::ZstdExtractorImpl::Extract(
+    std::istream& input, PageSink& sink) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractXML(decompressed_stream, sink);
+}
+
+PageRange ZstdExtractor::ZstdExtractorImpl::Pages(std::istream& input) {
+  return PagesXML(nullptr, MakeDecompressionBuffer(input));
+}
+
+std::pair<uint64_t, uint64_t>
+ZstdExtractor::ZstdExtractorImpl::ExtractIncremental(
+    std::istream& input, std::istream& previous_pages,
+    std::istream& previous_revisions, std::ostream* pages_output,
+    std::ostream* revisions_output) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractIncrementalXML(decompressed_stream, previous_pages,
+                               previous_revisions, pages_output,
+                               revisions_output);
+}
+
+std::pair<uint64_t, uint64_t> ZstdExtractor::ZstdExtractorImpl::ExtractReusing(
+    std::istream& input, const PreviousExtraction& previous,
+    std::ostream* pages_output, std::ostream* revisions_output,
+    std::ostream* page_versions_output) {
+  auto decompression_stream = MakeDecompressionBuffer(input);
+  std::istream decompressed_stream(decompression_stream.get());
+
+  return ExtractReusingXML(decompressed_stream, previous, pages_output,
+                           revisions_output, page_versions_output);
+}
+
+std::unique_ptr<std::streambuf>
+ZstdExtractor::ZstdExtractorImpl::MakeDecompressionBuffer(std::istream& input) {
+  if (options_.decompression_threads != 1) {
+    auto seek_table = ZstdSeekTable::Read(input);
+    if (seek_table.has_value()) {
+      return std::make_unique<ParallelZstdDecompressor>(
+          &input, std::move(seek_table.value()),
+          options_.decompression_threads);
+    }
+  }
+
+  auto decompression_stream =
+      std::make_unique<bio::filtering_streambuf<bio::input>>();
+  decompression_stream->push(bio::zstd_decompressor());
+  decompression_stream->push(input);
+  return decompression_stream;
+}
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_EXTRACT_ZSTDEXTRACTOR_IMPL_H_
+#define SRC_EXTRACT_ZSTDEXTRACTOR_IMPL_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+#include "citescoop/extract.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+#include "citescoop/proto/revision.pb.h"
+
+#include "base_extractor.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Implementation for the zstd extractor.
+class ZstdExtractor::ZstdExtractorImpl : BaseExtractor {
+ public:
+  /// @brief Create a new zstd extractor.
+  /// @param parser Citations parser to use.
+  explicit ZstdExtractorImpl(
+      std::shared_ptr<wikiopencite::citescoop::Parser> parser);
+
+  /// @brief Create a new zstd extractor with extractor options.
+  /// @param parser Citations parser to use.
+  /// @param options Extractor options.
+  ZstdExtractorImpl(std::shared_ptr<wikiopencite::citescoop::Parser> parser,
+                    ExtractorOptions options);
+
+  /// @brief Extract implementation. This will decompress the input
+  /// stream and pass it off to the XML parser.
+  ///
+  /// @param stream Input compressed zstd stream.
+  /// @return Pages and the referenced revisions.
+  std::pair<std::unique_ptr<std::vector<wikiopencite::proto::Page>>,
+            std::unique_ptr<std::map<uint64_t, wikiopencite::proto::Revision>>>
+  Extract(std::istream& stream);
+
+  /// @brief Extract implementation. Decompresses the input stream and
+  /// hands of to the streaming output XML parser.
+  /// @param input Input compressed zstd stream.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param checkpoint Checkpoint to resume from.
+  /// @return The number of pages written, then the number of revisions written.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input,
+                                        std::ostream* pages_output,
+                                        std::ostream* revisions_output,
+                                        const ExtractorCheckpoint& checkpoint);
+
+  /// @brief Sharded extract implementation.
+  /// @param input Input compressed zstd stream.
+  /// @param shards Output streams of each shard.
+  /// @return The number of pages written, then the number of revisions
+  /// written, for each shard.
+  std::vector<std::pair<uint64_t, uint64_t>> Extract(
+      std::istream& input, const std::vector<ShardOutput>& shards);
+
+  /// @brief Extract implementation handing pages to a sink.
+  /// @param input Input compressed zstd stream.
+  /// @param sink Sink to consume each page.
+  /// @return The number of pages consumed, then the number of revisions
+  /// consumed.
+  std::pair<uint64_t, uint64_t> Extract(std::istream& input, PageSink& sink);
+
+  /// @brief Lazy extract implementation.
+  /// @param input Input compressed zstd stream.
+  /// @return Range of the extracted pages.
+  PageRange Pages(std::istream& input);
+
+  /// @brief Incremental extract implementation.
+  /// @param input Input compressed zstd stream of the incremental dump.
+  /// @param previous_pages Pages output of the previous extraction.
+  /// @param previous_revisions Revisions output of the previous
+  /// extraction.
+  /// @param pages_output Output stream for the merged pages.
+  /// @param revisions_output Output stream for the merged revisions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractIncremental(
+      std::istream& input, std::istream& previous_pages,
+      std::istream& previous_revisions, std::ostream* pages_output,
+      std::ostream* revisions_output);
+
+  /// @brief Reusing extract implementation.
+  /// @param input Input compressed zstd stream.
+  /// @param previous Outputs of the previous extraction.
+  /// @param pages_output Output stream for pages.
+  /// @param revisions_output Output stream for revisions.
+  /// @param page_versions_output Output stream for page versions.
+  /// @return The number of pages written, then the number of revisions
+  /// written.
+  std::pair<uint64_t, uint64_t> ExtractReusing(
+      std::istream& input, const PreviousExtraction& previous,
+      std::ostream* pages_output, std::ostream* revisions_output,
+      std::ostream* page_versions_output);
+
+ private:
+  /// @brief Create the stream buffer decompressing the input stream.
+  ///
+  /// Uses the parallel frame decompressor if configured with more than
+  /// one decompression thread and the input has a seek table.
+  ///
+  /// @param input Input compressed zstd stream.
+  /// @return Stream buffer of the decompressed input.
+  std::unique_ptr<std::streambuf> MakeDecompressionBuffer(std::istream& input);
+};
+
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_EXTRACT_ZSTDEXTRACTOR_IMPL_H_
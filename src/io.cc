@@ -0,0 +1,502 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "citescoop/io.h"
+
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <arpa/inet.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/unordered/unordered_flat_map.hpp"
+#include "citescoop/proto/revision.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/timestamp.pb.h"
+
+#include "extract/bounded_queue.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+namespace {
+/// @brief Append a varint to a buffer.
+void AppendVarint(std::string* buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  buffer->push_back(static_cast<char>(value));
+}
+
+/// @brief Append a signed value to a buffer as a zigzag varint, so that
+/// small negative values stay small.
+void AppendSignedVarint(std::string* buffer, int64_t value) {
+  AppendVarint(buffer, (static_cast<uint64_t>(value) << 1) ^
+                           static_cast<uint64_t>(value >> 63));
+}
+
+/// @brief Read a zigzag varint written by AppendSignedVarint().
+bool ReadSignedVarint(google::protobuf::io::CodedInputStream* input,
+                      int64_t* value) {
+  uint64_t encoded;
+  if (!input->ReadVarint64(&encoded)) {
+    return false;
+  }
+  *value = static_cast<int64_t>(encoded >> 1) ^
+           -static_cast<int64_t>(encoded & 1);
+  return true;
+}
+}  // namespace
+
+/// @brief Implementation of the asynchronous message writer.
+class AsyncMessageWriter::AsyncMessageWriterImpl {
+ public:
+  AsyncMessageWriterImpl(std::ostream* output, std::size_t buffer_size,
+                         std::size_t buffer_count);
+
+  ~AsyncMessageWriterImpl();
+
+  AsyncMessageWriterImpl(const AsyncMessageWriterImpl&) = delete;
+  AsyncMessageWriterImpl& operator=(const AsyncMessageWriterImpl&) = delete;
+
+  uint32_t WriteMessage(const google::protobuf::Message& message);
+  void Flush();
+  void Close();
+
+ private:
+  // A buffer of serialized messages.
+  struct Buffer {
+    std::vector<char> data;
+    std::size_t size = 0;
+
+    // If set, the output is flushed once the buffer is written and the
+    // promise is fulfilled.
+    std::promise<void>* written = nullptr;
+  };
+
+  std::ostream* output_;
+  std::size_t buffer_size_;
+
+  // Buffers waiting to be written, then those free to be filled.
+  BoundedQueue<Buffer> pending_;
+  BoundedQueue<Buffer> free_;
+  Buffer current_;
+
+  // Set by the writer thread once a write fails, after which nothing
+  // more is written.
+  std::atomic<bool> failed_ = false;
+  std::exception_ptr error_;
+
+  bool closed_ = false;
+  std::thread thread_;
+
+  /// @brief Throw if messages can no longer be written.
+  void CheckWritable() const;
+
+  /// @brief Queue the current buffer to be written and take a free one.
+  void Submit();
+
+  /// @brief Write buffers to the output until the writer is closed.
+  void WriteBuffers();
+};
+
+AsyncMessageWriter::AsyncMessageWriterImpl::AsyncMessageWriterImpl(
+    std::ostream* output, std::size_t buffer_size, std::size_t buffer_count)
+    : output_(output),
+      buffer_size_(buffer_size),
+      pending_(buffer_count),
+      free_(buffer_count) {
+  if (buffer_count < 2) {
+    throw std::invalid_argument("At least two buffers are required");
+  }
+
+  current_.data.resize(buffer_size_);
+  for (std::size_t i = 1; i < buffer_count; i++) {
+    auto buffer = Buffer();
+    buffer.data.resize(buffer_size_);
+    free_.Push(std::move(buffer));
+  }
+
+  thread_ = std::thread(&AsyncMessageWriterImpl::WriteBuffers, this);
+}
+
+AsyncMessageWriter::AsyncMessageWriterImpl::~AsyncMessageWriterImpl() {
+  try {
+    Close();
+  } catch (...) {
+    // Callers wanting to know if everything was written call Close().
+  }
+}
+
+uint32_t AsyncMessageWriter::AsyncMessageWriterImpl::WriteMessage(
+    const google::protobuf::Message& message) {
+  CheckWritable();
+
+  // Value changes dependent upon parameters of method call.
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  const auto size = static_cast<uint32_t>(message.ByteSizeLong());
+  const auto length = sizeof(uint32_t) + size;
+  if (current_.size + length > current_.data.size()) {
+    if (current_.size > 0) {
+      Submit();
+    }
+    if (length > current_.data.size()) {
+      current_.data.resize(length);
+    }
+  }
+
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t network_size = htonl(size);
+  auto* target = current_.data.data() + current_.size;
+  std::memcpy(target, &network_size, sizeof(network_size));
+
+  // The size was just computed, so it is cached in the message.
+  message.SerializeWithCachedSizesToArray(
+      reinterpret_cast<uint8_t*>(target + sizeof(network_size)));
+  current_.size += length;
+  return size;
+}
+
+void AsyncMessageWriter::AsyncMessageWriterImpl::Flush() {
+  CheckWritable();
+
+  auto written = std::promise<void>();
+  auto future = written.get_future();
+  current_.written = &written;
+  Submit();
+  future.get();
+}
+
+void AsyncMessageWriter::AsyncMessageWriterImpl::Close() {
+  if (closed_) {
+    return;
+  }
+
+  std::exception_ptr error;
+  try {
+    Flush();
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  closed_ = true;
+  pending_.Close();
+  thread_.join();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncMessageWriter::AsyncMessageWriterImpl::CheckWritable() const {
+  if (closed_) {
+    throw std::runtime_error("Message writer has been closed");
+  }
+  if (failed_.load(std::memory_order_acquire)) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void AsyncMessageWriter::AsyncMessageWriterImpl::Submit() {
+  pending_.Push(std::move(current_));
+
+  // There are as many free buffers as there are buffers in total, so
+  // taking one only waits for a pending buffer to be written.
+  current_ = std::move(*free_.Pop());
+}
+
+void AsyncMessageWriter::AsyncMessageWriterImpl::WriteBuffers() {
+  while (auto buffer = pending_.Pop()) {
+    if (!failed_.load(std::memory_order_relaxed)) {
+      output_->write(buffer->data.data(),
+                     static_cast<std::streamsize>(buffer->size));
+      if (buffer->written != nullptr) {
+        output_->flush();
+      }
+
+      if (!*output_) {
+        error_ = std::make_exception_ptr(
+            std::runtime_error("Could not write messages to output stream"));
+        failed_.store(true, std::memory_order_release);
+      }
+    }
+
+    if (buffer->written != nullptr) {
+      if (failed_.load(std::memory_order_relaxed)) {
+        buffer->written->set_exception(error_);
+      } else {
+        buffer->written->set_value();
+      }
+    }
+
+    // Give back the memory of a buffer grown for a large message.
+    if (buffer->data.size() > buffer_size_) {
+      buffer->data.resize(buffer_size_);
+      buffer->data.shrink_to_fit();
+    }
+    buffer->size = 0;
+    buffer->written = nullptr;
+    free_.Push(std::move(*buffer));
+  }
+}
+
+AsyncMessageWriter::AsyncMessageWriter(std::ostream* output,
+                                       std::size_t buffer_size,
+                                       std::size_t buffer_count)
+    : impl_(std::make_unique<AsyncMessageWriterImpl>(output, buffer_size,
+                                                     buffer_count)) {}
+
+AsyncMessageWriter::~AsyncMessageWriter() = default;
+
+uint32_t AsyncMessageWriter::WriteMessage(
+    const google::protobuf::Message& message) {
+  return impl_->WriteMessage(message);
+}
+
+void AsyncMessageWriter::Flush() { impl_->Flush(); }
+
+void AsyncMessageWriter::Close() { impl_->Close(); }
+
+/// @brief Implementation of the compact revision writer.
+class CompactRevisionWriter::CompactRevisionWriterImpl {
+ public:
+  CompactRevisionWriterImpl(std::ostream* output, std::size_t block_size)
+      : output_(output), block_size_(block_size) {}
+
+  uint64_t WriteRevision(const proto::Revision& revision);
+  uint64_t Flush();
+
+ private:
+  std::ostream* output_;
+  std::size_t block_size_;
+
+  // Contributors of the current block, by their index in it.
+  std::vector<std::string> contributors_;
+  boost::unordered_flat_map<std::string, uint64_t> contributor_indices_;
+
+  // Encoded revisions of the current block.
+  std::string revisions_;
+  std::size_t revision_count_ = 0;
+  uint64_t previous_revision_id_ = 0;
+  int64_t previous_seconds_ = 0;
+};
+
+uint64_t CompactRevisionWriter::CompactRevisionWriterImpl::WriteRevision(
+    const proto::Revision& revision) {
+  const auto revision_id = revision.revision_id();
+  AppendSignedVarint(
+      &revisions_, static_cast<int64_t>(revision_id - previous_revision_id_));
+  AppendSignedVarint(
+      &revisions_, static_cast<int64_t>(revision_id - revision.parent_id()));
+  previous_revision_id_ = revision_id;
+
+  auto [contributor, inserted] = contributor_indices_.try_emplace(
+      revision.user(), contributors_.size());
+  if (inserted) {
+    contributors_.push_back(revision.user());
+  }
+  AppendVarint(&revisions_, contributor->second);
+
+  if (revision.has_timestamp()) {
+    const auto& timestamp = revision.timestamp();
+    AppendVarint(&revisions_, static_cast<uint64_t>(timestamp.nanos()) + 1);
+    AppendSignedVarint(&revisions_, timestamp.seconds() - previous_seconds_);
+    previous_seconds_ = timestamp.seconds();
+  } else {
+    AppendVarint(&revisions_, 0);
+  }
+
+  revision_count_++;
+  return revision_count_ >= block_size_ ? Flush() : 0;
+}
+
+uint64_t CompactRevisionWriter::CompactRevisionWriterImpl::Flush() {
+  if (revision_count_ == 0) {
+    return 0;
+  }
+
+  auto block = std::string(sizeof(uint32_t), '\0');
+  AppendVarint(&block, contributors_.size());
+  for (const auto& contributor : contributors_) {
+    AppendVarint(&block, contributor.size());
+    block += contributor;
+  }
+  AppendVarint(&block, revision_count_);
+  block += revisions_;
+
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t network_size =
+      htonl(static_cast<uint32_t>(block.size() - sizeof(uint32_t)));
+  std::memcpy(block.data(), &network_size, sizeof(network_size));
+
+  contributors_.clear();
+  contributor_indices_.clear();
+  revisions_.clear();
+  revision_count_ = 0;
+  previous_revision_id_ = 0;
+  previous_seconds_ = 0;
+
+  output_->write(block.data(), static_cast<std::streamsize>(block.size()));
+  if (!*output_) {
+    throw std::runtime_error("Could not write revisions to output stream");
+  }
+  return block.size();
+}
+
+CompactRevisionWriter::CompactRevisionWriter(std::ostream* output,
+                                             std::size_t block_size)
+    : impl_(std::make_unique<CompactRevisionWriterImpl>(output,
+                                                        block_size)) {}
+
+CompactRevisionWriter::~CompactRevisionWriter() {
+  try {
+    impl_->Flush();
+  } catch (...) {
+    // Callers wanting to know if everything was written call Flush().
+  }
+}
+
+uint64_t CompactRevisionWriter::WriteRevision(
+    const proto::Revision& revision) {
+  return impl_->WriteRevision(revision);
+}
+
+uint64_t CompactRevisionWriter::Flush() { return impl_->Flush(); }
+
+/// @brief Implementation of the compact revision reader.
+class CompactRevisionReader::CompactRevisionReaderImpl {
+ public:
+  explicit CompactRevisionReaderImpl(std::istream* input) : input_(input) {}
+
+  std::unique_ptr<proto::Revision> ReadRevision();
+
+ private:
+  std::istream* input_;
+
+  // The block being read, and the revisions left in it.
+  std::string block_;
+  std::unique_ptr<google::protobuf::io::CodedInputStream> block_input_;
+  uint64_t remaining_ = 0;
+
+  std::vector<std::string> contributors_;
+  uint64_t previous_revision_id_ = 0;
+  int64_t previous_seconds_ = 0;
+
+  /// @brief Read the next block holding any revisions.
+  /// @return False at the end of the stream.
+  bool ReadBlock();
+
+  [[noreturn]] static void ThrowMalformed();
+};
+
+std::unique_ptr<proto::Revision>
+CompactRevisionReader::CompactRevisionReaderImpl::ReadRevision() {
+  if (remaining_ == 0 && !ReadBlock()) {
+    return nullptr;
+  }
+
+  auto revision = std::make_unique<proto::Revision>();
+  int64_t id_delta;
+  int64_t parent_delta;
+  uint64_t contributor;
+  uint64_t nanos;
+  if (!ReadSignedVarint(block_input_.get(), &id_delta) ||
+      !ReadSignedVarint(block_input_.get(), &parent_delta) ||
+      !block_input_->ReadVarint64(&contributor) ||
+      contributor >= contributors_.size() ||
+      !block_input_->ReadVarint64(&nanos)) {
+    ThrowMalformed();
+  }
+
+  previous_revision_id_ += static_cast<uint64_t>(id_delta);
+  revision->set_revision_id(previous_revision_id_);
+  revision->set_parent_id(previous_revision_id_ -
+                          static_cast<uint64_t>(parent_delta));
+  revision->set_user(contributors_[contributor]);
+
+  if (nanos > 0) {
+    int64_t seconds_delta;
+    if (!ReadSignedVarint(block_input_.get(), &seconds_delta)) {
+      ThrowMalformed();
+    }
+    previous_seconds_ += seconds_delta;
+    revision->mutable_timestamp()->set_seconds(previous_seconds_);
+    revision->mutable_timestamp()->set_nanos(static_cast<int32_t>(nanos - 1));
+  }
+
+  remaining_--;
+  return revision;
+}
+
+bool CompactRevisionReader::CompactRevisionReaderImpl::ReadBlock() {
+  while (remaining_ == 0) {
+    uint32_t size;
+    input_->read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (input_->gcount() == 0) {
+      return false;
+    }
+    if (input_->gcount() != sizeof(size)) {
+      ThrowMalformed();
+    }
+
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    block_.resize(ntohl(size));
+    input_->read(block_.data(), static_cast<std::streamsize>(block_.size()));
+    if (input_->gcount() != static_cast<std::streamsize>(block_.size())) {
+      ThrowMalformed();
+    }
+
+    block_input_ = std::make_unique<google::protobuf::io::CodedInputStream>(
+        reinterpret_cast<const uint8_t*>(block_.data()),
+        static_cast<int>(block_.size()));
+
+    uint64_t contributor_count;
+    if (!block_input_->ReadVarint64(&contributor_count) ||
+        contributor_count > block_.size()) {
+      ThrowMalformed();
+    }
+    contributors_.resize(contributor_count);
+    for (auto& contributor : contributors_) {
+      uint32_t length;
+      if (!block_input_->ReadVarint32(&length) ||
+          !block_input_->ReadString(&contributor, static_cast<int>(length))) {
+        ThrowMalformed();
+      }
+    }
+
+    if (!block_input_->ReadVarint64(&remaining_)) {
+      ThrowMalformed();
+    }
+    previous_revision_id_ = 0;
+    previous_seconds_ = 0;
+  }
+  return true;
+}
+
+void CompactRevisionReader::CompactRevisionReaderImpl::ThrowMalformed() {
+  throw std::runtime_error("Compact revision stream is truncated or malformed");
+}
+
+CompactRevisionReader::CompactRevisionReader(std::istream* input)
+    : impl_(std::make_unique<CompactRevisionReaderImpl>(input)) {}
+
+CompactRevisionReader::~CompactRevisionReader() = default;
+
+std::unique_ptr<proto::Revision> CompactRevisionReader::ReadRevision() {
+  return impl_->ReadRevision();
+}
+}  // namespace wikiopencite::citescoop
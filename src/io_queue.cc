@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "io_queue.h"
+
+// NOLINTBEGIN(misc-include-cleaner)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+// NOLINTEND(misc-include-cleaner)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include "extract/worker_pool.h"
+
+namespace wikiopencite::citescoop {
+
+namespace {
+/// @brief Continue a request until it is complete, the end of the file
+/// is reached or it fails.
+void Transfer(int descriptor, IoRequest* request) {
+  while (request->result >= 0 &&
+         static_cast<std::size_t>(request->result) < request->length) {
+    auto done = static_cast<std::size_t>(request->result);
+    auto* data = request->data + done;
+    auto length = request->length - done;
+    auto offset = static_cast<off_t>(request->offset + done);
+    auto count = request->write ? pwrite(descriptor, data, length, offset)
+                                : pread(descriptor, data, length, offset);
+    if (count < 0) {
+      if (errno != EINTR) {
+        request->result = -errno;
+      }
+      continue;
+    }
+    if (count == 0) {
+      return;
+    }
+    request->result += count;
+  }
+}
+
+/// @brief Queue making requests with blocking calls on a worker pool.
+class ThreadIoQueue : public IoQueue {
+ public:
+  ThreadIoQueue(int descriptor, unsigned int depth)
+      : descriptor_(descriptor), pool_(depth) {}
+
+  void Submit(IoRequest* request) override {
+    request->result = 0;
+    request->complete = false;
+    request->pending = pool_.Submit([this, request]() {
+      Transfer(descriptor_, request);
+      return request->result;
+    });
+  }
+
+  void Wait(IoRequest* request) override {
+    if (!request->complete) {
+      request->result = request->pending.get();
+      request->complete = true;
+    }
+  }
+
+  bool uses_io_uring() const override { return false; }
+
+ private:
+  int descriptor_;
+  WorkerPool pool_;
+};
+
+/// @brief Queue making requests with io_uring.
+///
+/// This talks to the kernel directly rather than through liburing: the
+/// submission and completion rings are mapped into memory, requests are
+/// added to the tail of the submission ring and completions are taken
+/// from the head of the completion ring. Only one thread may use the
+/// queue.
+class UringIoQueue : public IoQueue {
+ public:
+  /// @brief Set up a ring.
+  /// @return The queue, or null if io_uring is unavailable.
+  static std::unique_ptr<UringIoQueue> Create(int descriptor,
+                                              unsigned int depth) {
+    auto params = io_uring_params();
+    std::memset(&params, 0, sizeof(params));
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    auto ring = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (ring < 0) {
+      return nullptr;
+    }
+
+    auto queue = std::unique_ptr<UringIoQueue>(new UringIoQueue(descriptor));
+    queue->ring_ = ring;
+    if (!queue->Map(params)) {
+      return nullptr;
+    }
+    return queue;
+  }
+
+  ~UringIoQueue() override {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_ >= 0) {
+      close(ring_);
+    }
+  }
+
+  UringIoQueue(const UringIoQueue&) = delete;
+  UringIoQueue& operator=(const UringIoQueue&) = delete;
+
+  void Submit(IoRequest* request) override {
+    request->result = 0;
+    request->complete = false;
+    request->vector.iov_base = request->data;
+    request->vector.iov_len = request->length;
+
+    auto tail = *sq_tail_;
+    auto index = tail & *sq_mask_;
+    auto* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = descriptor_;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->vector);
+    sqe->len = 1;
+    sqe->off = request->offset;
+    sqe->user_data = reinterpret_cast<uint64_t>(request);
+    sq_array_[index] = index;
+    std::atomic_ref(*sq_tail_).store(tail + 1, std::memory_order_release);
+
+    while (Enter(1, 0, 0) < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Could not submit io_uring request");
+      }
+      // Free completion slots before trying again.
+      Reap();
+    }
+  }
+
+  void Wait(IoRequest* request) override {
+    Reap();
+    while (!request->complete) {
+      if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Could not wait for io_uring request");
+      }
+      Reap();
+    }
+
+    if (request->result == -EINTR || request->result == -EAGAIN) {
+      request->result = 0;
+    }
+    Transfer(descriptor_, request);
+  }
+
+  bool uses_io_uring() const override { return true; }
+
+ private:
+  int descriptor_;
+  int ring_ = -1;
+
+  void* sq_ring_ = nullptr;
+  std::size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  std::size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  std::size_t sqes_size_ = 0;
+
+  unsigned int* sq_tail_ = nullptr;
+  unsigned int* sq_mask_ = nullptr;
+  unsigned int* sq_array_ = nullptr;
+  unsigned int* cq_head_ = nullptr;
+  unsigned int* cq_tail_ = nullptr;
+  unsigned int* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+
+  explicit UringIoQueue(int descriptor) : descriptor_(descriptor) {}
+
+  /// @brief Map the rings into memory.
+  /// @return False if they could not be mapped.
+  bool Map(const io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = MapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) {
+      return false;
+    }
+    cq_ring_ =
+        single_mmap ? sq_ring_ : MapRing(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(MapRing(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) {
+      return false;
+    }
+
+    auto* sq = static_cast<char*>(sq_ring_);
+    auto* cq = static_cast<char*>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void* MapRing(std::size_t size, uint64_t offset) const {
+    auto* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_,
+                        static_cast<off_t>(offset));
+    return mapped == MAP_FAILED ? nullptr : mapped;
+  }
+
+  int Enter(unsigned int to_submit, unsigned int min_complete,
+            unsigned int flags) const {
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_, to_submit,
+                                    min_complete, flags, nullptr, 0));
+  }
+
+  /// @brief Record the results of every completed request.
+  void Reap() {
+    auto head = *cq_head_;
+    auto tail = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire);
+    while (head != tail) {
+      const auto& cqe = cqes_[head & *cq_mask_];
+      // NOLINTNEXTLINE(performance-no-int-to-ptr)
+      auto* request = reinterpret_cast<IoRequest*>(cqe.user_data);
+      request->result = cqe.res;
+      request->complete = true;
+      head++;
+    }
+    std::atomic_ref(*cq_head_).store(head, std::memory_order_release);
+  }
+};
+}  // namespace
+
+std::unique_ptr<IoQueue> IoQueue::Create(int descriptor, unsigned int depth,
+                                         bool use_io_uring) {
+  depth = std::max(depth, 1U);
+  if (use_io_uring) {
+    auto queue = UringIoQueue::Create(descriptor, depth);
+    if (queue != nullptr) {
+      return queue;
+    }
+  }
+  return std::make_unique<ThreadIoQueue>(descriptor, depth);
+}
+
+}  // namespace wikiopencite::citescoop
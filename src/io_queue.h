@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_IO_QUEUE_H_
+#define SRC_IO_QUEUE_H_
+
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+
+namespace wikiopencite::citescoop {
+
+/// @brief A read or write of a block of a file, queued on an IoQueue.
+struct IoRequest {
+  /// Whether the request is a write rather than a read
+  bool write = false;
+
+  /// Buffer to read into or write from, which must stay valid until the
+  /// request has completed
+  char* data = nullptr;
+
+  /// Number of bytes to read or write
+  std::size_t length = 0;
+
+  /// Offset in the file to read or write at
+  uint64_t offset = 0;
+
+  /// Number of bytes read or written once complete, or a negated errno.
+  /// A read is only short at the end of the file.
+  int64_t result = 0;
+
+  /// Whether the request has completed
+  bool complete = false;
+
+  /// Buffer descriptor handed to io_uring
+  iovec vector{};
+
+  /// Result of a request made on a background thread
+  std::future<int64_t> pending;
+};
+
+/// @brief Queue of reads and writes made asynchronously on one file.
+///
+/// Requests are made with io_uring where the kernel supports it, with
+/// blocking reads and writes on background threads as a fallback. The
+/// caller must wait for every request it submits before the queue is
+/// destroyed.
+class IoQueue {
+ public:
+  virtual ~IoQueue() = default;
+
+  /// @brief Create a queue for a file.
+  /// @param descriptor Open file descriptor, which must outlive the
+  /// queue.
+  /// @param depth Maximum number of requests in flight at once.
+  /// @param use_io_uring Whether to try io_uring before falling back to
+  /// background threads.
+  /// @return The new queue.
+  static std::unique_ptr<IoQueue> Create(int descriptor, unsigned int depth,
+                                         bool use_io_uring);
+
+  /// @brief Start a request.
+  /// @param request Request to start, which must stay valid until it
+  /// has been waited for.
+  virtual void Submit(IoRequest* request) = 0;
+
+  /// @brief Wait for a request to complete, finishing any partial read
+  /// or write synchronously.
+  /// @param request Previously submitted request.
+  virtual void Wait(IoRequest* request) = 0;
+
+  /// @brief Check if requests are made with io_uring.
+  /// @return True if io_uring is used, false for background threads.
+  virtual bool uses_io_uring() const = 0;
+};
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_IO_QUEUE_H_
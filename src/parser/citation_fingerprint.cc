@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "citation_fingerprint.h"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "citescoop/proto/extracted_citation.pb.h"
+#include "citescoop/proto/url.pb.h"
+
+namespace wikiopencite::citescoop {
+namespace proto = wikiopencite::proto;
+
+namespace {
+const uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+const uint64_t kPrime = 0x100000001b3ULL;
+const std::size_t kKeyLength = 16;
+const char kHexDigits[] = "0123456789abcdef";
+
+/// @brief Incremental 64-bit FNV-1a hash.
+class Fnv1a {
+ public:
+  void Add(char c) {
+    hash_ ^= static_cast<unsigned char>(c);
+    hash_ *= kPrime;
+  }
+
+  void Add(uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      Add(static_cast<char>(value >> (i * 8)));
+    }
+  }
+
+  /// @brief Add a field, tagged so that fields can't run into each
+  /// other.
+  void AddField(char tag, std::string_view value) {
+    Add(tag);
+    Add(static_cast<uint64_t>(value.size()));
+    for (auto c : value) {
+      Add(c);
+    }
+  }
+
+  uint64_t hash() const { return hash_; }
+
+ private:
+  uint64_t hash_ = kOffsetBasis;
+};
+
+char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/// @brief Lower case text and collapse runs of whitespace.
+std::string NormalizeText(std::string_view text) {
+  auto normalized = std::string();
+  normalized.reserve(text.size());
+  auto pending_space = false;
+  for (auto c : text) {
+    if (IsSpace(c)) {
+      pending_space = !normalized.empty();
+      continue;
+    }
+    if (pending_space) {
+      normalized.push_back(' ');
+      pending_space = false;
+    }
+    normalized.push_back(ToLower(c));
+  }
+  return normalized;
+}
+
+/// @brief Upper case an ISBN or ISSN and remove separators.
+std::string NormalizeStandardNumber(std::string_view number) {
+  auto normalized = std::string();
+  normalized.reserve(number.size());
+  for (auto c : number) {
+    if (c != '-' && !IsSpace(c)) {
+      normalized.push_back(c == 'x' ? 'X' : c);
+    }
+  }
+  return normalized;
+}
+}  // namespace
+
+uint64_t FingerprintCitation(const proto::ExtractedCitation& citation) {
+  auto hash = Fnv1a();
+  auto identified = !citation.title().empty();
+  hash.AddField('t', NormalizeText(citation.title()));
+
+  const auto& identifiers = citation.identifiers();
+  if (identifiers.has_doi()) {
+    hash.AddField('d', NormalizeText(identifiers.doi()));
+    identified = true;
+  }
+  if (identifiers.has_isbn()) {
+    hash.AddField('b', NormalizeStandardNumber(identifiers.isbn()));
+    identified = true;
+  }
+  if (identifiers.has_pmid()) {
+    hash.Add('p');
+    hash.Add(static_cast<uint64_t>(identifiers.pmid()));
+    identified = true;
+  }
+  if (identifiers.has_pmcid()) {
+    hash.Add('c');
+    hash.Add(static_cast<uint64_t>(identifiers.pmcid()));
+    identified = true;
+  }
+  if (identifiers.has_issn()) {
+    hash.AddField('s', NormalizeStandardNumber(identifiers.issn()));
+    identified = true;
+  }
+
+  if (!identified) {
+    for (const auto& url : citation.urls()) {
+      hash.AddField('u', url.url());
+    }
+  }
+
+  return hash.hash();
+}
+
+std::string FingerprintKey(uint64_t fingerprint) {
+  auto key = std::string(kKeyLength, '0');
+  for (auto i = key.rbegin(); i != key.rend(); ++i) {
+    *i = kHexDigits[fingerprint & 0xF];
+    fingerprint >>= 4;
+  }
+  return key;
+}
+
+uint64_t KeyFingerprint(std::string_view key) {
+  uint64_t fingerprint = 0;
+  auto [ptr, error] =
+      std::from_chars(key.data(), key.data() + key.size(), fingerprint, 16);
+  if (error != std::errc() || ptr != key.data() + key.size()) {
+    return 0;
+  }
+  return fingerprint;
+}
+
+}  // namespace wikiopencite::citescoop
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SRC_PARSER_CITATION_FINGERPRINT_H_
+#define SRC_PARSER_CITATION_FINGERPRINT_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "citescoop/proto/extracted_citation.pb.h"
+
+namespace wikiopencite::citescoop {
+
+/// @brief Compute the fingerprint identifying a citation.
+///
+/// The fingerprint is a 64-bit FNV-1a hash of the citation's normalized
+/// title and identifiers, so it is the same across runs and platforms.
+/// Titles are compared ignoring case and runs of whitespace, DOIs
+/// ignoring case and ISBNs and ISSNs ignoring hyphens and spaces. A
+/// citation with neither a title nor identifiers is identified by its
+/// URLs instead.
+///
+/// @param citation Citation to fingerprint.
+/// @return The citation's fingerprint.
+uint64_t FingerprintCitation(
+    const wikiopencite::proto::ExtractedCitation& citation);
+
+/// @brief Format a fingerprint as the key of a citation in
+/// RevisionCitations.
+/// @param fingerprint Citation fingerprint.
+/// @return Fingerprint as 16 lower case hexadecimal digits.
+std::string FingerprintKey(uint64_t fingerprint);
+
+/// @brief Get the fingerprint back from a citation's key.
+/// @param key Key created by FingerprintKey().
+/// @return The fingerprint, or 0 if the key is not a fingerprint.
+uint64_t KeyFingerprint(std::string_view key);
+}  // namespace wikiopencite::citescoop
+
+#endif  // SRC_PARSER_CITATION_FINGERPRINT_H_
@@ -6,6 +6,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "citescoop/proto/revision_citations.pb.h"
 
@@ -28,10 +29,18 @@ Parser::Parser(const std::function<bool(const std::string&)>& filter,
 
 Parser::~Parser() = default;
 
-wikiopencite::proto::RevisionCitations Parser::Parse(const std::string& text) {
+wikiopencite::proto::RevisionCitations Parser::Parse(std::string_view text) {
   return this->impl_->Parse(text);
 }
 
+wikiopencite::proto::RevisionCitations Parser::Parse(const std::string& text) {
+  return this->Parse(std::string_view(text));
+}
+
+wikiopencite::proto::RevisionCitations Parser::Parse(const char* text) {
+  return this->Parse(std::string_view(text));
+}
+
 ParserOptions Parser::options() {
   return this->impl_->options();
 }
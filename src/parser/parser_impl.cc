@@ -7,6 +7,7 @@
 #include <functional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -19,6 +20,8 @@
 #include "citescoop/proto/revision_citations.pb.h"
 #include "citescoop/proto/url.pb.h"
 
+#include "citation_fingerprint.h"
+
 namespace wikiopencite::citescoop {
 
 namespace {
@@ -62,7 +65,7 @@ Parser::ParserImpl::ParserImpl(std::function<bool(const std::string&)> filter,
     // NOLINTNEXTLINE(whitespace/indent_namespace)
     : filter_(std::move(filter)), options_(options) {}
 
-proto::RevisionCitations Parser::ParserImpl::Parse(const std::string& text) {
+proto::RevisionCitations Parser::ParserImpl::Parse(std::string_view text) {
   auto citations = proto::RevisionCitations();
 
   auto first = text.begin();
@@ -79,7 +82,8 @@ proto::RevisionCitations Parser::ParserImpl::Parse(const std::string& text) {
 
       if (filter_(normalised_name)) {
         auto citation = BuildCitation(result);
-        citations.mutable_citations()->insert({citation.title(), citation});
+        citations.mutable_citations()->insert(
+            {FingerprintKey(FingerprintCitation(citation)), citation});
       }
     }
 
@@ -7,6 +7,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "citescoop/parser.h"
@@ -36,7 +37,7 @@ class Parser::ParserImpl {
   /// @param text WikiText input.
   ///
   /// @return List of the extracted citations.
-  wikiopencite::proto::RevisionCitations Parse(const std::string& text);
+  wikiopencite::proto::RevisionCitations Parse(std::string_view text);
 
   /// @brief Get configured parser options.
   ///
@@ -94,3 +94,227 @@ TEST_CASE(kTestNamePrefix + "Streaming input / output",
   auto revision = revision_reader.ReadMessage<proto::Revision>();
   REQUIRE(revision->revision_id() == 5);
 }
+
+/// Check that multistream extraction gives the same result as
+/// extracting the dump sequentially.
+TEST_CASE(kTestNamePrefix + "Multistream extraction",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::Bz2Extractor(parser, cs::ExtractorOptions{.threads = 2});
+
+  std::ifstream file(FILE("data/multiple-pages-multistream.xml.bz2"));
+  REQUIRE(file.is_open());
+  std::ifstream index(FILE("data/multiple-pages-multistream-index.txt.bz2"));
+  REQUIRE(index.is_open());
+
+  const int kPage1RevisionAdded = 5;
+  const int kPage2RevisionAdded = 8;
+
+  auto pair = extractor.ExtractMultistream(file, index);
+  auto result = std::move(pair.first);
+  REQUIRE(result->size() == 2);
+
+  auto page1 = result->at(0);
+  REQUIRE(page1.title() == "My Page");
+  REQUIRE(page1.page_id() == 1);
+  REQUIRE(page1.citations_size() == 1);
+  REQUIRE(page1.citations().at(0).revision_added() == kPage1RevisionAdded);
+
+  auto page2 = result->at(1);
+  REQUIRE(page2.title() == "My Second Page");
+  REQUIRE(page2.page_id() == 2);
+  REQUIRE(page2.citations_size() == 1);
+  REQUIRE(page2.citations().at(0).revision_added() == kPage2RevisionAdded);
+
+  REQUIRE(pair.second->size() == 2);
+  REQUIRE(pair.second->at(kPage1RevisionAdded).revision_id() ==
+          kPage1RevisionAdded);
+  REQUIRE(pair.second->at(kPage2RevisionAdded).revision_id() ==
+          kPage2RevisionAdded);
+}
+
+/// Check that multistream extraction handles streaming correctly.
+TEST_CASE(kTestNamePrefix + "Multistream streaming input / output",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::Bz2Extractor(parser, cs::ExtractorOptions{.threads = 2});
+
+  auto pages_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto page_reader = cs::MessageReader(&pages_stream);
+  pages_stream.clear();
+
+  auto revisions_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto revision_reader = cs::MessageReader(&revisions_stream);
+  revisions_stream.clear();
+
+  std::ifstream file(FILE("data/multiple-pages-multistream.xml.bz2"));
+  REQUIRE(file.is_open());
+  std::ifstream index(FILE("data/multiple-pages-multistream-index.txt.bz2"));
+  REQUIRE(index.is_open());
+
+  auto pair = extractor.ExtractMultistream(file, index, &pages_stream,
+                                           &revisions_stream);
+  REQUIRE(pair.first == 2);
+  REQUIRE(pair.second == 2);
+
+  pages_stream.clear();
+  pages_stream.seekg(0);
+  revisions_stream.clear();
+  revisions_stream.seekg(0);
+
+  auto page = page_reader.ReadMessage<proto::Page>();
+  REQUIRE(page->page_id() == 1);
+  page = page_reader.ReadMessage<proto::Page>();
+  REQUIRE(page->page_id() == 2);
+
+  auto revision = revision_reader.ReadMessage<proto::Revision>();
+  REQUIRE(revision->revision_id() == 5);
+  revision = revision_reader.ReadMessage<proto::Revision>();
+  REQUIRE(revision->revision_id() == 8);
+}
+
+/// Check that a plain text multistream index can be used.
+TEST_CASE(kTestNamePrefix + "Multistream extraction with plain text index",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::Bz2Extractor(
+      parser, cs::ExtractorOptions{.threads = 1, .preserve_order = false});
+
+  std::ifstream file(FILE("data/multiple-pages-multistream.xml.bz2"));
+  REQUIRE(file.is_open());
+  auto index = std::stringstream("393:1:My Page\n785:2:My Second Page\n");
+
+  auto pair = extractor.ExtractMultistream(file, index);
+  REQUIRE(pair.first->size() == 2);
+  REQUIRE(pair.second->size() == 2);
+}
+
+/// Check that decompressing the blocks of a dump in parallel gives the
+/// same result as decompressing it sequentially.
+TEST_CASE(kTestNamePrefix + "Parallel block decompression",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto sequential_extractor = cs::Bz2Extractor(parser);
+  auto parallel_extractor = cs::Bz2Extractor(
+      parser, cs::ExtractorOptions{.decompression_threads = 4});
+
+  const int kPages = 2000;
+
+  std::ifstream sequential_file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(sequential_file.is_open());
+  auto expected = sequential_extractor.Extract(sequential_file);
+  REQUIRE(expected.first->size() == kPages);
+
+  std::ifstream parallel_file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(parallel_file.is_open());
+  auto actual = parallel_extractor.Extract(parallel_file);
+  REQUIRE(actual.first->size() == kPages);
+  REQUIRE(actual.second->size() == expected.second->size());
+
+  for (std::size_t i = 0; i < kPages; i++) {
+    REQUIRE(actual.first->at(i).SerializeAsString() ==
+            expected.first->at(i).SerializeAsString());
+  }
+}
+
+/// Check that pipelined extraction of a compressed dump gives the same
+/// result as sequential extraction.
+TEST_CASE(kTestNamePrefix + "Pipelined extraction",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto sequential_extractor = cs::Bz2Extractor(parser);
+  auto pipelined_extractor = cs::Bz2Extractor(
+      parser, cs::ExtractorOptions{.threads = 4,
+                                   .decompression_threads = 2,
+                                   .pipeline = true});
+
+  std::ifstream sequential_file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(sequential_file.is_open());
+  auto expected = sequential_extractor.Extract(sequential_file);
+
+  std::ifstream pipelined_file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(pipelined_file.is_open());
+  auto actual = pipelined_extractor.Extract(pipelined_file);
+
+  REQUIRE(actual.first->size() == expected.first->size());
+  REQUIRE(actual.second->size() == expected.second->size());
+  for (std::size_t i = 0; i < expected.first->size(); i++) {
+    REQUIRE(actual.first->at(i).SerializeAsString() ==
+            expected.first->at(i).SerializeAsString());
+  }
+}
+
+/// Check that iterating over the pages of a compressed dump gives the
+/// same result as extracting it in one go.
+TEST_CASE(kTestNamePrefix + "Lazy page iteration",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::Bz2Extractor(parser);
+
+  std::ifstream expected_file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(expected_file.is_open());
+  auto expected = extractor.Extract(expected_file);
+
+  std::ifstream file(FILE("data/many-pages.xml.bz2"));
+  REQUIRE(file.is_open());
+  auto pages = extractor.Pages(file);
+
+  std::size_t page_index = 0;
+  for (const auto& extracted : pages) {
+    REQUIRE(page_index < expected.first->size());
+    REQUIRE(extracted.page.SerializeAsString() ==
+            expected.first->at(page_index).SerializeAsString());
+    for (const auto& [revision_id, revision] : extracted.revisions) {
+      REQUIRE(revision.SerializeAsString() ==
+              expected.second->at(revision_id).SerializeAsString());
+    }
+    page_index++;
+  }
+  REQUIRE(page_index == expected.first->size());
+}
+
+/// Check that single pages can be extracted from a multistream dump by
+/// ID and by title.
+TEST_CASE(kTestNamePrefix + "Single page multistream extraction",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::Bz2Extractor(parser);
+
+  std::ifstream expected_file(FILE("data/multiple-pages-multistream.xml.bz2"));
+  REQUIRE(expected_file.is_open());
+  std::ifstream expected_index(
+      FILE("data/multiple-pages-multistream-index.txt.bz2"));
+  REQUIRE(expected_index.is_open());
+  auto expected = extractor.ExtractMultistream(expected_file, expected_index);
+  REQUIRE(expected.first->size() == 2);
+
+  std::ifstream index_file(
+      FILE("data/multiple-pages-multistream-index.txt.bz2"));
+  REQUIRE(index_file.is_open());
+  auto index = cs::MultistreamDumpIndex(index_file);
+  REQUIRE(index.size() == 2);
+
+  std::ifstream file(FILE("data/multiple-pages-multistream.xml.bz2"));
+  REQUIRE(file.is_open());
+
+  // Look up the second page first, to check the input is seeked.
+  auto page2 = extractor.ExtractPage(file, index, 2);
+  REQUIRE(page2.has_value());
+  REQUIRE(page2->page.SerializeAsString() ==
+          expected.first->at(1).SerializeAsString());
+  REQUIRE(page2->revisions.size() == 1);
+  REQUIRE(page2->revisions.contains(8));
+
+  auto page1 = extractor.ExtractPage(file, index, std::string("My Page"));
+  REQUIRE(page1.has_value());
+  REQUIRE(page1->page.SerializeAsString() ==
+          expected.first->at(0).SerializeAsString());
+  REQUIRE(page1->revisions.at(5).SerializeAsString() ==
+          expected.second->at(5).SerializeAsString());
+
+  REQUIRE_FALSE(extractor.ExtractPage(file, index, 3).has_value());
+  REQUIRE_FALSE(
+      extractor.ExtractPage(file, index, std::string("Missing")).has_value());
+}
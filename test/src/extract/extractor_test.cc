@@ -1,12 +1,22 @@
 // SPDX-FileCopyrightText: 2025 The University of St Andrews
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -23,6 +33,38 @@ const std::string kTestNamePrefix = "[Extractor] ";
 namespace cs = wikiopencite::citescoop;
 namespace proto = wikiopencite::proto;
 
+namespace {
+/// Page sink copying every page and revision it consumes.
+class CollectingPageSink : public cs::PageSink {
+ public:
+  void Consume(const proto::Page& page,
+               const std::map<uint64_t, const proto::Revision*>&
+                   page_revisions) override {
+    pages.push_back(page);
+    for (const auto& [revision_id, revision] : page_revisions) {
+      revisions.emplace(revision_id, *revision);
+    }
+  }
+
+  std::vector<proto::Page> pages;
+  std::map<uint64_t, proto::Revision> revisions;
+};
+
+/// Page sink taking ownership of the pages it is allowed to move.
+class MovingPageSink : public CollectingPageSink {
+ public:
+  using CollectingPageSink::Consume;
+
+  void Consume(cs::ExtractedPage&& page) override {
+    pages.push_back(std::move(page.page));
+    revisions.merge(page.revisions);
+    pages_moved++;
+  }
+
+  std::size_t pages_moved = 0;
+};
+}  // namespace
+
 /// Check that the extractor can handle extracting a single citation
 /// from a single page containing a single revision.
 TEST_CASE(kTestNamePrefix + "Extract single citation from single revision",
@@ -360,3 +402,1232 @@ TEST_CASE(kTestNamePrefix + "Streaming input / output multiple pages",
   revision = revision_reader.ReadMessage<proto::Revision>();
   REQUIRE(revision->revision_id() == 8);
 }
+
+/// Check that the pipelined extractor gives the same result as the
+/// sequential extractor.
+TEST_CASE(kTestNamePrefix + "Pipelined extraction",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto sequential_extractor = cs::TextExtractor(parser);
+  auto pipelined_extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.threads = 2, .pipeline = true});
+
+  const char* const kFiles[] = {
+      "data/multiple-pages.xml",
+      "data/multiple-revision-citation-removed.xml",
+      "data/multiple-revision-not-chronological.xml",
+      "data/orphaned-revision-included.xml",
+  };
+
+  for (const auto* file_name : kFiles) {
+    std::ifstream sequential_file(FILE(file_name));
+    REQUIRE(sequential_file.is_open());
+    auto expected = sequential_extractor.Extract(sequential_file);
+
+    std::ifstream pipelined_file(FILE(file_name));
+    REQUIRE(pipelined_file.is_open());
+    auto actual = pipelined_extractor.Extract(pipelined_file);
+
+    REQUIRE(actual.first->size() == expected.first->size());
+    for (std::size_t i = 0; i < expected.first->size(); i++) {
+      REQUIRE(actual.first->at(i).SerializeAsString() ==
+              expected.first->at(i).SerializeAsString());
+    }
+
+    REQUIRE(actual.second->size() == expected.second->size());
+    for (const auto& [revision_id, revision] : *expected.second) {
+      REQUIRE(actual.second->at(revision_id).SerializeAsString() ==
+              revision.SerializeAsString());
+    }
+  }
+}
+
+/// Check that the pipelined extractor handles streaming correctly.
+TEST_CASE(kTestNamePrefix + "Pipelined streaming input / output",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.threads = 2, .pipeline = true});
+
+  auto pages_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto page_reader = cs::MessageReader(&pages_stream);
+  pages_stream.clear();
+
+  auto revisions_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto revision_reader = cs::MessageReader(&revisions_stream);
+  revisions_stream.clear();
+
+  std::ifstream file(FILE("data/multiple-pages.xml"));
+  REQUIRE(file.is_open());
+
+  auto pair = extractor.Extract(file, &pages_stream, &revisions_stream);
+  REQUIRE(pair.first == 2);
+  REQUIRE(pair.second == 2);
+
+  pages_stream.clear();
+  pages_stream.seekg(0);
+  revisions_stream.clear();
+  revisions_stream.seekg(0);
+
+  auto page = page_reader.ReadMessage<proto::Page>();
+  REQUIRE(page->page_id() == 1);
+  page = page_reader.ReadMessage<proto::Page>();
+  REQUIRE(page->page_id() == 2);
+
+  auto revision = revision_reader.ReadMessage<proto::Revision>();
+  REQUIRE(revision->revision_id() == 5);
+  revision = revision_reader.ReadMessage<proto::Revision>();
+  REQUIRE(revision->revision_id() == 8);
+}
+
+/// Check the pipelined extractor throws an error on a truncated dump.
+TEST_CASE(kTestNamePrefix + "Pipelined malformed XML",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.threads = 2, .pipeline = true});
+
+  std::ifstream file(FILE("data/malformed.xml"));
+  REQUIRE(file.is_open());
+
+  REQUIRE_THROWS_AS(extractor.Extract(file), cs::DumpParseException);
+}
+
+/// Check that the dump tokenizer gives the same result as libxml++.
+TEST_CASE(kTestNamePrefix + "Dump tokenizer extraction",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto libxml_extractor = cs::TextExtractor(parser);
+  auto tokenizer_extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.reader = cs::DumpReader::kTokenizer});
+
+  const char* const kFiles[] = {
+      "data/entities.xml",
+      "data/multiple-revision-reverts.xml",
+      "data/multiple-revision-late-out-of-order.xml",
+      "data/multiple-pages.xml",
+      "data/multiple-revision-citation-removed.xml",
+      "data/multiple-revision-not-chronological.xml",
+      "data/multiple-revision-order-not-by-id.xml",
+      "data/multiple-revision-same-timestamp.xml",
+      "data/orphaned-revision-included.xml",
+      "data/single-revision-single-citation.xml",
+  };
+
+  for (const auto* file_name : kFiles) {
+    std::ifstream libxml_file(FILE(file_name));
+    REQUIRE(libxml_file.is_open());
+    auto expected = libxml_extractor.Extract(libxml_file);
+
+    std::ifstream tokenizer_file(FILE(file_name));
+    REQUIRE(tokenizer_file.is_open());
+    auto actual = tokenizer_extractor.Extract(tokenizer_file);
+
+    REQUIRE(actual.first->size() == expected.first->size());
+    for (std::size_t i = 0; i < expected.first->size(); i++) {
+      REQUIRE(actual.first->at(i).SerializeAsString() ==
+              expected.first->at(i).SerializeAsString());
+    }
+
+    REQUIRE(actual.second->size() == expected.second->size());
+    for (const auto& [revision_id, revision] : *expected.second) {
+      REQUIRE(actual.second->at(revision_id).SerializeAsString() ==
+              revision.SerializeAsString());
+    }
+  }
+}
+
+/// Check that the dump tokenizer decodes entities and character
+/// references.
+TEST_CASE(kTestNamePrefix + "Dump tokenizer entities",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.reader = cs::DumpReader::kTokenizer});
+
+  std::ifstream file(FILE("data/entities.xml"));
+  REQUIRE(file.is_open());
+
+  auto pair = extractor.Extract(file);
+  REQUIRE(pair.first->size() == 1);
+
+  auto page = pair.first->at(0);
+  REQUIRE(page.title() == "Tom & Jerry’s \"Café\"");
+  REQUIRE(page.citations_size() == 1);
+  REQUIRE(page.citations().at(0).citation().title() == "Parsing & Practice");
+  REQUIRE(page.citations().at(0).revision_removed() == 6);
+
+  REQUIRE(pair.second->at(5).user() == "A <User>");
+}
+
+/// Check that the dump tokenizer reads revision text that spans, or is
+/// followed by, a refill of its read buffer.
+TEST_CASE(kTestNamePrefix + "Dump tokenizer buffer refills",
+          "[extract][extract/Extractor]") {
+  // Size of the tokenizer's read buffer when it is first filled.
+  const std::size_t kBufferSize = 1 << 22;
+  const std::string kFirstCitation =
+      "&lt;ref&gt;{{cite journal | title=First}}&lt;/ref&gt;";
+  const std::string kSecondCitation =
+      "&lt;ref&gt;{{cite journal | title=Second &amp; last}}&lt;/ref&gt;";
+
+  auto revision = [](int revision_id, const std::string& text) {
+    return "    <revision>\n      <id>" + std::to_string(revision_id) +
+           "</id>\n      <timestamp>2002-02-2" +
+           std::to_string(revision_id) +
+           "T15:00:22Z</timestamp>\n      <text xml:space=\"preserve\">" +
+           text + "</text>\n      <sha1>" + std::to_string(revision_id) +
+           "</sha1>\n    </revision>\n";
+  };
+  auto page_start = [](int page_id) {
+    return "  <page>\n    <title>Page " + std::to_string(page_id) +
+           "</title>\n    <ns>0</ns>\n    <id>" + std::to_string(page_id) +
+           "</id>\n";
+  };
+
+  // The first page's text ends just before the buffer does, so the
+  // buffer is refilled before the revision is parsed. The second
+  // page's text is larger than the buffer.
+  auto xml = "<mediawiki>\n" + page_start(1);
+  auto prefix = revision(1, "");
+  prefix = prefix.substr(0, prefix.find("</text>"));
+  auto filler_size =
+      kBufferSize - xml.size() - prefix.size() - kFirstCitation.size() - 4;
+  xml += revision(1, kFirstCitation + std::string(filler_size, 'a'));
+  xml += "  </page>\n" + page_start(2);
+  auto text = kFirstCitation;
+  while (text.size() < kBufferSize + (kBufferSize / 2)) {
+    text += "Some text &amp; more text.\r\n";
+  }
+  xml += revision(2, text + kSecondCitation);
+  xml += revision(3, kSecondCitation);
+  xml += "  </page>\n</mediawiki>\n";
+
+  auto parser = std::make_shared<cs::Parser>();
+  auto libxml_extractor = cs::TextExtractor(parser);
+  auto tokenizer_extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.reader = cs::DumpReader::kTokenizer});
+
+  auto libxml_input = std::istringstream(xml);
+  auto expected = libxml_extractor.Extract(libxml_input);
+  auto tokenizer_input = std::istringstream(xml);
+  auto actual = tokenizer_extractor.Extract(tokenizer_input);
+
+  REQUIRE(actual.first->size() == 2);
+  REQUIRE(actual.first->at(0).citations_size() == 1);
+  REQUIRE(actual.first->at(1).citations_size() == 2);
+  REQUIRE(actual.first->at(1).citations(1).citation().title() ==
+          "Second & last");
+  REQUIRE(actual.first->at(1).citations(0).revision_removed() == 3);
+  for (std::size_t i = 0; i < expected.first->size(); i++) {
+    REQUIRE(actual.first->at(i).SerializeAsString() ==
+            expected.first->at(i).SerializeAsString());
+  }
+}
+
+/// Check the dump tokenizer throws an error on malformed dumps.
+TEST_CASE(kTestNamePrefix + "Dump tokenizer malformed XML",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(
+      parser, cs::ExtractorOptions{.reader = cs::DumpReader::kTokenizer});
+
+  std::ifstream file(FILE("data/malformed.xml"));
+  REQUIRE(file.is_open());
+  REQUIRE_THROWS_AS(extractor.Extract(file), cs::DumpParseException);
+
+  const char* const kDocuments[] = {
+      "<mediawiki><page></mediawiki>",
+      "<mediawiki><page><title>A &unknown; B</title></page></mediawiki>",
+      "<mediawiki><page><title>&#0;</title></page></mediawiki>",
+      "<mediawiki></mediawiki><mediawiki></mediawiki>",
+      "",
+  };
+
+  for (const auto* document : kDocuments) {
+    auto stream = std::istringstream(document);
+    REQUIRE_THROWS_AS(extractor.Extract(stream), cs::DumpParseException);
+  }
+}
+
+/// Check that revisions reverting to text already seen on the page
+/// reuse its citations rather than parsing the text again.
+TEST_CASE(kTestNamePrefix + "Reverted revisions are not parsed again",
+          "[extract][extract/Extractor]") {
+  const int kFirstAdded = 5;
+  const int kFirstRemoved = 8;
+  const int kSecondAdded = 6;
+
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    int templates_parsed = 0;
+    auto parser = std::make_shared<cs::Parser>(
+        [&templates_parsed](const std::string&) {
+          templates_parsed++;
+          return true;
+        });
+    auto extractor =
+        cs::TextExtractor(parser, cs::ExtractorOptions{.reader = reader});
+
+    std::ifstream file(FILE("data/multiple-revision-reverts.xml"));
+    REQUIRE(file.is_open());
+
+    auto pair = extractor.Extract(file);
+    REQUIRE(templates_parsed == 2);
+
+    REQUIRE(pair.first->size() == 1);
+    auto page = pair.first->at(0);
+    REQUIRE(page.citations_size() == 2);
+
+    for (const auto& citation : page.citations()) {
+      if (citation.citation().title() == "First") {
+        REQUIRE(citation.revision_added() == kFirstAdded);
+        REQUIRE(citation.revision_removed() == kFirstRemoved);
+      } else {
+        REQUIRE(citation.revision_added() == kSecondAdded);
+        REQUIRE_FALSE(citation.has_revision_removed());
+      }
+    }
+  }
+}
+
+/// Check that a revision out of chronological order after revisions
+/// whose citations have already been tracked gives the same result as
+/// sorting the whole page.
+TEST_CASE(kTestNamePrefix + "Out of order revision after tracked revisions",
+          "[extract][extract/Extractor]") {
+  const int kFirstAdded = 5;
+  const int kSecondAdded = 6;
+  const int kRemoved = 7;
+  const int kThirdAdded = 8;
+
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    int templates_parsed = 0;
+    auto parser = std::make_shared<cs::Parser>(
+        [&templates_parsed](const std::string&) {
+          templates_parsed++;
+          return true;
+        });
+    auto extractor =
+        cs::TextExtractor(parser, cs::ExtractorOptions{.reader = reader});
+
+    std::ifstream file(FILE("data/multiple-revision-late-out-of-order.xml"));
+    REQUIRE(file.is_open());
+
+    auto pair = extractor.Extract(file);
+
+    // The revert to the first revision's text is still not parsed.
+    REQUIRE(templates_parsed == 6);
+
+    REQUIRE(pair.first->size() == 1);
+    auto page = pair.first->at(0);
+    REQUIRE(page.citations_size() == 3);
+
+    for (const auto& citation : page.citations()) {
+      if (citation.citation().title() == "First") {
+        REQUIRE(citation.revision_added() == kFirstAdded);
+        REQUIRE_FALSE(citation.has_revision_removed());
+      } else if (citation.citation().title() == "Second") {
+        REQUIRE(citation.revision_added() == kSecondAdded);
+        REQUIRE(citation.revision_removed() == kRemoved);
+      } else {
+        REQUIRE(citation.citation().title() == "Third");
+        REQUIRE(citation.revision_added() == kThirdAdded);
+        REQUIRE(citation.revision_removed() == kRemoved);
+      }
+    }
+
+    REQUIRE(pair.second->size() == 4);
+  }
+}
+
+/// Check that spilling out of order revisions to disk once past the
+/// page memory budget gives the same result as holding them in memory.
+TEST_CASE(kTestNamePrefix + "Page memory budget",
+          "[extract][extract/Extractor]") {
+  // A page whose revision timestamps are shuffled, with the citations of
+  // each revision depending on its timestamp.
+  const int kRevisions = 24;
+  auto dump = std::ostringstream();
+  dump << "<mediawiki><page><title>My Page</title><ns>0</ns><id>1</id>";
+  for (int i = 0; i < kRevisions; i++) {
+    auto day = (i * 7) % kRevisions;
+    dump << "<revision><id>" << 100 + i << "</id><timestamp>2002-03-"
+         << (day < 9 ? "0" : "") << day + 1
+         << "T12:00:00Z</timestamp><text>";
+    for (int citation = day / 3; citation < day / 3 + 3; citation++) {
+      dump << "{{cite journal | title=Citation " << citation << "}}\n";
+    }
+    dump << "</text></revision>";
+  }
+  dump << "</page></mediawiki>";
+
+  auto parser = std::make_shared<cs::Parser>();
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    auto extractor =
+        cs::TextExtractor(parser, cs::ExtractorOptions{.reader = reader});
+    auto spilling_extractor = cs::TextExtractor(
+        parser,
+        cs::ExtractorOptions{.reader = reader, .page_memory_budget = 1});
+
+    auto stream = std::istringstream(dump.str());
+    auto expected = extractor.Extract(stream);
+    auto spilling_stream = std::istringstream(dump.str());
+    auto actual = spilling_extractor.Extract(spilling_stream);
+
+    REQUIRE(expected.first->size() == 1);
+    REQUIRE(expected.first->at(0).citations_size() == kRevisions / 3 + 2);
+    REQUIRE(actual.first->size() == 1);
+    REQUIRE(actual.first->at(0).SerializeAsString() ==
+            expected.first->at(0).SerializeAsString());
+
+    REQUIRE(actual.second->size() == expected.second->size());
+    for (const auto& [revision_id, revision] : *expected.second) {
+      REQUIRE(actual.second->at(revision_id).SerializeAsString() ==
+              revision.SerializeAsString());
+    }
+  }
+}
+
+/// Check that a streaming extraction can be resumed from a checkpoint,
+/// giving the same output as an extraction run in one go.
+TEST_CASE(kTestNamePrefix + "Resume from checkpoint",
+          "[extract][extract/Extractor]") {
+  std::ifstream file(FILE("data/multiple-pages.xml"));
+  REQUIRE(file.is_open());
+  auto xml = std::string(std::istreambuf_iterator<char>(file), {});
+
+  auto parser = std::make_shared<cs::Parser>();
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    auto checkpoints = std::vector<cs::ExtractorCheckpoint>();
+    auto options = cs::ExtractorOptions{.reader = reader};
+    options.checkpoint_interval = 1;
+    options.on_checkpoint = [&checkpoints](const auto& checkpoint) {
+      checkpoints.push_back(checkpoint);
+    };
+    auto extractor = cs::TextExtractor(parser, options);
+
+    auto input = std::istringstream(xml);
+    auto pages_output = std::ostringstream(std::ios::binary);
+    auto revisions_output = std::ostringstream(std::ios::binary);
+    auto counts = extractor.Extract(input, &pages_output, &revisions_output);
+    REQUIRE(counts.first == 2);
+    REQUIRE(counts.second == 2);
+
+    REQUIRE(checkpoints.size() == 2);
+    const auto checkpoint = checkpoints[0];
+    REQUIRE(checkpoint.pages_written == 1);
+    REQUIRE(checkpoint.revisions_written == 1);
+    REQUIRE(xml.substr(0, checkpoint.input_offset).ends_with("</page>"));
+    REQUIRE(checkpoint.pages_output_size < pages_output.str().size());
+    REQUIRE(checkpoint.revisions_output_size < revisions_output.str().size());
+    REQUIRE(checkpoints[1].pages_output_size == pages_output.str().size());
+
+    for (auto pipeline : {false, true}) {
+      auto resume_options = cs::ExtractorOptions{
+          .threads = 2, .pipeline = pipeline, .reader = reader};
+      auto resume_extractor = cs::TextExtractor(parser, resume_options);
+
+      auto resume_input = std::istringstream(xml);
+      auto resumed_pages = std::ostringstream(
+          pages_output.str().substr(0, checkpoint.pages_output_size),
+          std::ios::binary | std::ios::ate);
+      auto resumed_revisions = std::ostringstream(
+          revisions_output.str().substr(0, checkpoint.revisions_output_size),
+          std::ios::binary | std::ios::ate);
+      auto resumed_counts = resume_extractor.Extract(
+          resume_input, &resumed_pages, &resumed_revisions, checkpoint);
+
+      REQUIRE(resumed_counts == counts);
+      REQUIRE(resumed_pages.str() == pages_output.str());
+      REQUIRE(resumed_revisions.str() == revisions_output.str());
+    }
+  }
+}
+
+/// Check that the pipelined extractor takes checkpoints between its
+/// batches of pages, and that it can be resumed from them.
+TEST_CASE(kTestNamePrefix + "Pipelined checkpoints",
+          "[extract][extract/Extractor]") {
+  std::ifstream file(FILE("data/multiple-pages.xml"));
+  REQUIRE(file.is_open());
+  auto xml = std::string(std::istreambuf_iterator<char>(file), {});
+
+  auto parser = std::make_shared<cs::Parser>();
+  auto checkpoints = std::vector<cs::ExtractorCheckpoint>();
+  auto options = cs::ExtractorOptions{.threads = 2, .pipeline = true};
+  options.checkpoint_interval = 1;
+  options.on_checkpoint = [&checkpoints](const auto& checkpoint) {
+    checkpoints.push_back(checkpoint);
+  };
+  auto extractor = cs::TextExtractor(parser, options);
+
+  auto input = std::istringstream(xml);
+  auto pages_output = std::ostringstream(std::ios::binary);
+  auto revisions_output = std::ostringstream(std::ios::binary);
+  auto counts = extractor.Extract(input, &pages_output, &revisions_output);
+  REQUIRE(counts.first == 2);
+
+  // Both pages are in the one batch.
+  REQUIRE(checkpoints.size() == 1);
+  const auto checkpoint = checkpoints[0];
+  REQUIRE(checkpoint.pages_written == 2);
+  REQUIRE(checkpoint.revisions_written == counts.second);
+  REQUIRE(xml.substr(0, checkpoint.input_offset).ends_with("</page>"));
+  REQUIRE(checkpoint.pages_output_size == pages_output.str().size());
+  REQUIRE(checkpoint.revisions_output_size == revisions_output.str().size());
+
+  auto resume_input = std::istringstream(xml);
+  auto resumed_pages =
+      std::ostringstream(pages_output.str(), std::ios::binary | std::ios::ate);
+  auto resumed_revisions = std::ostringstream(
+      revisions_output.str(), std::ios::binary | std::ios::ate);
+  auto resumed_counts = extractor.Extract(resume_input, &resumed_pages,
+                                          &resumed_revisions, checkpoint);
+  REQUIRE(resumed_counts == counts);
+  REQUIRE(resumed_pages.str() == pages_output.str());
+
+  options.preserve_order = false;
+  auto unordered_extractor = cs::TextExtractor(parser, options);
+  auto unordered_input = std::istringstream(xml);
+  REQUIRE_THROWS_AS(unordered_extractor.Extract(
+                        unordered_input, &pages_output, &revisions_output),
+                    std::invalid_argument);
+}
+
+/// Check that pages can be filtered by their header, without the text
+/// of the pages filtered out being parsed.
+TEST_CASE(kTestNamePrefix + "Page filter", "[extract][extract/Extractor]") {
+  auto articles = cs::PageFilter{.namespaces = {0}, .skip_redirects = true};
+  auto allowlist = cs::PageFilter{
+      .page_ids = std::make_shared<std::unordered_set<uint64_t>>(
+          std::unordered_set<uint64_t>{3}),
+      .titles = std::make_shared<std::unordered_set<std::string>>(
+          std::unordered_set<std::string>{"My Second Page"}),
+  };
+  const std::pair<cs::PageFilter, std::vector<uint64_t>> kCases[] = {
+      {articles, {1, 4}},
+      {allowlist, {3, 4}},
+  };
+
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    for (auto pipeline : {false, true}) {
+      for (const auto& [filter, page_ids] : kCases) {
+        int templates_parsed = 0;
+        auto parser = std::make_shared<cs::Parser>(
+            [&templates_parsed](const std::string&) {
+              templates_parsed++;
+              return true;
+            });
+        auto options = cs::ExtractorOptions{
+            .threads = 1, .pipeline = pipeline, .reader = reader};
+        options.page_filter = filter;
+        auto extractor = cs::TextExtractor(parser, options);
+
+        std::ifstream file(FILE("data/filtered-pages.xml"));
+        REQUIRE(file.is_open());
+
+        auto pair = extractor.Extract(file);
+        REQUIRE(templates_parsed == static_cast<int>(page_ids.size()));
+        REQUIRE(pair.first->size() == page_ids.size());
+        REQUIRE(pair.second->size() == page_ids.size());
+        for (std::size_t i = 0; i < page_ids.size(); i++) {
+          const auto& page = pair.first->at(i);
+          REQUIRE(page.page_id() == page_ids[i]);
+          REQUIRE(page.citations_size() == 1);
+          REQUIRE(pair.second->contains(page.citations(0).revision_added()));
+        }
+      }
+    }
+  }
+}
+
+/// Check that sharded extraction writes each page and its revisions to
+/// the page's shard.
+TEST_CASE(kTestNamePrefix + "Sharded streaming output",
+          "[extract][extract/Extractor]") {
+  const std::size_t kShards = 3;
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::TextExtractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    auto pages_streams = std::vector<std::stringstream>(kShards);
+    auto revisions_streams = std::vector<std::stringstream>(kShards);
+    auto shards = std::vector<cs::ShardOutput>();
+    for (std::size_t i = 0; i < kShards; i++) {
+      shards.push_back({&pages_streams[i], &revisions_streams[i]});
+    }
+
+    std::ifstream file(FILE("data/filtered-pages.xml"));
+    REQUIRE(file.is_open());
+
+    auto counts = extractor.Extract(file, shards);
+    REQUIRE(counts.size() == kShards);
+
+    uint64_t pages_written = 0;
+    for (std::size_t i = 0; i < kShards; i++) {
+      auto page_reader = cs::MessageReader(&pages_streams[i]);
+      auto revision_reader = cs::MessageReader(&revisions_streams[i]);
+      REQUIRE(counts[i].first == counts[i].second);
+
+      for (uint64_t page_index = 0; page_index < counts[i].first;
+           page_index++) {
+        auto page = page_reader.ReadMessage<proto::Page>();
+        REQUIRE(cs::PageShard(page->page_id(), kShards) == i);
+
+        auto revision = revision_reader.ReadMessage<proto::Revision>();
+        REQUIRE(revision->revision_id() ==
+                page->citations(0).revision_added());
+      }
+      pages_written += counts[i].first;
+    }
+    REQUIRE(pages_written == 4);
+  }
+}
+
+/// Check that a page sink is handed the same pages as an extraction
+/// into memory, both sequentially and pipelined.
+TEST_CASE(kTestNamePrefix + "Extract into page sink",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::TextExtractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    std::ifstream file(FILE("data/filtered-pages.xml"));
+    REQUIRE(file.is_open());
+    auto [expected_pages, expected_revisions] = extractor.Extract(file);
+
+    file.clear();
+    file.seekg(0);
+    auto sink = CollectingPageSink();
+    auto [pages_consumed, revisions_consumed] = extractor.Extract(file, sink);
+
+    REQUIRE(pages_consumed == 4);
+    REQUIRE(pages_consumed == expected_pages->size());
+    REQUIRE(revisions_consumed == expected_revisions->size());
+    REQUIRE(sink.pages.size() == expected_pages->size());
+    for (std::size_t i = 0; i < sink.pages.size(); i++) {
+      REQUIRE(sink.pages[i].SerializeAsString() ==
+              (*expected_pages)[i].SerializeAsString());
+    }
+    REQUIRE(sink.revisions.size() == expected_revisions->size());
+    for (const auto& [revision_id, revision] : sink.revisions) {
+      REQUIRE(revision.SerializeAsString() ==
+              expected_revisions->at(revision_id).SerializeAsString());
+    }
+  }
+}
+
+/// Check that pages are moved into a page sink when the pipeline owns
+/// them, and copied otherwise.
+TEST_CASE(kTestNamePrefix + "Move pages into page sink",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::TextExtractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    std::ifstream file(FILE("data/filtered-pages.xml"));
+    REQUIRE(file.is_open());
+    auto [expected_pages, expected_revisions] = extractor.Extract(file);
+
+    file.clear();
+    file.seekg(0);
+    auto sink = MovingPageSink();
+    auto [pages_consumed, revisions_consumed] = extractor.Extract(file, sink);
+
+    // Only the pipeline owns the pages it hands over.
+    REQUIRE(sink.pages_moved == (pipeline ? pages_consumed : 0));
+    REQUIRE(revisions_consumed == expected_revisions->size());
+    REQUIRE(sink.pages.size() == expected_pages->size());
+    for (std::size_t i = 0; i < sink.pages.size(); i++) {
+      REQUIRE(sink.pages[i].SerializeAsString() ==
+              (*expected_pages)[i].SerializeAsString());
+    }
+    REQUIRE(sink.revisions.size() == expected_revisions->size());
+  }
+}
+
+/// Check that an extracted dump holds the same pages and revisions as
+/// an extraction into memory, and keeps them when moved.
+TEST_CASE(kTestNamePrefix + "Extract into flat dump",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::Bz2Extractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    std::ifstream file(FILE("data/many-pages.xml.bz2"), std::ios::binary);
+    REQUIRE(file.is_open());
+    auto [expected_pages, expected_revisions] = extractor.Extract(file);
+
+    file.clear();
+    file.seekg(0);
+    auto extracted = cs::ExtractedDump();
+    auto [pages_consumed, revisions_consumed] =
+        extractor.Extract(file, extracted);
+    REQUIRE(pages_consumed == expected_pages->size());
+    REQUIRE(revisions_consumed == expected_revisions->size());
+    // Moving the dump keeps the messages where they are.
+    auto dump = std::move(extracted);
+
+    REQUIRE(dump.pages().size() == expected_pages->size());
+    for (std::size_t i = 0; i < dump.pages().size(); i++) {
+      REQUIRE(dump.pages()[i]->SerializeAsString() ==
+              (*expected_pages)[i].SerializeAsString());
+    }
+    REQUIRE(dump.revisions().size() == expected_revisions->size());
+    for (const auto& [revision_id, revision] : *expected_revisions) {
+      const auto* found = dump.FindRevision(revision_id);
+      REQUIRE(found != nullptr);
+      REQUIRE(found->SerializeAsString() == revision.SerializeAsString());
+    }
+    REQUIRE(dump.FindRevision(0) == nullptr);
+    REQUIRE(dump.SpaceUsed() > 0);
+  }
+}
+
+/// Check that lazily iterated pages skip filtered pages, can be stopped
+/// early and report errors.
+TEST_CASE(kTestNamePrefix + "Lazy page iteration",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(
+      parser,
+      cs::ExtractorOptions{.page_filter = {.namespaces = {0},
+                                           .skip_redirects = true}});
+
+  SECTION("Filtered pages are skipped") {
+    std::ifstream file(FILE("data/filtered-pages.xml"));
+    REQUIRE(file.is_open());
+
+    auto titles = std::vector<std::string>();
+    for (auto& extracted : extractor.Pages(file)) {
+      titles.push_back(extracted.page.title());
+      REQUIRE(extracted.revisions.size() == 1);
+    }
+    REQUIRE(titles == std::vector<std::string>{"My Page", "My Second Page"});
+  }
+
+  SECTION("Iteration can stop early") {
+    std::ifstream file(FILE("data/filtered-pages.xml"));
+    REQUIRE(file.is_open());
+
+    auto pages = extractor.Pages(file);
+    auto page = pages.begin();
+    REQUIRE_FALSE(page == pages.end());
+    REQUIRE(page->page.page_id() == 1);
+    REQUIRE(page->revisions.contains(5));
+  }
+
+  SECTION("Empty dump") {
+    auto stream = std::istringstream("<mediawiki></mediawiki>");
+    auto pages = extractor.Pages(stream);
+    REQUIRE(pages.begin() == pages.end());
+  }
+}
+
+/// Check that an incremental dump replaces the changed pages of a
+/// previous extraction and adds new ones, copying the rest unchanged.
+TEST_CASE(kTestNamePrefix + "Apply incremental dump",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::TextExtractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    auto previous_pages =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto previous_revisions =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    std::ifstream previous_file(FILE("data/filtered-pages.xml"));
+    REQUIRE(previous_file.is_open());
+    extractor.Extract(previous_file, &previous_pages, &previous_revisions);
+    auto previous_pages_data = previous_pages.str();
+
+    auto pages_stream =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto revisions_stream =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    std::ifstream file(FILE("data/adds-changes.xml"));
+    REQUIRE(file.is_open());
+    auto [pages_written, revisions_written] =
+        extractor.ExtractIncremental(file, previous_pages, previous_revisions,
+                                     &pages_stream, &revisions_stream);
+    REQUIRE(pages_written == 5);
+    REQUIRE(revisions_written == 6);
+
+    // Pages before the changed page are copied byte for byte.
+    auto previous_stream = std::istringstream(previous_pages_data);
+    auto previous_reader = cs::MessageReader(&previous_stream);
+    std::size_t unchanged_size = 0;
+    for (int i = 0; i < 2; i++) {
+      auto page = previous_reader.ReadMessage<proto::Page>();
+      unchanged_size += sizeof(uint32_t) + page->ByteSizeLong();
+    }
+    REQUIRE(pages_stream.str().substr(0, unchanged_size) ==
+            previous_pages_data.substr(0, unchanged_size));
+
+    auto page_reader = cs::MessageReader(&pages_stream);
+    auto revision_reader = cs::MessageReader(&revisions_stream);
+    const std::vector<std::pair<uint64_t, std::vector<uint64_t>>> kExpected =
+        {{1, {5}}, {2, {6}}, {3, {7, 10}}, {4, {8}}, {5, {11}}};
+    for (const auto& [page_id, revision_ids] : kExpected) {
+      auto page = page_reader.ReadMessage<proto::Page>();
+      REQUIRE(page->page_id() == page_id);
+      REQUIRE(page->citations_size() ==
+              static_cast<int>(revision_ids.size()));
+      for (auto revision_id : revision_ids) {
+        REQUIRE(revision_reader.ReadMessage<proto::Revision>()->revision_id() ==
+                revision_id);
+      }
+    }
+  }
+}
+
+/// Check that an incremental dump holding only the new revisions of a
+/// page carries on from the citations of the previous extraction.
+TEST_CASE(kTestNamePrefix + "Apply incremental dump of new revisions",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::TextExtractor(parser);
+
+  auto previous_pages =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto previous_revisions =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  std::ifstream previous_file(FILE("data/filtered-pages.xml"));
+  REQUIRE(previous_file.is_open());
+  extractor.Extract(previous_file, &previous_pages, &previous_revisions);
+
+  auto pages_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto revisions_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  std::ifstream file(FILE("data/adds-changes-new-revisions.xml"));
+  REQUIRE(file.is_open());
+  auto [pages_written, revisions_written] =
+      extractor.ExtractIncremental(file, previous_pages, previous_revisions,
+                                   &pages_stream, &revisions_stream);
+
+  // Page 5 appears twice, the second carrying on from the first, but
+  // is only written once.
+  REQUIRE(pages_written == 5);
+  REQUIRE(revisions_written == 7);
+
+  auto page_reader = cs::MessageReader(&pages_stream);
+  auto revision_reader = cs::MessageReader(&revisions_stream);
+  // Citations by title, with the revisions they were added and removed
+  // in, 0 if they haven't been removed.
+  const std::vector<
+      std::pair<uint64_t, std::map<std::string, std::pair<uint64_t, uint64_t>>>>
+      kExpected = {
+          {1, {{"Parsing in Practice", {5, 0}}}},
+          {2, {{"Parsing in Practice", {6, 0}}}},
+          {3, {{"Parsing in Practice", {7, 0}}, {"Compilers", {10, 0}}}},
+          {4, {{"Parsing in Practice", {8, 0}}}},
+          {5, {{"Compilers", {11, 12}}, {"Parsing in Practice", {12, 0}}}},
+      };
+  const std::vector<uint64_t> kExpectedRevisions = {5, 6, 7, 10, 8, 11, 12};
+  for (const auto& [page_id, citations] : kExpected) {
+    auto page = page_reader.ReadMessage<proto::Page>();
+    REQUIRE(page->page_id() == page_id);
+    REQUIRE(page->citations_size() == static_cast<int>(citations.size()));
+    for (const auto& citation : page->citations()) {
+      const auto& [added, removed] = citations.at(citation.citation().title());
+      REQUIRE(citation.revision_added() == added);
+      REQUIRE(citation.has_revision_removed() == (removed != 0));
+      if (removed != 0) {
+        REQUIRE(citation.revision_removed() == removed);
+      }
+    }
+  }
+  for (auto revision_id : kExpectedRevisions) {
+    REQUIRE(revision_reader.ReadMessage<proto::Revision>()->revision_id() ==
+            revision_id);
+  }
+}
+
+/// Check that reusing a previous extraction gives the same output as a
+/// plain extraction, copying the unchanged pages.
+TEST_CASE(kTestNamePrefix + "Reuse previous extraction",
+          "[extract][extract/Extractor]") {
+  std::ifstream previous_file(FILE("data/filtered-pages.xml"));
+  REQUIRE(previous_file.is_open());
+  auto previous_xml =
+      std::string(std::istreambuf_iterator<char>(previous_file), {});
+  std::ifstream changes_file(FILE("data/adds-changes.xml"));
+  REQUIRE(changes_file.is_open());
+  auto changes_xml =
+      std::string(std::istreambuf_iterator<char>(changes_file), {});
+
+  // The next release of the dump changes page 3 and adds page 5.
+  const std::string kPageEnd = "</page>\n";
+  auto page_blocks = [&kPageEnd](const std::string& xml) {
+    auto blocks = std::vector<std::string>();
+    auto start = xml.find("  <page>");
+    while (start != std::string::npos) {
+      auto end = xml.find(kPageEnd, start) + kPageEnd.size();
+      blocks.push_back(xml.substr(start, end - start));
+      start = xml.find("  <page>", end);
+    }
+    return blocks;
+  };
+  auto previous_pages = page_blocks(previous_xml);
+  auto changed_pages = page_blocks(changes_xml);
+  REQUIRE(previous_pages.size() == 4);
+  REQUIRE(changed_pages.size() == 2);
+  auto next_xml = previous_xml.substr(0, previous_xml.find("  <page>")) +
+                  previous_pages[0] + previous_pages[1] + changed_pages[0] +
+                  previous_pages[3] + changed_pages[1] + "</mediawiki>\n";
+
+  auto parser = std::make_shared<cs::Parser>();
+  for (auto pipeline : {false, true}) {
+    auto extractor = cs::TextExtractor(
+        parser, cs::ExtractorOptions{.threads = 2, .pipeline = pipeline});
+
+    // Outputs of a plain extraction, as reusing extraction must match.
+    auto extract = [&extractor](const std::string& xml) {
+      auto input = std::istringstream(xml);
+      auto pages = std::stringstream();
+      auto revisions = std::stringstream();
+      extractor.Extract(input, &pages, &revisions);
+      return std::make_pair(pages.str(), revisions.str());
+    };
+
+    auto first_pages =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto first_revisions =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto first_versions =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto first_input = std::istringstream(previous_xml);
+    auto first_written =
+        extractor.ExtractReusing(first_input, cs::PreviousExtraction(),
+                                 &first_pages, &first_revisions,
+                                 &first_versions);
+    REQUIRE(first_written == std::make_pair<uint64_t, uint64_t>(4, 4));
+    REQUIRE(std::make_pair(first_pages.str(), first_revisions.str()) ==
+            extract(previous_xml));
+
+    auto next_pages = std::stringstream();
+    auto next_revisions = std::stringstream();
+    auto next_versions = std::stringstream();
+    auto next_input = std::istringstream(next_xml);
+    auto next_written = extractor.ExtractReusing(
+        next_input,
+        cs::PreviousExtraction{.pages = &first_pages,
+                               .revisions = &first_revisions,
+                               .page_versions = &first_versions},
+        &next_pages, &next_revisions, &next_versions);
+    REQUIRE(next_written == std::make_pair<uint64_t, uint64_t>(5, 6));
+    REQUIRE(std::make_pair(next_pages.str(), next_revisions.str()) ==
+            extract(next_xml));
+
+    // Extracting the same release again copies every page, and records
+    // them where they were before.
+    auto same_pages =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto same_revisions =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto same_versions = std::stringstream();
+    auto same_input = std::istringstream(next_xml);
+    auto previous_next_pages = std::istringstream(next_pages.str());
+    auto previous_next_revisions = std::istringstream(next_revisions.str());
+    auto previous_next_versions = std::istringstream(next_versions.str());
+    auto same_written = extractor.ExtractReusing(
+        same_input,
+        cs::PreviousExtraction{.pages = &previous_next_pages,
+                               .revisions = &previous_next_revisions,
+                               .page_versions = &previous_next_versions},
+        &same_pages, &same_revisions, &same_versions);
+    REQUIRE(same_written == next_written);
+    REQUIRE(same_pages.str() == next_pages.str());
+    REQUIRE(same_revisions.str() == next_revisions.str());
+    REQUIRE(same_versions.str() == next_versions.str());
+
+    // Page versions cut short can't be used.
+    auto truncated_versions = std::istringstream(
+        next_versions.str().substr(0, next_versions.str().size() - 1));
+    previous_next_pages.clear();
+    previous_next_revisions.clear();
+    auto truncated_input = std::istringstream(next_xml);
+    auto output = std::stringstream();
+    REQUIRE_THROWS_AS(
+        extractor.ExtractReusing(
+            truncated_input,
+            cs::PreviousExtraction{.pages = &previous_next_pages,
+                                   .revisions = &previous_next_revisions,
+                                   .page_versions = &truncated_versions},
+            &output, &output, &output),
+        std::runtime_error);
+  }
+
+  auto input = std::istringstream(previous_xml);
+  auto output = std::stringstream();
+  auto compact_options = cs::ExtractorOptions();
+  compact_options.revision_encoding = cs::RevisionEncoding::kCompact;
+  auto compact_extractor = cs::TextExtractor(parser, compact_options);
+  REQUIRE_THROWS_AS(
+      compact_extractor.ExtractReusing(input, cs::PreviousExtraction(),
+                                       &output, &output, &output),
+      std::invalid_argument);
+
+  auto extractor = cs::TextExtractor(parser);
+  REQUIRE_THROWS_AS(
+      extractor.ExtractReusing(
+          input, cs::PreviousExtraction{.pages = &input}, &output, &output,
+          &output),
+      std::invalid_argument);
+}
+
+/// Check that each part of a multi-part dump is extracted to its own
+/// outputs, and that errors are reported.
+TEST_CASE(kTestNamePrefix + "Batch extraction of dump parts",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto output_directory =
+      std::filesystem::temp_directory_path() / "citescoop-batch-test";
+  std::filesystem::create_directories(output_directory);
+
+  auto parts = std::vector<cs::DumpPart>();
+  for (const auto* file_name :
+       {"data/filtered-pages.xml", "data/many-pages.xml.bz2",
+        "data/single-revision-single-citation.xml.zst"}) {
+    auto name = std::filesystem::path(file_name).filename().string();
+    parts.push_back({FILE(file_name), output_directory / (name + ".pages"),
+                     output_directory / (name + ".revisions")});
+  }
+
+  SECTION("Every part is extracted to its own outputs") {
+    uint64_t expected_pages = 0;
+    uint64_t expected_revisions = 0;
+    auto expected_sizes = std::vector<std::size_t>();
+    for (const auto& part : parts) {
+      std::ifstream file(part.input, std::ios::binary);
+      REQUIRE(file.is_open());
+      auto pages = std::stringstream();
+      auto revisions = std::stringstream();
+      std::unique_ptr<cs::Extractor> extractor;
+      if (part.input.extension() == ".bz2") {
+        extractor = std::make_unique<cs::Bz2Extractor>(parser);
+      } else if (part.input.extension() == ".zst") {
+        extractor = std::make_unique<cs::ZstdExtractor>(parser);
+      } else {
+        extractor = std::make_unique<cs::TextExtractor>(parser);
+      }
+      auto [page_count, revision_count] =
+          extractor->Extract(file, &pages, &revisions);
+      expected_pages += page_count;
+      expected_revisions += revision_count;
+      expected_sizes.push_back(pages.str().size());
+    }
+
+    auto extractor = cs::BatchExtractor(parser, cs::ExtractorOptions(), 2);
+    auto [pages_written, revisions_written] = extractor.Extract(parts);
+    REQUIRE(pages_written == expected_pages);
+    REQUIRE(revisions_written == expected_revisions);
+    for (std::size_t i = 0; i < parts.size(); i++) {
+      REQUIRE(std::filesystem::file_size(parts[i].pages_output) ==
+              expected_sizes[i]);
+    }
+  }
+
+  SECTION("Errors are reported") {
+    parts.push_back({output_directory / "missing.xml.bz2",
+                     output_directory / "missing.pages",
+                     output_directory / "missing.revisions"});
+    auto extractor = cs::BatchExtractor(parser, cs::ExtractorOptions(), 2);
+    REQUIRE_THROWS_AS(extractor.Extract(parts), std::runtime_error);
+  }
+
+  std::filesystem::remove_all(output_directory);
+}
+
+/// Check that citation lifecycles are tracked over only the revisions
+/// in the filter's time window and buckets.
+TEST_CASE(kTestNamePrefix + "Revision filter",
+          "[extract][extract/Extractor]") {
+  using std::chrono::sys_days;
+  using std::chrono::January;
+  using std::chrono::February;
+  using std::chrono::year;
+
+  // Title of each citation, with the revisions that added and removed
+  // it, 0 if never removed.
+  using Lifecycles = std::map<std::string, std::pair<uint64_t, uint64_t>>;
+  auto extract = [](const cs::RevisionFilter& filter,
+                    cs::DumpReader reader) {
+    auto parser = std::make_shared<cs::Parser>();
+    auto extractor = cs::TextExtractor(
+        parser,
+        cs::ExtractorOptions{.reader = reader, .revision_filter = filter});
+
+    std::ifstream file(FILE("data/sampled-revisions.xml"));
+    REQUIRE(file.is_open());
+    auto [pages, revisions] = extractor.Extract(file);
+    REQUIRE(pages->size() == 1);
+
+    auto lifecycles = Lifecycles();
+    for (const auto& citation : pages->at(0).citations()) {
+      lifecycles[citation.citation().title()] = {
+          citation.revision_added(),
+          citation.has_revision_removed() ? citation.revision_removed() : 0};
+      REQUIRE(revisions->contains(citation.revision_added()));
+    }
+    return lifecycles;
+  };
+
+  for (auto reader : {cs::DumpReader::kLibxml, cs::DumpReader::kTokenizer}) {
+    REQUIRE(extract(cs::RevisionFilter(), reader) ==
+            Lifecycles{{"Citation A", {1, 3}},
+                       {"Citation B", {2, 5}},
+                       {"Citation C", {4, 0}},
+                       {"Citation D", {5, 0}}});
+
+    auto window = cs::RevisionFilter{
+        .from = sys_days(year(2020) / January / 15),
+        .to = sys_days(year(2020) / February / 28)};
+    REQUIRE(extract(window, reader) == Lifecycles{{"Citation A", {2, 3}},
+                                                  {"Citation B", {2, 0}},
+                                                  {"Citation C", {4, 0}}});
+
+    auto monthly = cs::RevisionFilter{.bucket = cs::RevisionBucket::kMonth};
+    REQUIRE(extract(monthly, reader) == Lifecycles{{"Citation A", {2, 4}},
+                                                   {"Citation B", {2, 5}},
+                                                   {"Citation C", {4, 0}},
+                                                   {"Citation D", {5, 0}}});
+
+    auto monthly_window =
+        cs::RevisionFilter{.to = sys_days(year(2020) / February / 28),
+                           .bucket = cs::RevisionBucket::kMonth};
+    REQUIRE(extract(monthly_window, reader) ==
+            Lifecycles{{"Citation A", {2, 4}},
+                       {"Citation B", {2, 0}},
+                       {"Citation C", {4, 0}}});
+  }
+}
+
+/// Check that revisions written in the compact encoding read back the
+/// same as revisions written as messages, both sequentially and
+/// pipelined.
+TEST_CASE(kTestNamePrefix + "Compact revision encoding",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+
+  for (auto pipeline : {false, true}) {
+    auto options = cs::ExtractorOptions{.threads = 2, .pipeline = pipeline};
+    auto expected_extractor = cs::TextExtractor(parser, options);
+    options.revision_encoding = cs::RevisionEncoding::kCompact;
+    auto compact_extractor = cs::TextExtractor(parser, options);
+
+    std::ifstream expected_file(FILE("data/multiple-pages.xml"));
+    REQUIRE(expected_file.is_open());
+    auto expected_pages = std::stringstream();
+    auto expected_revisions = std::stringstream();
+    auto expected = expected_extractor.Extract(
+        expected_file, &expected_pages, &expected_revisions);
+
+    std::ifstream file(FILE("data/multiple-pages.xml"));
+    REQUIRE(file.is_open());
+    auto pages = std::stringstream();
+    auto revisions = std::stringstream();
+    auto actual = compact_extractor.Extract(file, &pages, &revisions);
+
+    REQUIRE(actual == expected);
+    REQUIRE(pages.str() == expected_pages.str());
+
+    auto message_reader = cs::MessageReader(&expected_revisions);
+    auto compact_reader = cs::CompactRevisionReader(&revisions);
+    for (uint64_t i = 0; i < expected.second; i++) {
+      auto revision = compact_reader.ReadRevision();
+      REQUIRE(revision != nullptr);
+      REQUIRE(revision->SerializeAsString() ==
+              message_reader.ReadMessage<proto::Revision>()
+                  ->SerializeAsString());
+    }
+    REQUIRE(compact_reader.ReadRevision() == nullptr);
+
+    std::ifstream incremental_file(FILE("data/multiple-pages.xml"));
+    REQUIRE_THROWS_AS(
+        compact_extractor.ExtractIncremental(incremental_file, pages,
+                                             revisions, &pages, &revisions),
+        std::invalid_argument);
+  }
+}
+
+/// Check that parsing the revisions of pages on the revision pool gives
+/// the same result as parsing them one at a time, and still only
+/// parses reverted text once.
+TEST_CASE(kTestNamePrefix + "Revision-parallel parsing",
+          "[extract][extract/Extractor]") {
+  const char* const kFiles[] = {
+      "data/multiple-pages.xml",
+      "data/multiple-revision-citation-removed.xml",
+      "data/multiple-revision-late-out-of-order.xml",
+      "data/multiple-revision-not-chronological.xml",
+      "data/multiple-revision-order-not-by-id.xml",
+      "data/multiple-revision-reverts.xml",
+      "data/multiple-revision-same-timestamp.xml",
+      "data/orphaned-revision-included.xml",
+      "data/sampled-revisions.xml",
+  };
+
+  auto serial_templates = std::atomic<int>(0);
+  auto parallel_templates = std::atomic<int>(0);
+  auto serial_parser =
+      std::make_shared<cs::Parser>([&serial_templates](const std::string&) {
+        serial_templates++;
+        return true;
+      });
+  auto parallel_parser =
+      std::make_shared<cs::Parser>([&parallel_templates](const std::string&) {
+        parallel_templates++;
+        return true;
+      });
+
+  for (auto pipeline : {false, true}) {
+    for (auto bucket : {cs::RevisionBucket::kNone, cs::RevisionBucket::kDay}) {
+      auto options = cs::ExtractorOptions{
+          .threads = 2,
+          .pipeline = pipeline,
+          .revision_filter = cs::RevisionFilter{.bucket = bucket}};
+      auto serial_extractor = cs::TextExtractor(serial_parser, options);
+      options.revision_threads = 3;
+      options.parallel_revision_text_size = 0;
+      auto parallel_extractor = cs::TextExtractor(parallel_parser, options);
+
+      for (const auto* file_name : kFiles) {
+        std::ifstream serial_file(FILE(file_name));
+        REQUIRE(serial_file.is_open());
+        auto expected = serial_extractor.Extract(serial_file);
+
+        std::ifstream parallel_file(FILE(file_name));
+        REQUIRE(parallel_file.is_open());
+        auto actual = parallel_extractor.Extract(parallel_file);
+
+        REQUIRE(actual.first->size() == expected.first->size());
+        for (std::size_t i = 0; i < expected.first->size(); i++) {
+          REQUIRE(actual.first->at(i).SerializeAsString() ==
+                  expected.first->at(i).SerializeAsString());
+        }
+
+        REQUIRE(actual.second->size() == expected.second->size());
+        for (const auto& [revision_id, revision] : *expected.second) {
+          REQUIRE(actual.second->at(revision_id).SerializeAsString() ==
+                  revision.SerializeAsString());
+        }
+      }
+    }
+  }
+
+  REQUIRE(parallel_templates == serial_templates);
+}
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 The University of St Andrews
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "citescoop/extract.h"
+#include "citescoop/io.h"
+#include "citescoop/parser.h"
+#include "citescoop/proto/page.pb.h"
+
+#include "util.h"  // NOLINT(misc-include-cleaner)
+
+const std::string kTestNamePrefix = "[Zstd Extractor] ";
+
+namespace cs = wikiopencite::citescoop;
+namespace proto = wikiopencite::proto;
+
+/// Check that the extractor can handle extracting a single citation
+/// from a single page containing a single revision.
+TEST_CASE(kTestNamePrefix + "Extract single citation from single revision",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::ZstdExtractor(parser);
+
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  std::ifstream file(FILE("data/single-revision-single-citation.xml.zst"));
+  REQUIRE(file.is_open());
+
+  const int kRevisionAdded = 5;
+
+  auto pair = extractor.Extract(file);
+  auto result = std::move(pair.first);
+  REQUIRE(result->size() == 1);
+
+  auto page = result->at(0);
+  REQUIRE(page.title() == "My Page");
+  REQUIRE(page.page_id() == 1);
+  REQUIRE(page.citations_size() == 1);
+
+  auto citation = page.citations().at(0);
+  REQUIRE(citation.has_revision_added());
+  REQUIRE(citation.revision_added() == kRevisionAdded);
+  REQUIRE_FALSE(citation.has_revision_removed());
+
+  auto revision = pair.second->at(kRevisionAdded);
+  REQUIRE(revision.revision_id() == kRevisionAdded);
+}
+
+/// Check that the extractor handles streaming correctly.
+TEST_CASE(kTestNamePrefix + "Streaming input / output",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::ZstdExtractor(parser);
+
+  auto pages_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto page_reader = cs::MessageReader(&pages_stream);
+  pages_stream.clear();
+
+  auto revisions_stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto revision_reader = cs::MessageReader(&revisions_stream);
+  revisions_stream.clear();
+
+  std::ifstream file(FILE("data/single-revision-single-citation.xml.zst"));
+  REQUIRE(file.is_open());
+
+  auto pair = extractor.Extract(file, &pages_stream, &revisions_stream);
+  REQUIRE(pair.first == 1);
+  REQUIRE(pair.second == 1);
+
+  pages_stream.clear();
+  pages_stream.seekg(0);
+  revisions_stream.clear();
+  revisions_stream.seekg(0);
+
+  auto page = page_reader.ReadMessage<proto::Page>();
+  REQUIRE(page->title() == "My Page");
+  REQUIRE(page->page_id() == 1);
+  REQUIRE(page->citations_size() == 1);
+
+  auto citation = page->citations().at(0);
+  REQUIRE(citation.has_revision_added());
+  REQUIRE(citation.revision_added() == 5);
+  REQUIRE_FALSE(citation.has_revision_removed());
+
+  auto revision = revision_reader.ReadMessage<proto::Revision>();
+  REQUIRE(revision->revision_id() == 5);
+}
+
+/// Check that decompressing the frames of a seekable zstd dump in
+/// parallel gives the same result as decompressing it sequentially.
+TEST_CASE(kTestNamePrefix + "Parallel frame decompression",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto sequential_extractor = cs::ZstdExtractor(parser);
+  auto parallel_extractor = cs::ZstdExtractor(
+      parser, cs::ExtractorOptions{.decompression_threads = 4});
+
+  const int kPages = 2000;
+
+  std::ifstream sequential_file(FILE("data/many-pages-seekable.xml.zst"));
+  REQUIRE(sequential_file.is_open());
+  auto expected = sequential_extractor.Extract(sequential_file);
+  REQUIRE(expected.first->size() == kPages);
+
+  std::ifstream parallel_file(FILE("data/many-pages-seekable.xml.zst"));
+  REQUIRE(parallel_file.is_open());
+  auto actual = parallel_extractor.Extract(parallel_file);
+  REQUIRE(actual.first->size() == kPages);
+  REQUIRE(actual.second->size() == expected.second->size());
+
+  for (std::size_t i = 0; i < kPages; i++) {
+    REQUIRE(actual.first->at(i).SerializeAsString() ==
+            expected.first->at(i).SerializeAsString());
+  }
+}
+
+/// Check that a zstd dump without a seek table is still decompressed
+/// when parallel decompression is requested.
+TEST_CASE(kTestNamePrefix + "Parallel decompression without seek table",
+          "[extract][extract/Extractor]") {
+  auto parser = std::make_shared<cs::Parser>();
+  auto extractor = cs::ZstdExtractor(
+      parser, cs::ExtractorOptions{.decompression_threads = 4});
+
+  std::ifstream file(FILE("data/single-revision-single-citation.xml.zst"));
+  REQUIRE(file.is_open());
+
+  auto pair = extractor.Extract(file);
+  REQUIRE(pair.first->size() == 1);
+  REQUIRE(pair.first->at(0).citations_size() == 1);
+}
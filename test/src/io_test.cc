@@ -1,16 +1,24 @@
 // SPDX-FileCopyrightText: 2025 The University of St Andrews
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include <sstream>
+#include <system_error>
 #include <string>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
 #include "citescoop/io.h"
 #include "citescoop/proto/file_header.pb.h"
 #include "citescoop/proto/language.pb.h"
+#include "citescoop/proto/revision.pb.h"
 
 const std::string kTestNamePrefix = "[IO] ";
 
@@ -41,3 +49,163 @@ TEST_CASE(kTestNamePrefix + "Read and write with IO reader and writer",
   REQUIRE(read_message->count() == 10);
   REQUIRE(read_message->type() == proto::FileType::FILE_TYPE_OPENALEX_AUTHORS);
 }
+
+TEST_CASE(kTestNamePrefix + "Asynchronous writer matches writer", "[io]") {
+  const int kMessages = 100;
+  // Smaller than a message every few messages.
+  const std::size_t kBufferSize = 16;
+
+  auto expected =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto actual =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto writer = cs::MessageWriter(&expected);
+  auto async_writer = cs::AsyncMessageWriter(&actual, kBufferSize);
+
+  for (int i = 0; i < kMessages; i++) {
+    auto message = proto::FileHeader();
+    message.set_count(static_cast<uint64_t>(i));
+    message.set_type(proto::FileType::FILE_TYPE_OPENALEX_AUTHORS);
+    if (i % 10 == 0) {
+      message.set_count(UINT64_MAX);
+    }
+
+    REQUIRE(async_writer.WriteMessage(message) == writer.WriteMessage(message));
+    if (i == kMessages / 2) {
+      async_writer.Flush();
+      REQUIRE(actual.str() == expected.str());
+    }
+  }
+
+  async_writer.Close();
+  REQUIRE(actual.str() == expected.str());
+  REQUIRE_THROWS_AS(async_writer.WriteMessage(proto::FileHeader()),
+                    std::runtime_error);
+
+  auto reader = cs::MessageReader(&actual);
+  actual.seekg(0);
+  REQUIRE(reader.ReadMessage<proto::FileHeader>()->count() == UINT64_MAX);
+  REQUIRE(reader.ReadMessage<proto::FileHeader>()->count() == 1);
+}
+
+TEST_CASE(kTestNamePrefix + "Read and write compact revisions", "[io]") {
+  const int kRevisions = 10;
+  // Smaller than the number of revisions, so that they span blocks.
+  const std::size_t kBlockSize = 4;
+
+  auto stream =
+      std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+  auto writer = cs::CompactRevisionWriter(&stream, kBlockSize);
+
+  auto revisions = std::vector<proto::Revision>();
+  for (int i = 0; i < kRevisions; i++) {
+    auto& revision = revisions.emplace_back();
+    // IDs and timestamps both go backwards as well as forwards.
+    revision.set_revision_id(static_cast<uint64_t>(100 + (i % 3) * 50 + i));
+    revision.set_parent_id(i == 0 ? 0 : revision.revision_id() - 1);
+    revision.set_user(i % 2 == 0 ? "Prolific" : "Editor " + std::to_string(i));
+    if (i != 5) {
+      revision.mutable_timestamp()->set_seconds(1000000000 - i * 1000 +
+                                                (i % 2) * 5000);
+      revision.mutable_timestamp()->set_nanos(i);
+    }
+  }
+
+  uint64_t bytes_written = 0;
+  for (const auto& revision : revisions) {
+    bytes_written += writer.WriteRevision(revision);
+  }
+  bytes_written += writer.Flush();
+  REQUIRE(writer.Flush() == 0);
+  REQUIRE(bytes_written == stream.str().size());
+
+  stream.seekg(0);
+  auto reader = cs::CompactRevisionReader(&stream);
+  for (const auto& revision : revisions) {
+    auto read_revision = reader.ReadRevision();
+    REQUIRE(read_revision != nullptr);
+    REQUIRE(read_revision->SerializeAsString() ==
+            revision.SerializeAsString());
+  }
+  REQUIRE(reader.ReadRevision() == nullptr);
+
+  auto truncated = std::stringstream(
+      stream.str().substr(0, stream.str().size() - 1),
+      std::ios::binary | std::ios::in);
+  auto truncated_reader = cs::CompactRevisionReader(&truncated);
+  REQUIRE_THROWS_AS(
+      [&truncated_reader]() {
+        while (truncated_reader.ReadRevision() != nullptr) {
+        }
+      }(),
+      std::runtime_error);
+}
+
+TEST_CASE(kTestNamePrefix + "Read and write with asynchronous files",
+          "[io]") {
+  const int kMessages = 100;
+  auto path = std::filesystem::temp_directory_path() / "citescoop-io-test";
+  auto options = cs::AsyncFileOptions();
+  // Smaller than a message every few messages, so that messages span
+  // blocks and every buffer is in flight at once.
+  options.block_size = 16;
+  options.queue_depth = 3;
+
+  for (auto use_io_uring : {true, false}) {
+    options.use_io_uring = use_io_uring;
+    auto expected =
+        std::stringstream(std::ios::binary | std::ios::in | std::ios::out);
+    auto expected_writer = cs::MessageWriter(&expected);
+    {
+      auto sink = cs::AsyncFileSink(path, options);
+      REQUIRE((use_io_uring || !sink.uses_io_uring()));
+      auto output = std::ostream(&sink);
+      auto writer = cs::MessageWriter(&output);
+      for (int i = 0; i < kMessages; i++) {
+        auto message = proto::FileHeader();
+        message.set_count(i % 10 == 0 ? UINT64_MAX
+                                      : static_cast<uint64_t>(i));
+        writer.WriteMessage(message);
+        expected_writer.WriteMessage(message);
+        if (i == kMessages / 2) {
+          REQUIRE(output.flush());
+        }
+      }
+      REQUIRE(output.flush());
+      sink.Close();
+      sink.Close();
+    }
+    REQUIRE(std::filesystem::file_size(path) == expected.str().size());
+
+    auto source = cs::AsyncFileSource(path, options);
+    auto input = std::istream(&source);
+    auto contents = std::string(expected.str().size(), '\0');
+    REQUIRE(input.read(contents.data(),
+                       static_cast<std::streamsize>(contents.size())));
+    REQUIRE(contents == expected.str());
+    REQUIRE(input.get() == std::char_traits<char>::eof());
+
+    // Seek both within the current block and outside of it.
+    auto read_at = [&input](std::streamoff offset, std::ios::seekdir from) {
+      auto buffer = std::string(10, '\0');
+      input.seekg(offset, from);
+      input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      return buffer;
+    };
+    const auto& bytes = expected.str();
+    input.clear();
+    REQUIRE(read_at(100, std::ios::beg) == bytes.substr(100, 10));
+    REQUIRE(input.tellg() == 110);
+    REQUIRE(read_at(-8, std::ios::cur) == bytes.substr(102, 10));
+    REQUIRE(read_at(5, std::ios::beg) == bytes.substr(5, 10));
+    REQUIRE(read_at(-10, std::ios::end) == bytes.substr(bytes.size() - 10));
+
+    input.seekg(0);
+    auto reader = cs::MessageReader(&input);
+    REQUIRE(reader.ReadMessage<proto::FileHeader>()->count() == UINT64_MAX);
+    REQUIRE(reader.ReadMessage<proto::FileHeader>()->count() == 1);
+  }
+
+  std::filesystem::remove(path);
+  REQUIRE_THROWS_AS(cs::AsyncFileSource(path, options), std::system_error);
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <string>
+#include <string_view>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -29,6 +30,24 @@ TEST_CASE(kTestNamePrefix + "Single citation with title", "[parser]") {
   REQUIRE(citation.urls_size() == 0);
 }
 
+/// Check that every Parse overload gives the same result.
+TEST_CASE(kTestNamePrefix + "Parse overloads", "[parser]") {
+  auto parser = wikiopencite::citescoop::Parser();
+  const std::string kText = "{{cite journal | doi=10.1007/b62130}} trailing";
+
+  auto from_string = parser.Parse(kText);
+  auto from_view = parser.Parse(std::string_view(kText).substr(0, 37));
+  auto from_pointer = parser.Parse(kText.c_str());
+
+  REQUIRE(from_string.citations_size() == 1);
+  REQUIRE(from_view.citations_size() == 1);
+  REQUIRE(from_pointer.citations_size() == 1);
+  REQUIRE(from_string.citations().begin()->first ==
+          from_view.citations().begin()->first);
+  REQUIRE(from_string.citations().begin()->first ==
+          from_pointer.citations().begin()->first);
+}
+
 /// Ensure that DOI formats are always in the short form (i.e. missing
 /// the https://doi.org/ prefix).
 TEST_CASE(kTestNamePrefix + "Consistent DOI formats", "[parser]") {
@@ -180,6 +199,38 @@ TEST_CASE(kTestNamePrefix + "Multiple citations in text block", "[parser]") {
   REQUIRE(result.citations_size() == 3);
 }
 
+/// Check that citations without titles are told apart by their
+/// identifiers, rather than all being keyed by an empty title.
+TEST_CASE(kTestNamePrefix + "Citations without titles", "[parser]") {
+  auto parser = wikiopencite::citescoop::Parser();
+
+  auto result = parser.Parse(
+      "{{cite journal | doi=10.1007/b62130}}"
+      "{{cite journal | doi=10.1007/b62131}}"
+      "{{cite web | url=https://example.org/}}");
+
+  REQUIRE(result.citations_size() == 3);
+}
+
+/// Check that citations differing only in the case and whitespace of
+/// their title and DOI are identified as the same citation.
+TEST_CASE(kTestNamePrefix + "Citation fingerprints are normalized",
+          "[parser]") {
+  auto parser = wikiopencite::citescoop::Parser();
+
+  auto result1 = parser.Parse(
+      "{{cite journal | title=Parsing in Practice | doi=10.1007/B62130}}");
+  auto result2 = parser.Parse(
+      "{{cite journal | title=parsing  in\tpractice | doi=10.1007/b62130}}");
+  auto result3 = parser.Parse(
+      "{{cite journal | title=Parsing in Practice | doi=10.1007/b62131}}");
+
+  REQUIRE(result1.citations().begin()->first ==
+          result2.citations().begin()->first);
+  REQUIRE(result1.citations().begin()->first !=
+          result3.citations().begin()->first);
+}
+
 // NOLINTBEGIN(readability-function-cognitive-complexity)
 /// Check that we can correctly set and retrieve parser options.
 TEST_CASE(kTestNamePrefix + "Get options", "[parser]") {